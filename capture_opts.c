@@ -984,13 +984,43 @@ capture_opts_add_opt(capture_options *capture_opts, int opt, const char *optarg_
             cmdarg_err("--compress-type can be set only once");
             return 1;
         }
-        if (strcmp(optarg_str_p, "none") == 0) {
-            ;
-        } else if (strcmp(optarg_str_p, "gzip") == 0) {
-            ;
-        } else {
-            cmdarg_err("parameter of --compress-type can be 'none' or 'gzip'");
-            return 1;
+        {
+            /* "<type>[:<level>]" */
+            const char *level_p = strchr(optarg_str_p, ':');
+            size_t type_len = level_p ? (size_t)(level_p - optarg_str_p) : strlen(optarg_str_p);
+            int max_level = 0;
+
+            if (type_len == 4 && strncmp(optarg_str_p, "none", 4) == 0) {
+                ;
+            } else if (type_len == 4 && strncmp(optarg_str_p, "gzip", 4) == 0) {
+                max_level = 9;
+#ifdef HAVE_ZSTD
+            } else if (type_len == 4 && strncmp(optarg_str_p, "zstd", 4) == 0) {
+                max_level = 19;
+#endif
+            } else {
+#ifdef HAVE_ZSTD
+                cmdarg_err("parameter of --compress-type can be 'none', 'gzip', or 'zstd'");
+#else
+                cmdarg_err("parameter of --compress-type can be 'none' or 'gzip'");
+#endif
+                return 1;
+            }
+            if (level_p != NULL) {
+                char *end_p;
+                long level = strtol(level_p + 1, &end_p, 10);
+
+                if (max_level == 0) {
+                    cmdarg_err("--compress-type none doesn't take a compression level");
+                    return 1;
+                }
+                if (end_p == level_p + 1 || *end_p != '\0' ||
+                    level < 1 || level > max_level) {
+                    cmdarg_err("The compression level for --compress-type %.*s must be between 1 and %d",
+                               (int)type_len, optarg_str_p, max_level);
+                    return 1;
+                }
+            }
         }
         capture_opts->compress_type = g_strdup(optarg_str_p);
         break;
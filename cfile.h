@@ -60,6 +60,8 @@ struct packet_provider_data {
   frame_data  *prev_cap;
   frame_data_sequence *frames;       /* Sequence of frames, if we're keeping that information */
   GTree       *frames_user_comments; /* BST with user comments for frames (key = frame_data) */
+  GTree       *frames_shift_offsets; /* BST with time shift offsets for frames (key = frame_data) */
+  GMutex      *wth_mutex;            /* If non-NULL, held around uses of wth while another thread reads it */
 };
 
 typedef struct _capture_file {
@@ -93,6 +95,9 @@ typedef struct _capture_file {
   gboolean                    redissecting;         /* TRUE if currently redissecting (cf_redissect_packets) */
   gboolean                    read_lock;            /* TRUE if currently processing a file (cf_read) */
   rescan_type                 redissection_queued;  /* Queued redissection type. */
+  gboolean                    retapping;            /* TRUE if currently retapping (cf_retap_packets) */
+  gboolean                    retap_queued;         /* TRUE if another retap was requested while retapping */
+  GQueue                     *filter_results;       /* Per-frame results of recent display filters, most recently used first */
   /* search */
   gchar                      *sfilter;              /* Filter, hex value, or string being searched */
   gboolean                    hex;                  /* TRUE if "Hex value" search was last selected */
@@ -133,6 +138,8 @@ const char *cap_file_provider_get_interface_name(struct packet_provider_data *pr
 const char *cap_file_provider_get_interface_description(struct packet_provider_data *prov, guint32 interface_id);
 const char *cap_file_provider_get_user_comment(struct packet_provider_data *prov, const frame_data *fd);
 void cap_file_provider_set_user_comment(struct packet_provider_data *prov, frame_data *fd, const char *new_comment);
+const nstime_t *cap_file_provider_get_shift_offset(struct packet_provider_data *prov, const frame_data *fd);
+void cap_file_provider_set_shift_offset(struct packet_provider_data *prov, frame_data *fd, const nstime_t *shift_offset);
 
 #ifdef __cplusplus
 }
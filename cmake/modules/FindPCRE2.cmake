@@ -0,0 +1,70 @@
+#
+# - Find PCRE2
+# Find the 8-bit PCRE2 includes and library
+#
+#  PCRE2_INCLUDE_DIRS - where to find pcre2.h, etc.
+#  PCRE2_LIBRARIES    - List of libraries when using PCRE2.
+#  PCRE2_FOUND        - True if PCRE2 found.
+#  PCRE2_DLL_DIR      - (Windows) Path to the PCRE2 DLL
+#  PCRE2_DLL          - (Windows) Name of the PCRE2 DLL
+
+include( FindWSWinLibs )
+FindWSWinLibs( "pcre2-.*" "PCRE2_HINTS" )
+
+if( NOT WIN32)
+  find_package(PkgConfig)
+  pkg_search_module(PCRE2 libpcre2-8)
+endif()
+
+find_path(PCRE2_INCLUDE_DIR
+  NAMES pcre2.h
+  HINTS "${PCRE2_INCLUDEDIR}" "${PCRE2_HINTS}/include"
+  /usr/include
+  /usr/local/include
+)
+
+find_library(PCRE2_LIBRARY
+  NAMES pcre2-8
+  HINTS "${PCRE2_LIBDIR}" "${PCRE2_HINTS}/lib"
+  PATHS
+  /usr/lib
+  /usr/local/lib
+)
+
+if( PCRE2_INCLUDE_DIR AND PCRE2_LIBRARY )
+  file(STRINGS ${PCRE2_INCLUDE_DIR}/pcre2.h PCRE2_VERSION_MAJOR
+    REGEX "#define[ ]+PCRE2_MAJOR[ ]+[0-9]+")
+  string(REGEX MATCH "[0-9]+" PCRE2_VERSION_MAJOR ${PCRE2_VERSION_MAJOR})
+  file(STRINGS ${PCRE2_INCLUDE_DIR}/pcre2.h PCRE2_VERSION_MINOR
+    REGEX "#define[ ]+PCRE2_MINOR[ ]+[0-9]+")
+  string(REGEX MATCH "[0-9]+" PCRE2_VERSION_MINOR ${PCRE2_VERSION_MINOR})
+  set(PCRE2_VERSION ${PCRE2_VERSION_MAJOR}.${PCRE2_VERSION_MINOR})
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(PCRE2
+    REQUIRED_VARS   PCRE2_LIBRARY PCRE2_INCLUDE_DIR
+    VERSION_VAR     PCRE2_VERSION)
+
+if( PCRE2_FOUND )
+  set( PCRE2_INCLUDE_DIRS ${PCRE2_INCLUDE_DIR} )
+  set( PCRE2_LIBRARIES ${PCRE2_LIBRARY} )
+  if (WIN32)
+    set ( PCRE2_DLL_DIR "${PCRE2_HINTS}/bin"
+      CACHE PATH "Path to PCRE2 DLL"
+    )
+    file( GLOB _pcre2_dll RELATIVE "${PCRE2_DLL_DIR}"
+      "${PCRE2_DLL_DIR}/pcre2-8*.dll"
+    )
+    set ( PCRE2_DLL ${_pcre2_dll}
+      # We're storing filenames only. Should we use STRING instead?
+      CACHE FILEPATH "PCRE2 DLL file name"
+    )
+    mark_as_advanced( PCRE2_DLL_DIR PCRE2_DLL )
+  endif()
+else()
+  set( PCRE2_INCLUDE_DIRS )
+  set( PCRE2_LIBRARIES )
+endif()
+
+mark_as_advanced( PCRE2_LIBRARIES PCRE2_INCLUDE_DIRS )
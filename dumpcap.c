@@ -117,6 +117,8 @@ FILE *debug_log;   /* for logging debug messages to  */
 #endif
 
 static GAsyncQueue *pcap_queue;
+static GMutex pcap_queue_pool_mtx;
+static struct _pcap_queue_element *pcap_queue_pool;
 static gint64 pcap_queue_bytes;
 static gint64 pcap_queue_packets;
 static gint64 pcap_queue_byte_limit = 0;
@@ -192,6 +194,9 @@ typedef struct _capture_src {
     guint32                      received;
     guint32                      dropped;
     guint32                      flushed;
+    guint32                      queued;                 /**< Packets from this source currently in pcap_queue */
+    guint32                      queue_high_water;       /**< Largest value "queued" has reached */
+    guint32                      queue_drops;            /**< Packets dropped because pcap_queue was full */
     pcap_t                      *pcap_h;
 #ifdef MUST_DO_SELECT
     int                          pcap_fd;                /**< pcap file descriptor */
@@ -281,8 +286,22 @@ typedef struct _pcap_queue_element {
         pcapng_block_header_t  bh;
     } u;
     u_char             *pd;
+    guint32             pd_size;   /**< Allocated size of pd */
+    struct _pcap_queue_element *next_free;
 } pcap_queue_element;
 
+/*
+ * Queue elements, and their data buffers, are recycled through
+ * pcap_queue_pool rather than being allocated for every packet and
+ * freed again once it has been written; the pool only grows to the
+ * largest number of packets that have been queued at once.
+ *
+ * The writer takes up to PCAP_QUEUE_BATCH packets off the queue each
+ * time it acquires the queue lock.
+ */
+#define PCAP_QUEUE_ELEMENT_MIN_SIZE 2048
+#define PCAP_QUEUE_BATCH            64
+
 /*
  * This needs to be static, so that the SIGINT handler can clear the "go"
  * flag and for saved_shb_idb_lock.
@@ -351,6 +370,8 @@ static void WS_NORETURN exit_main(int err);
 static void report_new_capture_file(const char *filename);
 static void report_packet_count(unsigned int packet_count);
 static void report_packet_drops(guint32 received, guint32 pcap_drops, guint32 drops, guint32 flushed, guint32 ps_ifdrop, gchar *name);
+static void report_queue_statistics(guint32 high_water, guint32 drops, gchar *name);
+static void report_compress_statistics(void);
 static void report_capture_error(const char *error_msg, const char *secondary_error_msg);
 static void report_cfilter_error(capture_options *capture_opts, guint i, const char *errmsg);
 
@@ -427,6 +448,9 @@ print_usage(FILE *output)
     fprintf(output, "                                          an exact multiple of NUM secs\n");
     fprintf(output, "                          printname:FILE - print filename to FILE when written\n");
     fprintf(output, "                                           (can use 'stdout' or 'stderr')\n");
+    fprintf(output, "  --compress-type <type>[:<level>]\n");
+    fprintf(output, "                           compress ringbuffer files as they are written\n");
+    fprintf(output, "                           ('gzip' or 'zstd', with an optional level)\n");
     fprintf(output, "  -n                       use pcapng format instead of pcap (default)\n");
     fprintf(output, "  -P                       use libpcap format instead of pcapng\n");
     fprintf(output, "  --capture-comment <comment>\n");
@@ -3571,7 +3595,8 @@ capture_loop_open_output(capture_options *capture_opts, int *save_file_fd,
                 *save_file_fd = ringbuf_init(capfile_name,
                                              (capture_opts->has_ring_num_files) ? capture_opts->ring_num_files : 0,
                                              capture_opts->group_read_access,
-                                             capture_opts->compress_type);
+                                             capture_opts->compress_type,
+                                             !capture_child);
 
                 /* capfile_name is unused as the ringbuffer provides its own filename. */
                 if (*save_file_fd != -1) {
@@ -3764,6 +3789,7 @@ do_file_switch_or_stop(capture_options *capture_opts)
             if (!quiet)
                 report_packet_count(global_ld.inpkts_to_sync_pipe);
             global_ld.inpkts_to_sync_pipe = 0;
+            report_compress_statistics();
             report_new_capture_file(capture_opts->save_file);
         } else {
             /* File switch failed: stop here */
@@ -3799,23 +3825,80 @@ pcap_read_handler(void* arg)
     return (NULL);
 }
 
-/* Try to pop an item off the packet queue and if it exists, write it */
-static gboolean
+/* Get a queue element with room for at least len bytes of data. */
+static pcap_queue_element *
+pcap_queue_element_get(guint32 len)
+{
+    pcap_queue_element *queue_element;
+
+    g_mutex_lock(&pcap_queue_pool_mtx);
+    queue_element = pcap_queue_pool;
+    if (queue_element) {
+        pcap_queue_pool = queue_element->next_free;
+    }
+    g_mutex_unlock(&pcap_queue_pool_mtx);
+
+    if (queue_element == NULL) {
+        queue_element = g_new(pcap_queue_element, 1);
+        queue_element->pd_size = MAX(len, PCAP_QUEUE_ELEMENT_MIN_SIZE);
+        queue_element->pd = (u_char *)g_malloc(queue_element->pd_size);
+    } else if (queue_element->pd_size < len) {
+        queue_element->pd_size = len;
+        queue_element->pd = (u_char *)g_realloc(queue_element->pd, len);
+    }
+    return queue_element;
+}
+
+/* Return a list of queue elements, linked through next_free, to the pool. */
+static void
+pcap_queue_element_put(pcap_queue_element *first, pcap_queue_element *last)
+{
+    g_mutex_lock(&pcap_queue_pool_mtx);
+    last->next_free = pcap_queue_pool;
+    pcap_queue_pool = first;
+    g_mutex_unlock(&pcap_queue_pool_mtx);
+}
+
+static void
+pcap_queue_pool_free(void)
+{
+    pcap_queue_element *queue_element;
+
+    while ((queue_element = pcap_queue_pool) != NULL) {
+        pcap_queue_pool = queue_element->next_free;
+        g_free(queue_element->pd);
+        g_free(queue_element);
+    }
+}
+
+/* Try to pop a batch of items off the packet queue and write them.
+   Returns the number of items written. */
+static int
 capture_loop_dequeue_packet(void) {
+    pcap_queue_element *batch[PCAP_QUEUE_BATCH];
     pcap_queue_element *queue_element;
+    int                 count, i;
 
     g_async_queue_lock(pcap_queue);
     queue_element = (pcap_queue_element *)g_async_queue_timeout_pop_unlocked(pcap_queue, WRITER_THREAD_TIMEOUT);
-    if (queue_element) {
+    for (count = 0; queue_element != NULL; ) {
         if (queue_element->pcap_src->from_pcapng) {
             pcap_queue_bytes -= queue_element->u.bh.block_total_length;
         } else {
             pcap_queue_bytes -= queue_element->u.phdr.caplen;
         }
         pcap_queue_packets -= 1;
+        queue_element->pcap_src->queued -= 1;
+        batch[count++] = queue_element;
+        if (count == PCAP_QUEUE_BATCH) {
+            break;
+        }
+        queue_element = (pcap_queue_element *)g_async_queue_try_pop_unlocked(pcap_queue);
     }
     g_async_queue_unlock(pcap_queue);
-    if (queue_element) {
+
+    for (i = 0; i < count; i++) {
+        queue_element = batch[i];
         if (queue_element->pcap_src->from_pcapng) {
             g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
                   "Dequeued a block of type 0x%08x of length %d captured on interface %d.",
@@ -3834,11 +3917,12 @@ capture_loop_dequeue_packet(void) {
                                         &queue_element->u.phdr,
                                         queue_element->pd);
         }
-        g_free(queue_element->pd);
-        g_free(queue_element);
-        return TRUE;
+        queue_element->next_free = (i + 1 < count) ? batch[i + 1] : NULL;
     }
-    return FALSE;
+    if (count > 0) {
+        pcap_queue_element_put(batch[0], batch[count - 1]);
+    }
+    return count;
 }
 
 /*
@@ -4043,13 +4127,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     while (global_ld.go) {
         /* dispatch incoming packets */
         if (use_threads) {
-            gboolean dequeued = capture_loop_dequeue_packet();
-
-            if (dequeued) {
-                inpkts = 1;
-            } else {
-                inpkts = 0;
-            }
+            inpkts = capture_loop_dequeue_packet();
         } else {
             pcap_src = g_array_index(global_ld.pcaps, capture_src *, 0);
             inpkts = capture_loop_dispatch(&global_ld, errmsg,
@@ -4164,15 +4242,16 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
                   pcap_src->interface_id);
         }
         while (1) {
-            gboolean dequeued = capture_loop_dequeue_packet();
-            if (!dequeued) {
+            int dequeued = capture_loop_dequeue_packet();
+            if (dequeued == 0) {
                 break;
             }
-            global_ld.inpkts_to_sync_pipe += 1;
+            global_ld.inpkts_to_sync_pipe += dequeued;
             if (capture_opts->output_to_pipe) {
                 fflush(global_ld.pdh);
             }
         }
+        pcap_queue_pool_free();
     }
 
 
@@ -4309,6 +4388,8 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     if (capture_opts->saving_to_file) {
         /* close the output file */
         close_ok = capture_loop_close_output(capture_opts, &global_ld, &err_close);
+        if (capture_opts->multi_files_on)
+            report_compress_statistics();
     } else
         close_ok = TRUE;
 
@@ -4363,6 +4444,9 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
             }
         }
         report_packet_drops(received, pcap_dropped, pcap_src->dropped, pcap_src->flushed, stats->ps_ifdrop, interface_opts->display_name);
+        if (use_threads) {
+            report_queue_statistics(pcap_src->queue_high_water, pcap_src->queue_drops, interface_opts->display_name);
+        }
     }
 
     /* close the input file (pcap or capture pipe) */
@@ -4455,6 +4539,18 @@ capture_loop_get_errmsg(char *errmsg, size_t errmsglen, char *secondary_errmsg,
         break;
 #endif
 
+    case WTAP_ERR_INTERNAL:
+        /* Reported by the compressor of a ringbuffer file */
+        g_snprintf(errmsg, (gulong)errmsglen,
+                   "An internal error occurred while compressing the file"
+                   " to which the capture was being saved\n"
+                   "(\"%s\"): %s.",
+                   fname, ringbuf_get_compress_err_info() != NULL ?
+                       ringbuf_get_compress_err_info() : "unknown error");
+        g_snprintf(secondary_errmsg, (gulong)secondary_errmsglen,
+                   "%s", please_report_bug());
+        break;
+
     default:
         if (is_close) {
             g_snprintf(errmsg, (gulong)errmsglen,
@@ -4640,19 +4736,9 @@ capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
-    if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
+    queue_element = pcap_queue_element_get(phdr->caplen);
     queue_element->pcap_src = pcap_src;
     queue_element->u.phdr = *phdr;
-    queue_element->pd = (u_char *)g_malloc(phdr->caplen);
-    if (queue_element->pd == NULL) {
-        pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
     memcpy(queue_element->pd, pd, phdr->caplen);
     g_async_queue_lock(pcap_queue);
     if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
@@ -4661,14 +4747,18 @@ capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
         g_async_queue_push_unlocked(pcap_queue, queue_element);
         pcap_queue_bytes += phdr->caplen;
         pcap_queue_packets += 1;
+        if (++pcap_src->queued > pcap_src->queue_high_water) {
+            pcap_src->queue_high_water = pcap_src->queued;
+        }
     } else {
         limit_reached = TRUE;
+        pcap_src->queue_drops++;
     }
     g_async_queue_unlock(pcap_queue);
     if (limit_reached) {
         pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
+        queue_element->next_free = NULL;
+        pcap_queue_element_put(queue_element, queue_element);
         g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
               "Dropped a packet of length %d captured on interface %u.",
               phdr->caplen, pcap_src->interface_id);
@@ -4700,19 +4790,9 @@ capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
-    if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
+    queue_element = pcap_queue_element_get(bh->block_total_length);
     queue_element->pcap_src = pcap_src;
     queue_element->u.bh = *bh;
-    queue_element->pd = (u_char *)g_malloc(bh->block_total_length);
-    if (queue_element->pd == NULL) {
-        pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
     memcpy(queue_element->pd, pd, bh->block_total_length);
     g_async_queue_lock(pcap_queue);
     if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
@@ -4721,14 +4801,18 @@ capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
         g_async_queue_push_unlocked(pcap_queue, queue_element);
         pcap_queue_bytes += bh->block_total_length;
         pcap_queue_packets += 1;
+        if (++pcap_src->queued > pcap_src->queue_high_water) {
+            pcap_src->queue_high_water = pcap_src->queued;
+        }
     } else {
         limit_reached = TRUE;
+        pcap_src->queue_drops++;
     }
     g_async_queue_unlock(pcap_queue);
     if (limit_reached) {
         pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
+        queue_element->next_free = NULL;
+        pcap_queue_element_put(queue_element, queue_element);
         g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
               "Dropped a packet of length %d captured on interface %u.",
               bh->block_total_length, pcap_src->interface_id);
@@ -5765,6 +5849,45 @@ report_packet_drops(guint32 received, guint32 pcap_drops, guint32 drops, guint32
     }
 }
 
+static void
+report_queue_statistics(guint32 high_water, guint32 drops, gchar *name)
+{
+    if (capture_child) {
+        g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG,
+            "Packet queue for interface '%s': high-water %u packets, %u dropped when full",
+            name, high_water, drops);
+    } else {
+        fprintf(stderr,
+            "Packet queue for interface '%s': high-water %u packets, %u dropped when full\n",
+            name, high_water, drops);
+        /* stderr could be line buffered */
+        fflush(stderr);
+    }
+}
+
+/*
+ * Report how well the ringbuffer file just closed compressed, and how far
+ * the compressor was behind the capture when it was closed, if it was
+ * compressed while it was written.
+ */
+static void
+report_compress_statistics(void)
+{
+    const ringbuf_compress_stats *stats;
+
+    if (quiet || !ringbuf_get_compress_stats(&stats))
+        return;
+
+    fprintf(stderr,
+        "File '%s': %" G_GUINT64_FORMAT " bytes compressed to %" G_GUINT64_FORMAT " (%.1f%%), "
+        "compression backlog %" G_GUINT64_FORMAT " bytes (max %" G_GUINT64_FORMAT ")\n",
+        stats->name, stats->bytes_in, stats->bytes_out,
+        stats->bytes_in ? 100.0 * stats->bytes_out / stats->bytes_in : 0.0,
+        stats->backlog, stats->max_backlog);
+    /* stderr could be line buffered */
+    fflush(stderr);
+}
+
 
 /************************************************************************************************/
 /* signal_pipe handling */
@@ -112,6 +112,7 @@ typedef struct _fd_hash_t {
     guint8     digest[16];
     guint32    len;
     nstime_t   frame_time;
+    gboolean   indexed;     /* TRUE if this entry is counted in fd_hash_index */
 } fd_hash_t;
 
 #define DEFAULT_DUP_DEPTH       5   /* Used with -d */
@@ -121,6 +122,22 @@ static fd_hash_t fd_hash[MAX_DUP_DEPTH];
 static int       dup_window    = DEFAULT_DUP_DEPTH;
 static int       cur_dup_entry = 0;
 
+/*
+ * Index of the digests currently in fd_hash[], so that a duplicate can
+ * be found without scanning the whole window.  Each distinct digest/length
+ * pair has one entry, counting how many fd_hash[] entries hold it and
+ * recording the most recently added one.
+ */
+typedef struct _fd_hash_index_t {
+    guint8     digest[16];
+    guint32    len;
+    guint      count;
+    int        recent;      /* fd_hash[] index of the newest entry with this digest */
+} fd_hash_index_t;
+
+static GHashTable *fd_hash_index = NULL;
+static gboolean    fd_hash_times_ordered = TRUE; /* timestamps added so far never went backwards */
+
 static guint32   ignored_bytes  = 0;  /* Used with -I */
 
 #define ONE_BILLION 1000000000
@@ -591,9 +608,74 @@ remove_vlan_info(const wtap_packet_header *phdr, guint8* fd, guint32* len) {
     }
 }
 
+static guint
+fd_hash_index_hash(gconstpointer key)
+{
+    const fd_hash_index_t *entry = (const fd_hash_index_t *)key;
+
+    /* The digest is already well distributed. */
+    return pletoh32(entry->digest) ^ entry->len;
+}
+
+static gboolean
+fd_hash_index_equal(gconstpointer a, gconstpointer b)
+{
+    const fd_hash_index_t *entry_a = (const fd_hash_index_t *)a;
+    const fd_hash_index_t *entry_b = (const fd_hash_index_t *)b;
+
+    return entry_a->len == entry_b->len &&
+           memcmp(entry_a->digest, entry_b->digest, 16) == 0;
+}
+
+static void
+fd_hash_index_free(gpointer data)
+{
+    g_slice_free(fd_hash_index_t, data);
+}
+
+static fd_hash_index_t *
+fd_hash_index_lookup(int entry)
+{
+    fd_hash_index_t key;
+
+    memcpy(key.digest, fd_hash[entry].digest, 16);
+    key.len = fd_hash[entry].len;
+    return (fd_hash_index_t *)g_hash_table_lookup(fd_hash_index, &key);
+}
+
+/* Drop the entry about to be overwritten from the index. */
+static void
+fd_hash_index_remove(int entry)
+{
+    fd_hash_index_t *index_entry;
+
+    if (!fd_hash[entry].indexed)
+        return;
+
+    index_entry = fd_hash_index_lookup(entry);
+    if (--index_entry->count == 0)
+        g_hash_table_remove(fd_hash_index, index_entry);
+    fd_hash[entry].indexed = FALSE;
+}
+
+static void
+fd_hash_index_add(int entry, fd_hash_index_t *index_entry)
+{
+    if (index_entry == NULL) {
+        index_entry = g_slice_new(fd_hash_index_t);
+        memcpy(index_entry->digest, fd_hash[entry].digest, 16);
+        index_entry->len = fd_hash[entry].len;
+        index_entry->count = 0;
+        g_hash_table_add(fd_hash_index, index_entry);
+    }
+    index_entry->count++;
+    index_entry->recent = entry;
+    fd_hash[entry].indexed = TRUE;
+}
+
 static gboolean
 is_duplicate(guint8* fd, guint32 len) {
-    int i;
+    fd_hash_index_t *index_entry;
     const struct ieee80211_radiotap_header* tap_header;
 
     /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
@@ -620,28 +702,26 @@ is_duplicate(guint8* fd, guint32 len) {
     if (cur_dup_entry >= dup_window)
         cur_dup_entry = 0;
 
+    fd_hash_index_remove(cur_dup_entry);
+
     /* Calculate our digest */
     gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
 
     fd_hash[cur_dup_entry].len = len;
 
-    /* Look for duplicates */
-    for (i = 0; i < dup_window; i++) {
-        if (i == cur_dup_entry)
-            continue;
+    /* Look for duplicates among the other entries in the window */
+    index_entry = fd_hash_index_lookup(cur_dup_entry);
+    fd_hash_index_add(cur_dup_entry, index_entry);
 
-        if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-            && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
-        }
-    }
-
-    return FALSE;
+    return index_entry != NULL;
 }
 
 static gboolean
 is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
     int i;
+    int newest;
+    fd_hash_index_t *index_entry;
+    nstime_t recent_delta;
 
     /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
     guint32 offset = ignored_bytes;
@@ -655,10 +735,13 @@ is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
     new_fd  = &fd[offset];
     new_len = len - (offset);
 
+    newest = cur_dup_entry;
     cur_dup_entry++;
     if (cur_dup_entry >= dup_window)
         cur_dup_entry = 0;
 
+    fd_hash_index_remove(cur_dup_entry);
+
     /* Calculate our digest */
     gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
 
@@ -666,6 +749,36 @@ is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
     fd_hash[cur_dup_entry].frame_time.secs = current->secs;
     fd_hash[cur_dup_entry].frame_time.nsecs = current->nsecs;
 
+    if (!nstime_is_unset(&fd_hash[newest].frame_time) &&
+        nstime_cmp(current, &fd_hash[newest].frame_time) < 0) {
+        fd_hash_times_ordered = FALSE;
+    }
+
+    index_entry = fd_hash_index_lookup(cur_dup_entry);
+    if (index_entry == NULL) {
+        /* No other packet in the window has this digest. */
+        fd_hash_index_add(cur_dup_entry, NULL);
+        return FALSE;
+    }
+    i = index_entry->recent;
+    fd_hash_index_add(cur_dup_entry, index_entry);
+
+    /*
+     * The scan below stops at the first cached packet, going backwards,
+     * that is beyond the dup time window.  If the newest packet with
+     * this digest is beyond it, the scan can't get past it to any older
+     * ones.  If it is within the window and all timestamps so far have
+     * been in order, every packet after it is also within the window,
+     * so the scan would reach it.
+     */
+    nstime_delta(&recent_delta, current, &fd_hash[i].frame_time);
+    if (recent_delta.secs >= 0 && recent_delta.nsecs >= 0) {
+        if (nstime_cmp(&recent_delta, &relative_time_window) > 0)
+            return FALSE;
+        if (fd_hash_times_ordered)
+            return TRUE;
+    }
+
     /*
      * Look for relative time related duplicates.
      * This is hopefully a reasonably efficient mechanism for
@@ -1687,7 +1800,11 @@ main(int argc, char *argv[])
             memset(&fd_hash[i].digest, 0, 16);
             fd_hash[i].len = 0;
             nstime_set_unset(&fd_hash[i].frame_time);
+            fd_hash[i].indexed = FALSE;
         }
+        fd_hash_index = g_hash_table_new_full(fd_hash_index_hash,
+                                              fd_hash_index_equal,
+                                              fd_hash_index_free, NULL);
     }
 
     /* Set up an array of all IDBs seen */
@@ -2278,6 +2395,10 @@ clean_exit:
         g_ptr_array_free(capture_comments, TRUE);
         capture_comments = NULL;
     }
+    if (fd_hash_index != NULL) {
+        g_hash_table_destroy(fd_hash_index);
+        fd_hash_index = NULL;
+    }
     return ret;
 }
 
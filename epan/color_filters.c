@@ -43,6 +43,18 @@ static GSList *color_filter_list = NULL;
 static GSList *color_filter_deleted_list = NULL;
 static GSList *color_filter_valid_list   = NULL;
 
+/* Filters that have matched a frame, indexed by the color_filter_index
+ * in frame_data, which is smaller than a pointer.  Entry 0 is unused, as
+ * index 0 means "none"; deleted filters leave a NULL entry behind, so an
+ * index is never reused for a different filter. */
+static GPtrArray *color_filter_frame_table = NULL;
+
+/* The enabled, compiled filters of color_filter_list, applied as one group
+ * so that a field is read from the tree once for all of them. Built on
+ * first use, and thrown away whenever the list or its filters change. */
+static dfilter_group_t *color_filter_group = NULL;
+static GPtrArray *color_filter_group_rules = NULL;
+
 /* Color Filters can en-/disabled. */
 static gboolean filters_enabled = TRUE;
 
@@ -51,6 +63,34 @@ static gboolean filters_enabled = TRUE;
  */
 static gboolean tmp_colors_set = FALSE;
 
+static void
+color_filters_invalidate_group(void)
+{
+    dfilter_group_free(color_filter_group);
+    color_filter_group = NULL;
+    if (color_filter_group_rules != NULL) {
+        g_ptr_array_free(color_filter_group_rules, TRUE);
+        color_filter_group_rules = NULL;
+    }
+}
+
+static void
+color_filters_build_group(void)
+{
+    GSList         *curr;
+    color_filter_t *colorf;
+
+    color_filter_group = dfilter_group_new();
+    color_filter_group_rules = g_ptr_array_new();
+    for (curr = color_filter_list; curr != NULL; curr = g_slist_next(curr)) {
+        colorf = (color_filter_t *)curr->data;
+        if (!colorf->disabled && colorf->c_colorfilter != NULL) {
+            dfilter_group_add(color_filter_group, colorf->c_colorfilter);
+            g_ptr_array_add(color_filter_group_rules, colorf);
+        }
+    }
+}
+
 /* Create a new filter */
 color_filter_t *
 color_filter_new(const gchar *name,          /* The name of the filter to create */
@@ -154,6 +194,9 @@ color_filters_set_tmp(guint8 filt_nr, const gchar *filter, gboolean disabled, gc
     dfilter_t      *compiled_filter;
     guint8         i;
     gchar          *local_err_msg = NULL;
+
+    color_filters_invalidate_group();
+
     /* Go through the temporary filters and look for the same filter string.
      * If found, clear it so that a filter can be "moved" up and down the list
      */
@@ -232,6 +275,8 @@ color_filters_reset_tmp(gchar **err_msg)
 void
 color_filter_delete(color_filter_t *colorf)
 {
+    if (colorf->frame_index != 0)
+        g_ptr_array_index(color_filter_frame_table, colorf->frame_index) = NULL;
     g_free(colorf->filter_name);
     g_free(colorf->filter_text);
     dfilter_free(colorf->c_colorfilter);
@@ -268,6 +313,7 @@ color_filter_clone(color_filter_t *colorf)
     new_colorf->fg_color            = colorf->fg_color;
     new_colorf->disabled            = colorf->disabled;
     new_colorf->c_colorfilter       = NULL;
+    new_colorf->frame_index         = 0;
 
     return new_colorf;
 }
@@ -346,6 +392,7 @@ gboolean
 color_filters_init(gchar** err_msg, color_filter_add_cb_func add_cb)
 {
     /* delete all currently existing filters */
+    color_filters_invalidate_group();
     color_filter_list_delete(&color_filter_list);
 
     /* now try to construct the filters list */
@@ -357,6 +404,7 @@ color_filters_reload(gchar** err_msg, color_filter_add_cb_func add_cb)
 {
     /* "move" old entries to the deleted list
      * we must keep them until the dissection no longer needs them */
+    color_filters_invalidate_group();
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
     color_filter_list = NULL;
 
@@ -451,6 +499,7 @@ color_filters_apply(GSList *tmp_cfl, GSList *edit_cfl, gchar** err_msg)
 
     /* "move" old entries to the deleted list
      * we must keep them until the dissection no longer needs them */
+    color_filters_invalidate_group();
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
     color_filter_list = NULL;
 
@@ -514,27 +563,48 @@ color_filters_prime_edt(epan_dissect_t *edt)
 const color_filter_t *
 color_filters_colorize_packet(epan_dissect_t *edt)
 {
-    GSList         *curr;
     color_filter_t *colorf;
+    int             idx;
 
     /* If we have color filters, "search" for the matching one. */
     if ((edt->tree != NULL) && (color_filters_used())) {
-        curr = color_filter_list;
-
-        while(curr != NULL) {
-            colorf = (color_filter_t *)curr->data;
-            if ( (!colorf->disabled) &&
-                 (colorf->c_colorfilter != NULL) &&
-                 dfilter_apply_edt(colorf->c_colorfilter, edt)) {
-                return colorf;
+        if (color_filter_group == NULL)
+            color_filters_build_group();
+
+        idx = dfilter_group_apply_first(color_filter_group, edt->tree);
+        if (idx >= 0) {
+            colorf = (color_filter_t *)g_ptr_array_index(color_filter_group_rules, idx);
+            if (colorf->frame_index == 0) {
+                if (color_filter_frame_table == NULL) {
+                    color_filter_frame_table = g_ptr_array_new();
+                    g_ptr_array_add(color_filter_frame_table, NULL);
+                }
+                colorf->frame_index = color_filter_frame_table->len;
+                g_ptr_array_add(color_filter_frame_table, colorf);
             }
-            curr = g_slist_next(curr);
+            return colorf;
         }
     }
 
     return NULL;
 }
 
+const color_filter_t *
+color_filters_get_frame_filter(const frame_data *fdata)
+{
+    if (fdata->color_filter_index == 0 || color_filter_frame_table == NULL ||
+        fdata->color_filter_index >= color_filter_frame_table->len)
+        return NULL;
+    return (const color_filter_t *)g_ptr_array_index(color_filter_frame_table, fdata->color_filter_index);
+}
+
+void
+color_filters_set_frame_filter(frame_data *fdata, const color_filter_t *colorf)
+{
+    /* color_filters_colorize_packet() assigns the index of anything it returns */
+    fdata->color_filter_index = colorf ? colorf->frame_index : 0;
+}
+
 /* read filters from the given file */
 /* XXX - Would it make more sense to use GStrings here instead of reallocing
    our buffers? */
@@ -19,6 +19,7 @@ extern "C" {
 #include <wsutil/color.h>
 
 struct epan_dissect;
+struct _frame_data;
 
 #define COLORFILTERS_FILE_NAME          "colorfilters"
 
@@ -37,6 +38,7 @@ typedef struct _color_filter {
 
                                     /* only used inside of color_filters.c */
     struct epan_dfilter *c_colorfilter;  /* compiled filter expression */
+    guint32    frame_index;         /* index stored in frame_data, 0 if not assigned yet */
 
                                     /* only used outside of color_filters.c (beside init) */
 } color_filter_t;
@@ -117,6 +119,24 @@ WS_DLL_PUBLIC void color_filters_prime_edt(struct epan_dissect *edt);
 WS_DLL_PUBLIC const color_filter_t *
 color_filters_colorize_packet(struct epan_dissect *edt);
 
+/** Get the color filter that matched a frame.
+ *
+ * @param fdata the frame
+ * @return the matching color filter, or NULL if none matched, the frame
+ * hasn't been colorized, or the filter has since been deleted
+ */
+WS_DLL_PUBLIC const color_filter_t *
+color_filters_get_frame_filter(const struct _frame_data *fdata);
+
+/** Remember the color filter that matched a frame.
+ *
+ * @param fdata the frame
+ * @param colorf the color filter returned by color_filters_colorize_packet(),
+ * or NULL
+ */
+WS_DLL_PUBLIC void
+color_filters_set_frame_filter(struct _frame_data *fdata, const color_filter_t *colorf);
+
 /** Clone the currently active filter list.
  *
  * @param user_data will be returned by each call to to color_filter_add_cb()
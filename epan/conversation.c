@@ -482,6 +482,12 @@ void conversation_epan_reset(void)
 	new_index = 0;
 }
 
+guint32
+conversation_count(void)
+{
+	return new_index;
+}
+
 /*
  * Does the right thing when inserting into one of the conversation hash tables,
  * taking into account ordering and hash chains and all that good stuff.
@@ -744,7 +750,7 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 	conversation->setup_frame = conversation->last_frame = setup_frame;
 	conversation->data_list = NULL;
 
-	conversation->dissector_tree = wmem_tree_new(wmem_file_scope());
+	conversation->dissector_tree = wmem_btree_new(wmem_file_scope());
 
 	/* set the options and key pointer */
 	conversation->options = options;
@@ -1324,7 +1330,7 @@ void
 conversation_set_dissector_from_frame_number(conversation_t *conversation,
 	const guint32 starting_frame_num, const dissector_handle_t handle)
 {
-	wmem_tree_insert32(conversation->dissector_tree, starting_frame_num, (void *)handle);
+	wmem_btree_insert32(conversation->dissector_tree, starting_frame_num, (void *)handle);
 }
 
 void
@@ -1336,14 +1342,14 @@ conversation_set_dissector(conversation_t *conversation, const dissector_handle_
 dissector_handle_t
 conversation_get_dissector(conversation_t *conversation, const guint32 frame_num)
 {
-	return (dissector_handle_t)wmem_tree_lookup32_le(conversation->dissector_tree, frame_num);
+	return (dissector_handle_t)wmem_btree_lookup32_le(conversation->dissector_tree, frame_num);
 }
 
 static gboolean try_conversation_call_dissector_helper(conversation_t *conversation, gboolean* dissector_success,
 					tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data)
 {
 	int ret;
-	dissector_handle_t handle = (dissector_handle_t)wmem_tree_lookup32_le(
+	dissector_handle_t handle = (dissector_handle_t)wmem_btree_lookup32_le(
 					conversation->dissector_tree, pinfo->num);
 	if (handle == NULL)
 		return FALSE;
@@ -1420,7 +1426,7 @@ try_conversation_dissector_by_id(const endpoint_type etype, const guint32 id, tv
 	if (conversation != NULL) {
 		int ret;
 
-		dissector_handle_t handle = (dissector_handle_t)wmem_tree_lookup32_le(conversation->dissector_tree, pinfo->num);
+		dissector_handle_t handle = (dissector_handle_t)wmem_btree_lookup32_le(conversation->dissector_tree, pinfo->num);
 		if (handle == NULL)
 			return FALSE;
 		ret = call_dissector_only(handle, tvb, pinfo, tree, data);
@@ -1482,6 +1488,24 @@ find_conversation_pinfo(packet_info *pinfo, const guint options)
 	return conv;
 }
 
+/**  A helper function that calls find_conversation() using data from pinfo,
+ *  as above, but without updating the last frame of the conversation found.
+ */
+conversation_t *
+find_conversation_pinfo_ro(const packet_info *pinfo, const guint options)
+{
+	if (pinfo->use_endpoint) {
+		DISSECTOR_ASSERT(pinfo->conv_endpoint);
+		return find_conversation(pinfo->num, &pinfo->conv_endpoint->addr1, &pinfo->conv_endpoint->addr2,
+					 pinfo->conv_endpoint->etype, pinfo->conv_endpoint->port1,
+					 pinfo->conv_endpoint->port2, pinfo->conv_endpoint->options);
+	}
+
+	return find_conversation(pinfo->num, &pinfo->src, &pinfo->dst,
+				 conversation_pt_to_endpoint_type(pinfo->ptype), pinfo->srcport,
+				 pinfo->destport, options);
+}
+
 /*  A helper function that calls find_conversation() and, if a conversation is
  *  not found, calls conversation_new().
  *  The frame number and addresses are taken from pinfo.
@@ -95,7 +95,7 @@ typedef struct conversation {
 					/* Assume that setup_frame is also the lowest frame number for now. */
 	guint32 last_frame;		/** highest frame number in this conversation */
 	wmem_tree_t *data_list;		/** list of data associated with conversation */
-	wmem_tree_t *dissector_tree;	/** tree containing protocol dissector client associated with conversation */
+	wmem_btree_t *dissector_tree;	/** tree containing protocol dissector client associated with conversation */
 	guint	options;		/** wildcard flags */
 	conversation_key_t key_ptr;	/** pointer to the key for this conversation */
 } conversation_t;
@@ -119,6 +119,12 @@ extern void conversation_init(void);
  */
 extern void conversation_epan_reset(void);
 
+/**
+ * Returns the number of conversations created since the last time the
+ * variables were initialized, i.e. since the file was (re)loaded.
+ */
+WS_DLL_PUBLIC guint32 conversation_count(void);
+
 /*
  * Given two address/port pairs for a packet, create a new conversation
  * to contain packets between those address/port pairs.
@@ -178,6 +184,12 @@ WS_DLL_PUBLIC conversation_t *find_conversation_by_id(const guint32 frame, const
  */
 WS_DLL_PUBLIC conversation_t *find_conversation_pinfo(packet_info *pinfo, const guint options);
 
+/**  A helper function that calls find_conversation() using data from pinfo,
+ *  as above, but without updating the last frame of the conversation found,
+ *  for callers that only want to know which conversation a packet is in.
+ */
+WS_DLL_PUBLIC conversation_t *find_conversation_pinfo_ro(const packet_info *pinfo, const guint options);
+
 /**  A helper function that calls find_conversation() and, if a conversation is
  *  not found, calls conversation_new().
  *  The frame number and addresses are taken from pinfo.
@@ -21,9 +21,12 @@ struct epan_dfilter {
 	GPtrArray	*consts;
 	guint		num_registers;
 	guint		max_registers;
-	GList		**registers;
+	GPtrArray	**registers;	/* fvalue_t*, emptied after each run */
+	GPtrArray	**slices;	/* FT_BYTES fvalue_t* reused by MK_RANGE */
 	gboolean	*attempted_load;
 	gboolean	*owns_memory;
+	GHashTable	*shared_loads;	/* set while applied as part of a group */
+	GPtrArray	*spare_loads;	/* the group's empty arrays for shared_loads */
 	int		*interesting_fields;
 	int		num_interesting_fields;
 	GPtrArray	*deprecated;
@@ -133,10 +133,14 @@ dfilter_free(dfilter_t *df)
 
 	g_free(df->interesting_fields);
 
-	/* Clear registers with constant values (as set by dfvm_init_const).
-	 * Other registers were cleared on RETURN by free_register_overhead. */
-	for (i = df->num_registers; i < df->max_registers; i++) {
-		g_list_free(df->registers[i]);
+	/* The values in registers were emptied on RETURN by
+	 * free_register_overhead, or belong to the constant instructions
+	 * (as set by dfvm_init_const). */
+	for (i = 0; i < df->max_registers; i++) {
+		g_ptr_array_free(df->registers[i], TRUE);
+		if (df->slices[i]) {
+			g_ptr_array_free(df->slices[i], TRUE);
+		}
 	}
 
 	if (df->deprecated) {
@@ -148,6 +152,7 @@ dfilter_free(dfilter_t *df)
 	}
 
 	g_free(df->registers);
+	g_free(df->slices);
 	g_free(df->attempted_load);
 	g_free(df->owns_memory);
 	g_free(df);
@@ -349,7 +354,11 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		/* Initialize run-time space */
 		dfilter->num_registers = dfw->first_constant;
 		dfilter->max_registers = dfw->next_register;
-		dfilter->registers = g_new0(GList*, dfilter->max_registers);
+		dfilter->registers = g_new(GPtrArray*, dfilter->max_registers);
+		for (i = 0; i < dfilter->max_registers; i++) {
+			dfilter->registers[i] = g_ptr_array_new();
+		}
+		dfilter->slices = g_new0(GPtrArray*, dfilter->max_registers);
 		dfilter->attempted_load = g_new0(gboolean, dfilter->max_registers);
 		dfilter->owns_memory = g_new0(gboolean, dfilter->max_registers);
 
@@ -421,12 +430,116 @@ dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree)
 	}
 }
 
+struct epan_dfilter_group {
+	GPtrArray	*filters;
+	GHashTable	*loads;		/* header_field_info -> GPtrArray of fvalues */
+	GPtrArray	*spare;		/* emptied arrays of loads, for the next tree */
+};
+
+static void
+free_loaded_values(gpointer data)
+{
+	/* NULL if the field wasn't in the tree. */
+	if (data) {
+		g_ptr_array_free((GPtrArray *)data, TRUE);
+	}
+}
+
+static gboolean
+spare_loaded_values(gpointer key _U_, gpointer value, gpointer user_data)
+{
+	GPtrArray	*spare = (GPtrArray *)user_data;
+
+	if (value) {
+		g_ptr_array_set_size((GPtrArray *)value, 0);
+		g_ptr_array_add(spare, value);
+	}
+	return TRUE;
+}
+
+dfilter_group_t *
+dfilter_group_new(void)
+{
+	dfilter_group_t	*group;
+
+	group = g_new(dfilter_group_t, 1);
+	group->filters = g_ptr_array_new();
+	group->loads = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, free_loaded_values);
+	group->spare = g_ptr_array_new_with_free_func(free_loaded_values);
+
+	return group;
+}
+
+void
+dfilter_group_free(dfilter_group_t *group)
+{
+	if (!group)
+		return;
+
+	g_ptr_array_free(group->filters, TRUE);
+	g_hash_table_destroy(group->loads);
+	g_ptr_array_free(group->spare, TRUE);
+	g_free(group);
+}
+
+guint
+dfilter_group_add(dfilter_group_t *group, dfilter_t *df)
+{
+	g_ptr_array_add(group->filters, df);
+	return group->filters->len - 1;
+}
+
+gboolean
+dfilter_group_apply(dfilter_group_t *group, dfilter_t *df, proto_tree *tree)
+{
+	return dfvm_apply_with_loads(df, tree, group->loads, group->spare);
+}
+
+void
+dfilter_group_reset(dfilter_group_t *group)
+{
+	/* Keep the arrays for the next tree. */
+	g_hash_table_foreach_steal(group->loads, spare_loaded_values, group->spare);
+}
+
+int
+dfilter_group_apply_first(dfilter_group_t *group, proto_tree *tree)
+{
+	guint	i;
+	int	passed = -1;
+
+	for (i = 0; i < group->filters->len; i++) {
+		if (dfvm_apply_with_loads((dfilter_t *)g_ptr_array_index(group->filters, i),
+					tree, group->loads, group->spare)) {
+			passed = (int)i;
+			break;
+		}
+	}
+	dfilter_group_reset(group);
+
+	return passed;
+}
+
 gboolean
 dfilter_has_interesting_fields(const dfilter_t *df)
 {
 	return (df->num_interesting_fields > 0);
 }
 
+gboolean
+dfilter_interested_in_field(const dfilter_t *df, int hfid)
+{
+	int i;
+
+	for (i = 0; i < df->num_interesting_fields; i++) {
+		if (df->interesting_fields[i] == hfid) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df) {
 	if (df->deprecated && df->deprecated->len > 0) {
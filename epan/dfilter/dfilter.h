@@ -15,6 +15,10 @@
 /* Passed back to user */
 typedef struct epan_dfilter dfilter_t;
 
+/* Filters applied to the same packets, e.g. coloring rules or the filters
+ * of several tap listeners, that share the fields loaded from the tree */
+typedef struct epan_dfilter_group dfilter_group_t;
+
 #include <epan/proto.h>
 
 #ifdef __cplusplus
@@ -68,10 +72,49 @@ dfilter_apply(dfilter_t *df, proto_tree *tree);
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree);
 
+/* Create an empty group of filters. */
+WS_DLL_PUBLIC
+dfilter_group_t *
+dfilter_group_new(void);
+
+/* Frees the group. The filters added to it are not freed. */
+WS_DLL_PUBLIC
+void
+dfilter_group_free(dfilter_group_t *group);
+
+/* Adds a filter, which must outlive the group, to the end of the group.
+ * Returns the index of the filter within the group. */
+WS_DLL_PUBLIC
+guint
+dfilter_group_add(dfilter_group_t *group, dfilter_t *df);
+
+/* Apply a compiled dfilter, reusing the fields already loaded from the
+ * same tree through this group. The filter needn't have been added to
+ * the group. Call dfilter_group_reset() before moving on to another tree. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_group_apply(dfilter_group_t *group, dfilter_t *df, proto_tree *tree);
+
+/* Forget the fields loaded from the last tree. */
+WS_DLL_PUBLIC
+void
+dfilter_group_reset(dfilter_group_t *group);
+
+/* Apply the filters of the group in order, stopping at the first one that
+ * passes. Returns its index, or -1 if none of them passed. */
+WS_DLL_PUBLIC
+int
+dfilter_group_apply_first(dfilter_group_t *group, proto_tree *tree);
+
 /* Check if dfilter has interesting fields */
 gboolean
 dfilter_has_interesting_fields(const dfilter_t *df);
 
+/* Check if dfilter looks at the field with the given id */
+WS_DLL_PUBLIC
+gboolean
+dfilter_interested_in_field(const dfilter_t *df, int hfid);
+
 WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
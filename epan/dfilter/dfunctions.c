@@ -21,16 +21,15 @@
 
 /* Convert an FT_STRING using a callback function */
 static gboolean
-string_walk(GList* arg1list, GList **retval, gchar(*conv_func)(gchar))
+string_walk(GPtrArray *arg1, GPtrArray *retval, gchar(*conv_func)(gchar))
 {
-    GList       *arg1;
+    guint       i;
     fvalue_t    *arg_fvalue;
     fvalue_t    *new_ft_string;
     char *s, *c;
 
-    arg1 = arg1list;
-    while (arg1) {
-        arg_fvalue = (fvalue_t *)arg1->data;
+    for (i = 0; i < arg1->len; i++) {
+        arg_fvalue = (fvalue_t *)g_ptr_array_index(arg1, i);
         /* XXX - it would be nice to handle FT_TVBUFF, too */
         if (IS_FT_STRING(fvalue_type_ftenum(arg_fvalue))) {
             s = (char *)wmem_strdup(NULL, (gchar *)fvalue_get(arg_fvalue));
@@ -41,9 +40,8 @@ string_walk(GList* arg1list, GList **retval, gchar(*conv_func)(gchar))
             new_ft_string = fvalue_new(FT_STRING);
             fvalue_set_string(new_ft_string, s);
             wmem_free(NULL, s);
-            *retval = g_list_append(*retval, new_ft_string);
+            g_ptr_array_add(retval, new_ft_string);
         }
-        arg1 = arg1->next;
     }
 
     return TRUE;
@@ -51,33 +49,31 @@ string_walk(GList* arg1list, GList **retval, gchar(*conv_func)(gchar))
 
 /* dfilter function: lower() */
 static gboolean
-df_func_lower(GList* arg1list, GList *arg2junk _U_, GList **retval)
+df_func_lower(GPtrArray *arg1, GPtrArray *arg2junk _U_, GPtrArray *retval)
 {
-    return string_walk(arg1list, retval, g_ascii_tolower);
+    return string_walk(arg1, retval, g_ascii_tolower);
 }
 
 /* dfilter function: upper() */
 static gboolean
-df_func_upper(GList* arg1list, GList *arg2junk _U_, GList **retval)
+df_func_upper(GPtrArray *arg1, GPtrArray *arg2junk _U_, GPtrArray *retval)
 {
-    return string_walk(arg1list, retval, g_ascii_toupper);
+    return string_walk(arg1, retval, g_ascii_toupper);
 }
 
 /* dfilter function: len() */
 static gboolean
-df_func_len(GList* arg1list, GList *arg2junk _U_, GList **retval)
+df_func_len(GPtrArray *arg1, GPtrArray *arg2junk _U_, GPtrArray *retval)
 {
-    GList       *arg1;
+    guint       i;
     fvalue_t    *arg_fvalue;
     fvalue_t    *ft_len;
 
-    arg1 = arg1list;
-    while (arg1) {
-        arg_fvalue = (fvalue_t *)arg1->data;
+    for (i = 0; i < arg1->len; i++) {
+        arg_fvalue = (fvalue_t *)g_ptr_array_index(arg1, i);
         ft_len = fvalue_new(FT_UINT32);
         fvalue_set_uinteger(ft_len, fvalue_length(arg_fvalue));
-        *retval = g_list_append(*retval, ft_len);
-        arg1 = arg1->next;
+        g_ptr_array_add(retval, ft_len);
     }
 
     return TRUE;
@@ -85,31 +81,31 @@ df_func_len(GList* arg1list, GList *arg2junk _U_, GList **retval)
 
 /* dfilter function: count() */
 static gboolean
-df_func_count(GList* arg1list, GList *arg2junk _U_, GList **retval)
+df_func_count(GPtrArray *arg1, GPtrArray *arg2junk _U_, GPtrArray *retval)
 {
     fvalue_t *ft_ret;
     guint32   num_items;
 
-    num_items = (guint32)g_list_length(arg1list);
+    num_items = (guint32)arg1->len;
 
     ft_ret = fvalue_new(FT_UINT32);
     fvalue_set_uinteger(ft_ret, num_items);
-    *retval = g_list_append(*retval, ft_ret);
+    g_ptr_array_add(retval, ft_ret);
 
     return TRUE;
 }
 
 /* dfilter function: string() */
 static gboolean
-df_func_string(GList* arg1list, GList *arg2junk _U_, GList **retval)
+df_func_string(GPtrArray *arg1, GPtrArray *arg2junk _U_, GPtrArray *retval)
 {
-    GList    *arg1 = arg1list;
+    guint     i;
     fvalue_t *arg_fvalue;
     fvalue_t *new_ft_string;
     char     *s;
 
-    while (arg1) {
-        arg_fvalue = (fvalue_t *)arg1->data;
+    for (i = 0; i < arg1->len; i++) {
+        arg_fvalue = (fvalue_t *)g_ptr_array_index(arg1, i);
         switch (fvalue_type_ftenum(arg_fvalue))
         {
         case FT_UINT8:
@@ -156,9 +152,7 @@ df_func_string(GList* arg1list, GList *arg2junk _U_, GList **retval)
         new_ft_string = fvalue_new(FT_STRING);
         fvalue_set_string(new_ft_string, s);
         wmem_free(NULL, s);
-        *retval = g_list_append(*retval, new_ft_string);
-
-        arg1 = arg1->next;
+        g_ptr_array_add(retval, new_ft_string);
     }
 
     return TRUE;
@@ -8,10 +8,42 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "dfvm.h"
 
 #include <ftypes/ftypes-int.h>
 
+/* How the elements of a dfvm_fvalue_set_t are turned into hash keys.
+ * Only ftypes for which "==" is a plain comparison of the value can be
+ * indexed this way. */
+enum {
+	SET_KEY_NONE = -1,
+	SET_KEY_UINT,
+	SET_KEY_SINT,
+	SET_KEY_IPV4,
+	SET_KEY_IPV6,
+	SET_KEY_STRING,
+	SET_KEY_BYTES
+};
+
+typedef struct {
+	const guint8	*data;
+	gsize		len;
+} set_key_t;
+
+typedef struct {
+	guint64		low;
+	guint64		high;
+} set_range_t;
+
+static void
+free_fvalue_cb(gpointer data)
+{
+	fvalue_t *fv = (fvalue_t *)data;
+	FVALUE_FREE(fv);
+}
+
 dfvm_insn_t*
 dfvm_insn_new(dfvm_opcode_t op)
 {
@@ -36,6 +68,9 @@ dfvm_value_free(dfvm_value_t *v)
 		case DRANGE:
 			drange_free(v->value.drange);
 			break;
+		case FVALUE_SET:
+			dfvm_fvalue_set_free(v->value.fvalue_set);
+			break;
 		default:
 			/* nothing */
 			;
@@ -72,6 +107,282 @@ dfvm_value_new(dfvm_value_type_t type)
 	return v;
 }
 
+static int
+set_key_class(ftenum_t ftype)
+{
+	if (IS_FT_UINT(ftype))
+		return SET_KEY_UINT;
+	if (IS_FT_INT(ftype))
+		return SET_KEY_SINT;
+	if (IS_FT_STRING(ftype) || ftype == FT_UINT_STRING)
+		return SET_KEY_STRING;
+
+	switch (ftype) {
+		case FT_IPv4:
+			return SET_KEY_IPV4;
+		case FT_IPv6:
+			return SET_KEY_IPV6;
+		case FT_BYTES:
+		case FT_UINT_BYTES:
+		case FT_AX25:
+		case FT_VINES:
+		case FT_ETHER:
+		case FT_OID:
+		case FT_REL_OID:
+		case FT_SYSTEM_ID:
+		case FT_FCWWN:
+			return SET_KEY_BYTES;
+		default:
+			return SET_KEY_NONE;
+	}
+}
+
+/* Fills in the hash key for an fvalue. Integers are also returned in
+ * *ordinal, mapped so that unsigned comparison gives their natural order.
+ * Returns FALSE if the value cannot be compared by key, e.g. an IPv4 or
+ * IPv6 subnet, where equality depends on the prefix length. */
+static gboolean
+set_key_from_fvalue(int key_class, const fvalue_t *fv, set_key_t *key, guint64 *ordinal)
+{
+	ftenum_t	ftype = fv->ftype->ftype;
+
+	switch (key_class) {
+		case SET_KEY_UINT:
+			if (IS_FT_UINT32(ftype))
+				*ordinal = fv->value.uinteger;
+			else
+				*ordinal = fv->value.uinteger64;
+			key->data = (const guint8 *)ordinal;
+			key->len = sizeof(*ordinal);
+			return TRUE;
+
+		case SET_KEY_SINT:
+			if (IS_FT_INT32(ftype))
+				*ordinal = (guint64)(gint64)fv->value.sinteger;
+			else
+				*ordinal = (guint64)fv->value.sinteger64;
+			*ordinal ^= G_GUINT64_CONSTANT(0x8000000000000000);
+			key->data = (const guint8 *)ordinal;
+			key->len = sizeof(*ordinal);
+			return TRUE;
+
+		case SET_KEY_IPV4:
+			if (fv->value.ipv4.nmask != 0xffffffff)
+				return FALSE;
+			key->data = (const guint8 *)&fv->value.ipv4.addr;
+			key->len = sizeof(fv->value.ipv4.addr);
+			return TRUE;
+
+		case SET_KEY_IPV6:
+			if (fv->value.ipv6.prefix != 128)
+				return FALSE;
+			key->data = fv->value.ipv6.addr.bytes;
+			key->len = sizeof(fv->value.ipv6.addr.bytes);
+			return TRUE;
+
+		case SET_KEY_STRING:
+			key->data = (const guint8 *)fv->value.string;
+			key->len = strlen(fv->value.string);
+			return TRUE;
+
+		case SET_KEY_BYTES:
+			key->data = fv->value.bytes->data;
+			key->len = fv->value.bytes->len;
+			return TRUE;
+
+		default:
+			return FALSE;
+	}
+}
+
+static guint
+set_key_hash(gconstpointer k)
+{
+	const set_key_t	*key = (const set_key_t *)k;
+	guint		h = 5381;
+	gsize		i;
+
+	for (i = 0; i < key->len; i++)
+		h = (h << 5) + h + key->data[i];
+	return h;
+}
+
+static gboolean
+set_key_equal(gconstpointer a, gconstpointer b)
+{
+	const set_key_t	*key_a = (const set_key_t *)a;
+	const set_key_t	*key_b = (const set_key_t *)b;
+
+	return key_a->len == key_b->len &&
+		memcmp(key_a->data, key_b->data, key_a->len) == 0;
+}
+
+static gint
+set_range_compare(gconstpointer a, gconstpointer b)
+{
+	const set_range_t *range_a = (const set_range_t *)a;
+	const set_range_t *range_b = (const set_range_t *)b;
+
+	if (range_a->low < range_b->low)
+		return -1;
+	return range_a->low > range_b->low;
+}
+
+/* Can the constant elements of a set compared against this field be
+ * indexed? Every field with the same name must use the same kind of key. */
+gboolean
+dfvm_fvalue_set_supported(header_field_info *hfinfo)
+{
+	int	key_class;
+
+	/* Rewind to find the first field of this name. */
+	while (hfinfo->same_name_prev_id != -1) {
+		hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+	}
+
+	key_class = set_key_class(hfinfo->type);
+	if (key_class == SET_KEY_NONE)
+		return FALSE;
+
+	for (hfinfo = hfinfo->same_name_next; hfinfo; hfinfo = hfinfo->same_name_next) {
+		if (set_key_class(hfinfo->type) != key_class)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+dfvm_fvalue_set_t *
+dfvm_fvalue_set_new(header_field_info *hfinfo)
+{
+	dfvm_fvalue_set_t *set;
+
+	set = g_new(dfvm_fvalue_set_t, 1);
+	set->key_class = set_key_class(hfinfo->type);
+	set->values = g_hash_table_new_full(set_key_hash, set_key_equal, g_free, NULL);
+	set->ranges = g_array_new(FALSE, FALSE, sizeof(set_range_t));
+	set->fvalues = g_ptr_array_new_with_free_func(free_fvalue_cb);
+	return set;
+}
+
+void
+dfvm_fvalue_set_free(dfvm_fvalue_set_t *set)
+{
+	g_hash_table_destroy(set->values);
+	g_array_free(set->ranges, TRUE);
+	g_ptr_array_free(set->fvalues, TRUE);
+	g_free(set);
+}
+
+/* Adds an element to the set. On success the set takes ownership of
+ * the fvalue; if the value cannot be indexed, FALSE is returned and the
+ * caller must test it some other way. */
+gboolean
+dfvm_fvalue_set_add(dfvm_fvalue_set_t *set, fvalue_t *fv)
+{
+	set_key_t	key, *copy;
+	guint64		ordinal;
+
+	if (!set_key_from_fvalue(set->key_class, fv, &key, &ordinal))
+		return FALSE;
+
+	/* Keep the key and a copy of its bytes in one allocation. */
+	copy = (set_key_t *)g_malloc(sizeof(set_key_t) + key.len);
+	memcpy(copy + 1, key.data, key.len);
+	copy->data = (const guint8 *)(copy + 1);
+	copy->len = key.len;
+	g_hash_table_replace(set->values, copy, fv);
+	g_ptr_array_add(set->fvalues, fv);
+	return TRUE;
+}
+
+/* Adds a "low..high" element to the set. Only integer ranges can be
+ * indexed; on success both fvalues are consumed. */
+gboolean
+dfvm_fvalue_set_add_range(dfvm_fvalue_set_t *set, fvalue_t *low, fvalue_t *high)
+{
+	set_key_t	key;
+	set_range_t	range;
+
+	if (set->key_class != SET_KEY_UINT && set->key_class != SET_KEY_SINT)
+		return FALSE;
+
+	set_key_from_fvalue(set->key_class, low, &key, &range.low);
+	set_key_from_fvalue(set->key_class, high, &key, &range.high);
+	/* An inverted range never matches anything. */
+	if (range.low <= range.high)
+		g_array_append_val(set->ranges, range);
+
+	FVALUE_FREE(low);
+	FVALUE_FREE(high);
+	return TRUE;
+}
+
+/* Sorts the ranges and merges any that overlap, so that a lookup is a
+ * single binary search. */
+void
+dfvm_fvalue_set_finish(dfvm_fvalue_set_t *set)
+{
+	set_range_t	*ranges;
+	guint		i, n;
+
+	if (set->ranges->len < 2)
+		return;
+
+	g_array_sort(set->ranges, set_range_compare);
+	ranges = (set_range_t *)(void *)set->ranges->data;
+	n = 0;
+	for (i = 1; i < set->ranges->len; i++) {
+		if (ranges[i].low <= ranges[n].high ||
+		    ranges[i].low - 1 == ranges[n].high) {
+			if (ranges[i].high > ranges[n].high)
+				ranges[n].high = ranges[i].high;
+		} else {
+			ranges[++n] = ranges[i];
+		}
+	}
+	g_array_set_size(set->ranges, n + 1);
+}
+
+guint
+dfvm_fvalue_set_size(const dfvm_fvalue_set_t *set)
+{
+	return set->fvalues->len + set->ranges->len;
+}
+
+static gboolean
+fvalue_set_contains(const dfvm_fvalue_set_t *set, const fvalue_t *fv)
+{
+	set_key_t		key;
+	guint64			ordinal;
+	const set_range_t	*ranges;
+	guint			lo, hi, mid;
+
+	if (!set_key_from_fvalue(set->key_class, fv, &key, &ordinal)) {
+		/* Not a plain value; compare it against every element. */
+		for (lo = 0; lo < set->fvalues->len; lo++) {
+			if (fvalue_eq(fv, (fvalue_t *)g_ptr_array_index(set->fvalues, lo)))
+				return TRUE;
+		}
+		return FALSE;
+	}
+
+	if (g_hash_table_contains(set->values, &key))
+		return TRUE;
+
+	/* Find the last range starting at or below the value. */
+	ranges = (const set_range_t *)(void *)set->ranges->data;
+	lo = 0;
+	hi = set->ranges->len;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (ranges[mid].low <= ordinal)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo > 0 && ordinal <= ranges[lo - 1].high;
+}
+
 
 void
 dfvm_dump(FILE *f, dfilter_t *df)
@@ -119,6 +430,7 @@ dfvm_dump(FILE *f, dfilter_t *df)
 			case ANY_CONTAINS:
 			case ANY_MATCHES:
 			case ANY_IN_RANGE:
+			case ANY_IN_SET:
 			case NOT:
 			case RETURN:
 			case IF_TRUE_GOTO:
@@ -259,6 +571,12 @@ dfvm_dump(FILE *f, dfilter_t *df)
 					arg3->value.numeric);
 				break;
 
+			case ANY_IN_SET:
+				fprintf(f, "%05d ANY_IN_SET\treg#%u in set of %u elements\n",
+					id, arg1->value.numeric,
+					dfvm_fvalue_set_size(arg2->value.fvalue_set));
+				break;
+
 			case NOT:
 				fprintf(f, "%05d NOT\n", id);
 				break;
@@ -284,56 +602,81 @@ dfvm_dump(FILE *f, dfilter_t *df)
 	}
 }
 
+/* Appends the fvalues in one array to another. */
+static void
+append_fvalues(GPtrArray *to, const GPtrArray *from)
+{
+	guint	i;
+
+	for (i = 0; i < from->len; i++) {
+		g_ptr_array_add(to, g_ptr_array_index(from, i));
+	}
+}
+
 /* Reads a field from the proto_tree and loads the fvalues into a register,
  * if that field has not already been read. */
 static gboolean
 read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 {
+	header_field_info	*first_hfinfo;
 	GPtrArray	*finfos;
 	field_info	*finfo;
+	GPtrArray	*fvalues = df->registers[reg];
+	GPtrArray	*loaded;
 	int		i, len;
-	GList		*fvalues = NULL;
-	gboolean	found_something = FALSE;
 
 	/* Already loaded in this run of the dfilter? */
 	if (df->attempted_load[reg]) {
-		if (df->registers[reg]) {
-			return TRUE;
-		}
-		else {
-			return FALSE;
-		}
+		return fvalues->len > 0;
 	}
 
 	df->attempted_load[reg] = TRUE;
+	// These values are referenced only, do not try to free them later.
+	df->owns_memory[reg] = FALSE;
 
-	while (hfinfo) {
-		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
-		if ((finfos == NULL) || (g_ptr_array_len(finfos) == 0)) {
-			hfinfo = hfinfo->same_name_next;
-			continue;
-		}
-		else {
-			found_something = TRUE;
+	/* Already loaded by another filter applied to this tree? */
+	if (df->shared_loads &&
+	    g_hash_table_lookup_extended(df->shared_loads, hfinfo,
+			NULL, (gpointer *)&loaded)) {
+		if (!loaded) {
+			return FALSE;
 		}
+		append_fvalues(fvalues, loaded);
+		return TRUE;
+	}
 
-		len = finfos->len;
-		for (i = 0; i < len; i++) {
-			finfo = (field_info *)g_ptr_array_index(finfos, i);
-			fvalues = g_list_prepend(fvalues, &finfo->value);
+	first_hfinfo = hfinfo;
+	while (hfinfo) {
+		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
+		if (finfos != NULL) {
+			len = finfos->len;
+			for (i = 0; i < len; i++) {
+				finfo = (field_info *)g_ptr_array_index(finfos, i);
+				g_ptr_array_add(fvalues, &finfo->value);
+			}
 		}
 
 		hfinfo = hfinfo->same_name_next;
 	}
 
-	if (!found_something) {
-		return FALSE;
+	if (df->shared_loads) {
+		/* Remember misses too, the table takes the copy. Its arrays
+		 * are kept for the next trees rather than allocated for every
+		 * field of every packet. */
+		loaded = NULL;
+		if (fvalues->len > 0) {
+			if (df->spare_loads->len > 0) {
+				loaded = (GPtrArray *)g_ptr_array_remove_index_fast(df->spare_loads,
+						df->spare_loads->len - 1);
+			} else {
+				loaded = g_ptr_array_sized_new(fvalues->len);
+			}
+			append_fvalues(loaded, fvalues);
+		}
+		g_hash_table_insert(df->shared_loads, first_hfinfo, loaded);
 	}
 
-	df->registers[reg] = fvalues;
-	// These values are referenced only, do not try to free it later.
-	df->owns_memory[reg] = FALSE;
-	return TRUE;
+	return fvalues->len > 0;
 }
 
 
@@ -342,7 +685,7 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 static gboolean
 put_fvalue(dfilter_t *df, fvalue_t *fv, int reg)
 {
-	df->registers[reg] = g_list_append(NULL, fv);
+	g_ptr_array_add(df->registers[reg], fv);
 	df->owns_memory[reg] = FALSE;
 	return TRUE;
 }
@@ -352,19 +695,21 @@ typedef gboolean (*FvalueCmpFunc)(const fvalue_t*, const fvalue_t*);
 static gboolean
 any_test(dfilter_t *df, FvalueCmpFunc cmp, int reg1, int reg2)
 {
-	GList	*list_a, *list_b;
-
-	list_a = df->registers[reg1];
-
-	while (list_a) {
-		list_b = df->registers[reg2];
-		while (list_b) {
-			if (cmp((fvalue_t *)list_a->data, (fvalue_t *)list_b->data)) {
+	GPtrArray	*reg_a, *reg_b;
+	fvalue_t	**values_a, **values_b;
+	guint		i, j;
+
+	reg_a = df->registers[reg1];
+	reg_b = df->registers[reg2];
+	values_a = (fvalue_t **)reg_a->pdata;
+	values_b = (fvalue_t **)reg_b->pdata;
+
+	for (i = 0; i < reg_a->len; i++) {
+		for (j = 0; j < reg_b->len; j++) {
+			if (cmp(values_a[i], values_b[j])) {
 				return TRUE;
 			}
-			list_b = g_list_next(list_b);
 		}
-		list_a = g_list_next(list_a);
 	}
 	return FALSE;
 }
@@ -372,34 +717,47 @@ any_test(dfilter_t *df, FvalueCmpFunc cmp, int reg1, int reg2)
 static gboolean
 any_in_range(dfilter_t *df, int reg1, int reg2, int reg3)
 {
-	GList	*list1, *list_low, *list_high;
-	fvalue_t *low, *high;
+	GPtrArray	*reg, *reg_low, *reg_high;
+	fvalue_t	*low, *high, *value;
+	guint		i;
 
-	list1 = df->registers[reg1];
-	list_low = df->registers[reg2];
-	list_high = df->registers[reg3];
+	reg = df->registers[reg1];
+	reg_low = df->registers[reg2];
+	reg_high = df->registers[reg3];
 
 	/* The first register contains the values associated with a field, the
 	 * second and third arguments are expected to be a single value for the
 	 * lower and upper bound respectively. These cannot be fields and thus
-	 * the list length MUST be one. This should have been enforced by
+	 * the array length MUST be one. This should have been enforced by
 	 * grammar.lemon.
 	 */
-	g_assert(list_low && !g_list_next(list_low));
-	g_assert(list_high && !g_list_next(list_high));
-	low = (fvalue_t *)list_low->data;
-	high = (fvalue_t *)list_high->data;
+	g_assert(reg_low->len == 1);
+	g_assert(reg_high->len == 1);
+	low = (fvalue_t *)g_ptr_array_index(reg_low, 0);
+	high = (fvalue_t *)g_ptr_array_index(reg_high, 0);
 
-	while (list1) {
-		fvalue_t *value = (fvalue_t *)list1->data;
+	for (i = 0; i < reg->len; i++) {
+		value = (fvalue_t *)g_ptr_array_index(reg, i);
 		if (fvalue_ge(value, low) && fvalue_le(value, high)) {
 			return TRUE;
 		}
-		list1 = g_list_next(list1);
 	}
 	return FALSE;
 }
 
+static gboolean
+any_in_set(dfilter_t *df, int reg, const dfvm_fvalue_set_t *set)
+{
+	GPtrArray	*values = df->registers[reg];
+	guint		i;
+
+	for (i = 0; i < values->len; i++) {
+		if (fvalue_set_contains(set, (fvalue_t *)g_ptr_array_index(values, i))) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
 
 static void
 free_owned_register(gpointer data, gpointer user_data _U_)
@@ -408,8 +766,9 @@ free_owned_register(gpointer data, gpointer user_data _U_)
 	FVALUE_FREE(value);
 }
 
-/* Clear registers that were populated during evaluation (leaving constants
- * intact). If we created the values, then these will be freed as well. */
+/* Empty registers that were populated during evaluation (leaving constants
+ * intact). If we created the values, then these will be freed as well.
+ * The arrays themselves are kept for the next run. */
 static void
 free_register_overhead(dfilter_t* df)
 {
@@ -417,43 +776,52 @@ free_register_overhead(dfilter_t* df)
 
 	for (i = 0; i < df->num_registers; i++) {
 		df->attempted_load[i] = FALSE;
-		if (df->registers[i]) {
-			if (df->owns_memory[i]) {
-				g_list_foreach(df->registers[i], free_owned_register, NULL);
-				df->owns_memory[i] = FALSE;
-			}
-			g_list_free(df->registers[i]);
-			df->registers[i] = NULL;
+		if (df->owns_memory[i]) {
+			g_ptr_array_foreach(df->registers[i], free_owned_register, NULL);
+			df->owns_memory[i] = FALSE;
 		}
+		g_ptr_array_set_size(df->registers[i], 0);
 	}
 }
 
-/* Takes the list of fvalue_t's in a register, uses fvalue_slice()
- * to make a new list of fvalue_t's (which are ranges, or byte-slices),
- * and puts the new list into a new register. */
+/* Takes the fvalue_t's in a register, uses fvalue_slice()
+ * to make new fvalue_t's (which are ranges, or byte-slices),
+ * and puts them into a new register. The slices are kept with the
+ * register and refilled on the next run instead of being freed. */
 static void
 mk_range(dfilter_t *df, int from_reg, int to_reg, drange_t *d_range)
 {
-	GList		*from_list, *to_list;
+	GPtrArray	*from_values, *to_values, *slices;
 	fvalue_t	*old_fv, *new_fv;
+	guint		i;
+
+	from_values = df->registers[from_reg];
+	to_values = df->registers[to_reg];
+	slices = df->slices[to_reg];
+	if (!slices) {
+		slices = g_ptr_array_new_with_free_func(free_fvalue_cb);
+		df->slices[to_reg] = slices;
+	}
 
-	to_list = NULL;
-	from_list = df->registers[from_reg];
-
-	while (from_list) {
-		old_fv = (fvalue_t*)from_list->data;
-		new_fv = fvalue_slice(old_fv, d_range);
-		/* Assert here because semcheck.c should have
-		 * already caught the cases in which a slice
-		 * cannot be made. */
-		g_assert(new_fv);
-		to_list = g_list_append(to_list, new_fv);
-
-		from_list = g_list_next(from_list);
+	for (i = 0; i < from_values->len; i++) {
+		old_fv = (fvalue_t *)g_ptr_array_index(from_values, i);
+		if (i < slices->len) {
+			new_fv = (fvalue_t *)g_ptr_array_index(slices, i);
+			fvalue_slice_into(old_fv, d_range, new_fv);
+		}
+		else {
+			new_fv = fvalue_slice(old_fv, d_range);
+			/* Assert here because semcheck.c should have
+			 * already caught the cases in which a slice
+			 * cannot be made. */
+			g_assert(new_fv);
+			g_ptr_array_add(slices, new_fv);
+		}
+		g_ptr_array_add(to_values, new_fv);
 	}
 
-	df->registers[to_reg] = to_list;
-	df->owns_memory[to_reg] = TRUE;
+	/* The slices belong to df->slices, not to the register. */
+	df->owns_memory[to_reg] = FALSE;
 }
 
 
@@ -469,8 +837,8 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 	dfvm_value_t	*arg3 = NULL;
 	dfvm_value_t	*arg4 = NULL;
 	header_field_info	*hfinfo;
-	GList		*param1;
-	GList		*param2;
+	GPtrArray	*param1;
+	GPtrArray	*param2;
 
 	g_assert(tree);
 
@@ -486,6 +854,12 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 		switch (insn->op) {
 			case CHECK_EXISTS:
 				hfinfo = arg1->value.hfinfo;
+				if (df->shared_loads &&
+				    g_hash_table_lookup_extended(df->shared_loads,
+						hfinfo, NULL, (gpointer *)&param1)) {
+					accum = (param1 != NULL);
+					break;
+				}
 				while(hfinfo) {
 					accum = proto_check_for_protocol_or_field(tree,
 							hfinfo->id);
@@ -515,7 +889,7 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 					param2 = df->registers[arg4->value.numeric];
 				}
 				accum = arg1->value.funcdef->function(param1, param2,
-						&df->registers[arg2->value.numeric]);
+						df->registers[arg2->value.numeric]);
 				// functions create a new value, so own it.
 				df->owns_memory[arg2->value.numeric] = TRUE;
 				break;
@@ -579,6 +953,11 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 						arg3->value.numeric);
 				break;
 
+			case ANY_IN_SET:
+				accum = any_in_set(df, arg1->value.numeric,
+						arg2->value.fvalue_set);
+				break;
+
 			case NOT:
 				accum = !accum;
 				break;
@@ -619,6 +998,21 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 	return FALSE; /* to appease the compiler */
 }
 
+gboolean
+dfvm_apply_with_loads(dfilter_t *df, proto_tree *tree, GHashTable *loads,
+		GPtrArray *spare_loads)
+{
+	gboolean	passed;
+
+	df->shared_loads = loads;
+	df->spare_loads = spare_loads;
+	passed = dfvm_apply(df, tree);
+	df->shared_loads = NULL;
+	df->spare_loads = NULL;
+
+	return passed;
+}
+
 void
 dfvm_init_const(dfilter_t *df)
 {
@@ -654,6 +1048,7 @@ dfvm_init_const(dfilter_t *df)
 			case ANY_CONTAINS:
 			case ANY_MATCHES:
 			case ANY_IN_RANGE:
+			case ANY_IN_SET:
 			case NOT:
 			case RETURN:
 			case IF_TRUE_GOTO:
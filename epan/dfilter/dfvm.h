@@ -23,9 +23,20 @@ typedef enum {
 	REGISTER,
 	INTEGER,
 	DRANGE,
-	FUNCTION_DEF
+	FUNCTION_DEF,
+	FVALUE_SET
 } dfvm_value_type_t;
 
+/* The constant elements of a membership test ("field in {...}"),
+ * indexed so that a field value can be looked up in constant time
+ * instead of being compared against every element in turn. */
+typedef struct {
+	int		key_class;	/* how fvalues are turned into keys */
+	GHashTable	*values;	/* set_key_t -> fvalue_t */
+	GArray		*ranges;	/* sorted, disjoint set_range_t */
+	GPtrArray	*fvalues;	/* all the elements, for dumping */
+} dfvm_fvalue_set_t;
+
 typedef struct {
 	dfvm_value_type_t	type;
 
@@ -35,6 +46,7 @@ typedef struct {
 		drange_t		*drange;
 		header_field_info	*hfinfo;
         df_func_def_t   *funcdef;
+		dfvm_fvalue_set_t	*fvalue_set;
 	} value;
 
 } dfvm_value_t;
@@ -60,7 +72,8 @@ typedef enum {
 	ANY_MATCHES,
 	MK_RANGE,
 	CALL_FUNCTION,
-	ANY_IN_RANGE
+	ANY_IN_RANGE,
+	ANY_IN_SET
 
 } dfvm_opcode_t;
 
@@ -82,12 +95,41 @@ dfvm_insn_free(dfvm_insn_t *insn);
 dfvm_value_t*
 dfvm_value_new(dfvm_value_type_t type);
 
+gboolean
+dfvm_fvalue_set_supported(header_field_info *hfinfo);
+
+dfvm_fvalue_set_t *
+dfvm_fvalue_set_new(header_field_info *hfinfo);
+
+gboolean
+dfvm_fvalue_set_add(dfvm_fvalue_set_t *set, fvalue_t *fv);
+
+gboolean
+dfvm_fvalue_set_add_range(dfvm_fvalue_set_t *set, fvalue_t *low, fvalue_t *high);
+
+void
+dfvm_fvalue_set_finish(dfvm_fvalue_set_t *set);
+
+guint
+dfvm_fvalue_set_size(const dfvm_fvalue_set_t *set);
+
+void
+dfvm_fvalue_set_free(dfvm_fvalue_set_t *set);
+
 void
 dfvm_dump(FILE *f, dfilter_t *df);
 
 gboolean
 dfvm_apply(dfilter_t *df, proto_tree *tree);
 
+/* Like dfvm_apply(), but fields are loaded through 'loads', a table of
+ * header_field_info -> GPtrArray of fvalues shared by every filter applied
+ * to the same tree. Arrays added to the table belong to the caller; they
+ * are taken from 'spare_loads', empty arrays, when there are any. */
+gboolean
+dfvm_apply_with_loads(dfilter_t *df, proto_tree *tree, GHashTable *loads,
+		GPtrArray *spare_loads);
+
 void
 dfvm_init_const(dfilter_t *df);
 
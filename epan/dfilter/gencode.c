@@ -288,7 +288,13 @@ fixup_jumps(gpointer data, gpointer user_data)
 }
 
 /* Generate the code for the in operator.  It behaves much like an OR-ed
- * series of == tests, but without the redundant existence checks. */
+ * series of == tests, but without the redundant existence checks.
+ *
+ * Constant elements (and constant integer ranges) are collected into a
+ * dfvm_fvalue_set_t and tested with a single ANY_IN_SET instruction, so a
+ * large set costs one hash lookup per field value instead of one
+ * comparison per element.  Whatever cannot be indexed that way, such as
+ * other fields or IPv4 subnets, is still tested element by element. */
 static void
 gen_relation_in(dfwork_t *dfw, stnode_t *st_arg1, stnode_t *st_arg2)
 {
@@ -299,11 +305,19 @@ gen_relation_in(dfwork_t *dfw, stnode_t *st_arg1, stnode_t *st_arg2)
 	stnode_t	*node1, *node2;
 	GSList		*nodelist_head, *nodelist;
 	GSList		*jumplist = NULL;
+	GSList		*remaining = NULL;
+	dfvm_fvalue_set_t *set = NULL;
 
 	/* Create code for the LHS of the relation */
 	reg1 = gen_entity(dfw, st_arg1, &jmp1);
 
-	/* Create code for the set on the RHS of the relation */
+	if (stnode_type_id(st_arg1) == STTYPE_FIELD &&
+	    dfvm_fvalue_set_supported((header_field_info *)stnode_data(st_arg1))) {
+		set = dfvm_fvalue_set_new((header_field_info *)stnode_data(st_arg1));
+	}
+
+	/* Move the constant elements of the set on the RHS into the
+	 * indexed set; keep the others, in order, for individual tests. */
 	nodelist_head = nodelist = (GSList*)stnode_steal_data(st_arg2);
 	while (nodelist) {
 		node1 = (stnode_t*)nodelist->data;
@@ -311,6 +325,62 @@ gen_relation_in(dfwork_t *dfw, stnode_t *st_arg1, stnode_t *st_arg2)
 		node2 = (stnode_t*)nodelist->data;
 		nodelist = g_slist_next(nodelist);
 
+		if (set && stnode_type_id(node1) == STTYPE_FVALUE) {
+			if (!node2) {
+				if (dfvm_fvalue_set_add(set, (fvalue_t *)stnode_data(node1))) {
+					stnode_steal_data(node1);
+					continue;
+				}
+			} else if (stnode_type_id(node2) == STTYPE_FVALUE) {
+				if (dfvm_fvalue_set_add_range(set,
+						(fvalue_t *)stnode_data(node1),
+						(fvalue_t *)stnode_data(node2))) {
+					stnode_steal_data(node1);
+					stnode_steal_data(node2);
+					continue;
+				}
+			}
+		}
+		remaining = g_slist_prepend(remaining, node1);
+		remaining = g_slist_prepend(remaining, node2);
+	}
+	remaining = g_slist_reverse(remaining);
+
+	/* A set left empty by inverted ranges still needs its test when
+	 * nothing else follows, or the accumulator would stay TRUE. */
+	if (set && (dfvm_fvalue_set_size(set) > 0 || !remaining)) {
+		dfvm_fvalue_set_finish(set);
+
+		insn = dfvm_insn_new(ANY_IN_SET);
+		val1 = dfvm_value_new(REGISTER);
+		val1->value.numeric = reg1;
+		val2 = dfvm_value_new(FVALUE_SET);
+		val2->value.fvalue_set = set;
+		insn->arg1 = val1;
+		insn->arg2 = val2;
+		dfw_append_insn(dfw, insn);
+
+		/* Exit as soon as we find a match */
+		if (remaining) {
+			insn = dfvm_insn_new(IF_TRUE_GOTO);
+			val1 = dfvm_value_new(INSN_NUMBER);
+			insn->arg1 = val1;
+			dfw_append_insn(dfw, insn);
+			jumplist = g_slist_prepend(jumplist, val1);
+		}
+	}
+	else if (set) {
+		dfvm_fvalue_set_free(set);
+	}
+
+	/* Create code for the rest of the set */
+	nodelist = remaining;
+	while (nodelist) {
+		node1 = (stnode_t*)nodelist->data;
+		nodelist = g_slist_next(nodelist);
+		node2 = (stnode_t*)nodelist->data;
+		nodelist = g_slist_next(nodelist);
+
 		if (node2) {
 			int	reg2, reg3;
 
@@ -369,6 +439,7 @@ gen_relation_in(dfwork_t *dfw, stnode_t *st_arg1, stnode_t *st_arg2)
 
 	/* Clean up */
 	g_slist_free(jumplist);
+	g_slist_free(remaining);
 	set_nodelist_free(nodelist_head);
 }
 
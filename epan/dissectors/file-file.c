@@ -275,13 +275,12 @@ dissect_file_record(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
 	/* Attempt to (re-)calculate color filters (if any). */
 	if (pinfo->fd->need_colorize) {
 		color_filter = color_filters_colorize_packet(file_data->color_edt);
-		pinfo->fd->color_filter = color_filter;
+		color_filters_set_frame_filter(pinfo->fd, color_filter);
 		pinfo->fd->need_colorize = 0;
 	} else {
-		color_filter = pinfo->fd->color_filter;
+		color_filter = color_filters_get_frame_filter(pinfo->fd);
 	}
 	if (color_filter) {
-		pinfo->fd->color_filter = color_filter;
 		item = proto_tree_add_string(fh_tree, hf_file_color_filter_name, tvb,
 					     0, 0, color_filter->filter_name);
 		proto_item_set_generated(item);
@@ -4633,20 +4633,38 @@ static void dns_stats_tree_init(stats_tree* st)
   st_node_service_rrt = stats_tree_create_node(st, st_str_service_rrt, st_node_service_stats, STAT_DT_FLOAT, FALSE);
 }
 
+typedef struct {
+  const value_string *vals;
+  const char *unknown_fmt;
+} dns_stats_vals_t;
+
+static const dns_stats_vals_t dns_stats_qr = { dns_qr_vals, "Unknown qr (%d)" };
+static const dns_stats_vals_t dns_stats_qtypes = { dns_types_description_vals, "Unknown packet type (%d)" };
+static const dns_stats_vals_t dns_stats_qclasses = { dns_classes, "Unknown class (%d)" };
+static const dns_stats_vals_t dns_stats_rcodes = { rcode_vals, "Unknown rcode (%d)" };
+static const dns_stats_vals_t dns_stats_opcodes = { opcode_vals, "Unknown opcode (%d)" };
+
+static gchar *dns_stats_val_name(guint32 key, const void *data)
+{
+  const dns_stats_vals_t *vals = (const dns_stats_vals_t *)data;
+
+  return val_to_str_wmem(NULL, key, vals->vals, vals->unknown_fmt);
+}
+
 static tap_packet_status dns_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p)
 {
   const struct DnsTap *pi = (const struct DnsTap *)p;
   tick_stat_node(st, st_str_packets, 0, FALSE);
-  stats_tree_tick_pivot(st, st_node_packet_qr,
-          val_to_str(pi->packet_qr, dns_qr_vals, "Unknown qr (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_qtypes,
-          val_to_str(pi->packet_qtype, dns_types_description_vals, "Unknown packet type (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_qclasses,
-          val_to_str(pi->packet_qclass, dns_classes, "Unknown class (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_rcodes,
-          val_to_str(pi->packet_rcode, rcode_vals, "Unknown rcode (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_opcodes,
-          val_to_str(pi->packet_opcode, opcode_vals, "Unknown opcode (%d)"));
+  stats_tree_tick_pivot_by_key(st, st_node_packet_qr, pi->packet_qr,
+          dns_stats_val_name, &dns_stats_qr);
+  stats_tree_tick_pivot_by_key(st, st_node_packet_qtypes, pi->packet_qtype,
+          dns_stats_val_name, &dns_stats_qtypes);
+  stats_tree_tick_pivot_by_key(st, st_node_packet_qclasses, pi->packet_qclass,
+          dns_stats_val_name, &dns_stats_qclasses);
+  stats_tree_tick_pivot_by_key(st, st_node_packet_rcodes, pi->packet_rcode,
+          dns_stats_val_name, &dns_stats_rcodes);
+  stats_tree_tick_pivot_by_key(st, st_node_packet_opcodes, pi->packet_opcode,
+          dns_stats_val_name, &dns_stats_opcodes);
   avg_stat_node_add_value_int(st, st_str_packets_avg_size, 0, FALSE,
           pi->payload_size);
 
@@ -285,6 +285,8 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 	frame_data_t *fr_data = (frame_data_t*)data;
 	const color_filter_t *color_filter;
 	dissector_handle_t dissector_handle;
+	const nstime_t *shift_offset;
+	static const nstime_t zero_offset = NSTIME_INIT_ZERO;
 
 	tree=parent_tree;
 
@@ -635,8 +637,11 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 								  " the valid range is 0-1000000000",
 								  (long) pinfo->abs_ts.nsecs);
 			}
+			shift_offset = epan_get_shift_offset(pinfo->epan, pinfo->fd);
+			if (shift_offset == NULL)
+				shift_offset = &zero_offset;
 			item = proto_tree_add_time(fh_tree, hf_frame_shift_offset, tvb,
-					    0, 0, &(pinfo->fd->shift_offset));
+					    0, 0, shift_offset);
 			proto_item_set_generated(item);
 
 			if (generate_epoch_time) {
@@ -935,10 +940,10 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 	/* Attempt to (re-)calculate color filters (if any). */
 	if (pinfo->fd->need_colorize) {
 		color_filter = color_filters_colorize_packet(fr_data->color_edt);
-		pinfo->fd->color_filter = color_filter;
+		color_filters_set_frame_filter(pinfo->fd, color_filter);
 		pinfo->fd->need_colorize = 0;
 	} else {
-		color_filter = pinfo->fd->color_filter;
+		color_filter = color_filters_get_frame_filter(pinfo->fd);
 	}
 	if (color_filter) {
 		ensure_tree_item(fh_tree, 1);
@@ -592,6 +592,13 @@ http_stats_tree_init(stats_tree* st)
 	st_node_other = stats_tree_create_node(st, st_str_other, st_node_packets, STAT_DT_INT, FALSE);
 }
 
+static gchar *
+http_stats_tree_response_code_name(guint32 key, const void *data _U_)
+{
+	return g_strdup_printf("%u %s", key,
+			       val_to_str(key, vals_http_status_code, "Unknown (%d)"));
+}
+
 /* HTTP/Packet Counter stats packet function */
 static tap_packet_status
 http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p)
@@ -600,7 +607,6 @@ http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* e
 	guint i = v->response_code;
 	int resp_grp;
 	const gchar *resp_str;
-	gchar str[64];
 
 	tick_stat_node(st, st_str_packets, 0, FALSE);
 
@@ -629,9 +635,7 @@ http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* e
 
 		tick_stat_node(st, resp_str, st_node_responses, FALSE);
 
-		g_snprintf(str, sizeof(str), "%u %s", i,
-			   val_to_str(i, vals_http_status_code, "Unknown (%d)"));
-		tick_stat_node(st, str, resp_grp, FALSE);
+		tick_stat_node_by_key(st, i, http_stats_tree_response_code_name, NULL, resp_grp, FALSE);
 	} else if (v->request_method) {
 		stats_tree_tick_pivot(st,st_node_requests,v->request_method);
 	} else {
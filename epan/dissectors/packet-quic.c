@@ -326,7 +326,7 @@ struct quic_cid_item {
  */
 typedef struct _quic_stream_state {
     guint64         stream_id;
-    wmem_tree_t    *multisegment_pdus;
+    wmem_btree_t   *multisegment_pdus;
     void           *subdissector_private;
 } quic_stream_state;
 
@@ -1198,7 +1198,7 @@ quic_get_stream_state(packet_info *pinfo, quic_info_data_t *quic_info, gboolean
     if (!stream) {
         stream = wmem_new0(wmem_file_scope(), quic_stream_state);
         stream->stream_id = stream_id;
-        stream->multisegment_pdus = wmem_tree_new(wmem_file_scope());
+        stream->multisegment_pdus = wmem_btree_new(wmem_file_scope());
         wmem_map_insert(streams, &stream->stream_id, stream);
     }
     return stream;
@@ -1267,7 +1267,7 @@ again:
     /* Have we seen this PDU before (and is it the start of a multi-
      * segment PDU)?
      */
-    if ((msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32(stream->multisegment_pdus, seq)) &&
+    if ((msp = (struct tcp_multisegment_pdu *)wmem_btree_lookup32(stream->multisegment_pdus, seq)) &&
             nxtseq <= msp->nxtpdu) {
         // TODO show expert info for retransmission? Additional checks may be
         // necessary here to tell a retransmission apart from other (normal?)
@@ -1280,7 +1280,7 @@ again:
     }
     /* Else, find the most previous PDU starting before this sequence number */
     if (!msp && seq > 0) {
-        msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(stream->multisegment_pdus, seq-1);
+        msp = (struct tcp_multisegment_pdu *)wmem_btree_lookup32_le(stream->multisegment_pdus, seq-1);
         /* Unless if we already fully reassembled the msp that covers seq-1
          * and seq is beyond the end of that msp. In that case this segment
          * will be the start of a new msp.
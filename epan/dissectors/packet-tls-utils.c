@@ -3589,7 +3589,7 @@ ssl_create_flow(void)
   flow = wmem_new(wmem_file_scope(), SslFlow);
   flow->byte_seq = 0;
   flow->flags = 0;
-  flow->multisegment_pdus = wmem_tree_new(wmem_file_scope());
+  flow->multisegment_pdus = wmem_btree_new(wmem_file_scope());
   return flow;
 }
 /* }}} */
@@ -1236,7 +1236,7 @@ again:
      * dissection of the desegmented pdu if we'd already seen the end of
      * the pdu).
      */
-    if ((msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32(flow->multisegment_pdus, seq))) {
+    if ((msp = (struct tcp_multisegment_pdu *)wmem_btree_lookup32(flow->multisegment_pdus, seq))) {
         const char *prefix;
 
         if (msp->first_frame == pinfo->num) {
@@ -1252,7 +1252,7 @@ again:
     }
 
     /* Else, find the most previous PDU starting before this sequence number */
-    msp = (struct tcp_multisegment_pdu *)wmem_tree_lookup32_le(flow->multisegment_pdus, seq-1);
+    msp = (struct tcp_multisegment_pdu *)wmem_btree_lookup32_le(flow->multisegment_pdus, seq-1);
     if (msp && msp->seq <= seq && msp->nxtpdu > seq) {
         int len;
 
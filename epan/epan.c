@@ -441,6 +441,15 @@ epan_get_user_comment(const epan_t *session, const frame_data *fd)
 	return NULL;
 }
 
+const nstime_t *
+epan_get_shift_offset(const epan_t *session, const frame_data *fd)
+{
+	if (session->funcs.get_shift_offset)
+		return session->funcs.get_shift_offset(session->prov, fd);
+
+	return NULL;
+}
+
 const char *
 epan_get_interface_name(const epan_t *session, guint32 interface_id)
 {
@@ -831,6 +840,14 @@ epan_get_compiled_version_info(GString *str)
 	g_string_append(str, "without Zstandard");
 #endif /* HAVE_ZSTD */
 
+	/* PCRE2 */
+	g_string_append(str, ", ");
+#ifdef HAVE_PCRE2
+	g_string_append(str, "with PCRE2");
+#else
+	g_string_append(str, "without PCRE2");
+#endif /* HAVE_PCRE2 */
+
 	/* Snappy */
 	g_string_append(str, ", ");
 #ifdef HAVE_SNAPPY
@@ -51,6 +51,7 @@ struct packet_provider_funcs {
 	const char *(*get_interface_name)(struct packet_provider_data *prov, guint32 interface_id);
 	const char *(*get_interface_description)(struct packet_provider_data *prov, guint32 interface_id);
 	const char *(*get_user_comment)(struct packet_provider_data *prov, const frame_data *fd);
+	const nstime_t *(*get_shift_offset)(struct packet_provider_data *prov, const frame_data *fd);
 };
 
 /**
@@ -156,6 +157,8 @@ WS_DLL_PUBLIC epan_t *epan_new(struct packet_provider_data *prov,
 
 WS_DLL_PUBLIC const char *epan_get_user_comment(const epan_t *session, const frame_data *fd);
 
+WS_DLL_PUBLIC const nstime_t *epan_get_shift_offset(const epan_t *session, const frame_data *fd);
+
 WS_DLL_PUBLIC const char *epan_get_interface_name(const epan_t *session, guint32 interface_id);
 
 WS_DLL_PUBLIC const char *epan_get_interface_description(const epan_t *session, guint32 interface_id);
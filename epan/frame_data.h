@@ -56,10 +56,15 @@ typedef enum {
    Try to keep it close to, and less than or equal to, a power of 2.
    "Smaller than a power of 2" is OK for ILP32 platforms.
 
+   Rarely-used per-frame information is kept out of this structure:
+   time shift offsets are kept by the packet provider (see
+   epan_get_shift_offset()), and the matching color filter is
+   stored as a 32-bit index (see color_filters_get_frame_filter()),
+   which keeps the structure at 64 bytes on LP64 platforms.
+
    XXX - shuffle the fields to try to keep the most commonly-accessed
    fields within the first 16 or 32 bytes, so they all fit in a cache
    line? */
-struct _color_filter; /* Forward */
 DIAG_OFF_PEDANTIC
 typedef struct _frame_data {
   guint32      num;          /**< Frame number */
@@ -67,11 +72,8 @@ typedef struct _frame_data {
   guint32      cap_len;      /**< Amount actually captured */
   guint32      cum_bytes;    /**< Cumulative bytes into the capture */
   gint64       file_off;     /**< File offset */
-  /* These two are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
-     LLP64 (64-bit Windows) platforms.  Put them here, one after the
-     other, so they don't require padding between them. */
   GSList      *pfd;          /**< Per frame proto data */
-  const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
+  guint32      color_filter_index; /**< Index of the matching color_filter_t object, 0 if none */
   guint16      subnum;       /**< subframe number, for protocols that require this */
   /* Keep the bitfields below to 16 bits, so this plus the previous field
      are 32 bits. */
@@ -87,9 +89,9 @@ typedef struct _frame_data {
   unsigned int has_phdr_comment : 1; /** 1 = there's comment for this packet */
   unsigned int has_user_comment : 1; /** 1 = user set (also deleted) comment for this packet */
   unsigned int need_colorize    : 1; /**< 1 = need to (re-)calculate packet color */
+  unsigned int has_shift_offset : 1; /**< 1 = abs_ts has been shifted, see epan_get_shift_offset() */
   unsigned int tsprec           : 4; /**< Time stamp precision -2^tsprec gives up to femtoseconds */
   nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
   guint32      frame_ref_num; /**< Previous reference frame (0 if this is one) */
   guint32      prev_dis_num; /**< Previous displayed frame (0 if first one) */
 } frame_data;
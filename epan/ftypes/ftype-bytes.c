@@ -653,7 +653,7 @@ static gboolean
 cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 {
 	GByteArray *a = fv_a->value.bytes;
-	GRegex *regex = fv_b->value.re;
+	ws_regex_t *regex = fv_b->value.re;
 
 	/* fv_b is always a FT_PCRE, otherwise the dfilter semcheck() would have
 	 * warned us. For the same reason (and because we're using g_malloc()),
@@ -665,16 +665,7 @@ cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 	if (! regex) {
 		return FALSE;
 	}
-	return g_regex_match_full(
-		regex,			/* Compiled PCRE */
-		(char *)a->data,	/* The data to check for the pattern... */
-		(int)a->len,		/* ... and its length */
-		0,			/* Start offset within data */
-		(GRegexMatchFlags)0,	/* GRegexMatchFlags */
-		NULL,			/* We are not interested in the match information */
-		NULL			/* We don't want error information */
-		);
-	/* NOTE - DO NOT g_free(data) */
+	return ws_regex_matches_length(regex, (const char *)a->data, a->len);
 }
 
 void
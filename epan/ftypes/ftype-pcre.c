@@ -28,7 +28,7 @@ static void
 gregex_fvalue_free(fvalue_t *fv)
 {
     if (fv->value.re) {
-        g_regex_unref(fv->value.re);
+        ws_regex_free(fv->value.re);
         fv->value.re = NULL;
     }
 }
@@ -39,41 +39,17 @@ gregex_fvalue_free(fvalue_t *fv)
 static gboolean
 val_from_string(fvalue_t *fv, const char *pattern, gchar **err_msg)
 {
-    GError *regex_error = NULL;
-    GRegexCompileFlags cflags = (GRegexCompileFlags)(G_REGEX_CASELESS | G_REGEX_OPTIMIZE);
+    /* Free up the old value, if we have one */
+    gregex_fvalue_free(fv);
 
     /*
      * As FT_BYTES and FT_PROTOCOL contain arbitrary binary data and FT_STRING
-     * is not guaranteed to contain valid UTF-8, we have to disable support for
-     * UTF-8 patterns and treat every pattern and subject as raw bytes.
-     *
-     * Should support for UTF-8 patterns be necessary, then we should compile a
-     * pattern without G_REGEX_RAW. Additionally, we MUST use g_utf8_validate()
-     * before calling g_regex_match_full() or risk crashes.
+     * is not guaranteed to contain valid UTF-8, patterns and subjects are
+     * treated as raw bytes.
      */
-    cflags = (GRegexCompileFlags)(cflags | G_REGEX_RAW);
-
-    /* Free up the old value, if we have one */
-    gregex_fvalue_free(fv);
+    fv->value.re = ws_regex_compile(pattern, WS_REGEX_CASELESS, err_msg);
 
-    fv->value.re = g_regex_new(
-            pattern,            /* pattern */
-            cflags,             /* Compile options */
-            (GRegexMatchFlags)0,                  /* Match options */
-            &regex_error        /* Compile / study errors */
-            );
-
-    if (regex_error) {
-        if (err_msg) {
-            *err_msg = g_strdup(regex_error->message);
-        }
-        g_error_free(regex_error);
-        if (fv->value.re) {
-            g_regex_unref(fv->value.re);
-        }
-        return FALSE;
-    }
-    return TRUE;
+    return fv->value.re != NULL;
 }
 
 /* Generate a FT_PCRE from an unparsed string pattern.
@@ -91,14 +67,14 @@ static int
 gregex_repr_len(fvalue_t *fv, ftrepr_t rtype, int field_display _U_)
 {
     g_assert(rtype == FTREPR_DFILTER);
-    return (int)strlen(g_regex_get_pattern(fv->value.re));
+    return (int)strlen(ws_regex_pattern(fv->value.re));
 }
 
 static void
 gregex_to_repr(fvalue_t *fv, ftrepr_t rtype, int field_display _U_, char *buf, unsigned int size)
 {
     g_assert(rtype == FTREPR_DFILTER);
-    g_strlcpy(buf, g_regex_get_pattern(fv->value.re), size);
+    g_strlcpy(buf, ws_regex_pattern(fv->value.re), size);
 }
 
 /* BEHOLD - value contains the string representation of the regular expression,
@@ -124,7 +100,7 @@ ftype_register_pcre(void)
     static ftype_t pcre_type = {
         FT_PCRE,            /* ftype */
         "FT_PCRE",          /* name */
-        "Compiled Perl-Compatible Regular Expression (GRegex) object", /* pretty_name */
+        "Compiled Perl-Compatible Regular Expression object", /* pretty_name */
         0,                  /* wire_size */
         gregex_fvalue_new,  /* new_value */
         gregex_fvalue_free, /* free_value */
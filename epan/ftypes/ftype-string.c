@@ -189,7 +189,7 @@ static gboolean
 cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 {
 	char *str = fv_a->value.string;
-	GRegex *regex = fv_b->value.re;
+	ws_regex_t *regex = fv_b->value.re;
 
 	/* fv_b is always a FT_PCRE, otherwise the dfilter semcheck() would have
 	 * warned us. For the same reason (and because we're using g_malloc()),
@@ -201,15 +201,7 @@ cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 	if (! regex) {
 		return FALSE;
 	}
-	return g_regex_match_full(
-			regex,		/* Compiled PCRE */
-			str,		/* The data to check for the pattern... */
-			(int)strlen(str),	/* ... and its length */
-			0,		/* Start offset within data */
-			(GRegexMatchFlags)0,		/* GRegexMatchFlags */
-			NULL,		/* We are not interested in the match information */
-			NULL		/* We don't want error information */
-			);
+	return ws_regex_matches(regex, str);
 }
 
 void
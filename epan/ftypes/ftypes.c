@@ -483,6 +483,23 @@ fvalue_slice(fvalue_t *fv, drange_t *d_range)
 	return new_fv;
 }
 
+/* Like fvalue_slice(), but puts the slice into new_fv, an FT_BYTES fvalue_t
+ * returned by an earlier call, reusing its byte array. */
+void
+fvalue_slice_into(fvalue_t *fv, drange_t *d_range, fvalue_t *new_fv)
+{
+	slice_data_t	slice_data;
+
+	g_assert(new_fv->ftype->ftype == FT_BYTES);
+
+	slice_data.fv = fv;
+	slice_data.bytes = new_fv->value.bytes;
+	slice_data.slice_failure = FALSE;
+	g_byte_array_set_size(slice_data.bytes, 0);
+
+	drange_foreach_drange_node(d_range, slice_func, &slice_data);
+}
+
 
 void
 fvalue_set_byte_array(fvalue_t *fv, GByteArray *value)
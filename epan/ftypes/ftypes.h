@@ -214,6 +214,7 @@ ftype_can_matches(enum ftenum ftype);
 
 #include <epan/tvbuff.h>
 #include <wsutil/nstime.h>
+#include <wsutil/ws_regex.h>
 #include <epan/dfilter/drange.h>
 
 typedef struct _protocol_value_t
@@ -240,7 +241,7 @@ typedef struct _fvalue_t {
 		e_guid_t		guid;
 		nstime_t		time;
 		protocol_value_t 	protocol;
-		GRegex			*re;
+		ws_regex_t		*re;
 		guint16			sfloat_ieee_11073;
 		guint32			float_ieee_11073;
 	} value;
@@ -378,6 +379,9 @@ fvalue_length(fvalue_t *fv);
 fvalue_t*
 fvalue_slice(fvalue_t *fv, drange_t *dr);
 
+void
+fvalue_slice_into(fvalue_t *fv, drange_t *dr, fvalue_t *new_fv);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
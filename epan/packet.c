@@ -28,6 +28,7 @@
 #include "addr_resolv.h"
 #include "tvbuff.h"
 #include "epan_dissect.h"
+#include "conversation.h"
 
 #include "wmem/wmem.h"
 
@@ -164,6 +165,27 @@ static GHashTable *heur_dissector_lists = NULL;
 /* Name hashtables for fast detection of duplicate names */
 static GHashTable* heuristic_short_names  = NULL;
 
+/*
+ * What the first pass learned about the heuristic dissectors of one list
+ * on one conversation.
+ */
+typedef struct {
+	const conversation_t  *conv;
+	heur_dissector_list_t  list;
+} heur_conv_key_t;
+
+typedef struct {
+	heur_dtbl_entry_t *winner;      /* last one to accept a packet; tried first */
+	guint32            first_tried; /* first frame in which they were tried */
+	guint32            first_match; /* first frame in which one accepted a packet */
+	guint32            last_tried;  /* last frame in which they were tried */
+} heur_conv_cache_t;
+
+static wmem_map_t *heur_conv_caches = NULL;
+
+/* Add up the time spent in heuristic dissectors? */
+static gboolean heur_timing = FALSE;
+
 static void
 destroy_heuristic_dissector_entry(gpointer data)
 {
@@ -193,6 +215,23 @@ destroy_dissector_table(void *data)
 	g_slice_free(struct dissector_table, data);
 }
 
+static guint
+heur_conv_key_hash(gconstpointer k)
+{
+	const heur_conv_key_t *key = (const heur_conv_key_t *)k;
+
+	return g_direct_hash(key->conv) ^ (g_direct_hash(key->list) * 31);
+}
+
+static gboolean
+heur_conv_key_equal(gconstpointer a, gconstpointer b)
+{
+	const heur_conv_key_t *key_a = (const heur_conv_key_t *)a;
+	const heur_conv_key_t *key_b = (const heur_conv_key_t *)b;
+
+	return key_a->conv == key_b->conv && key_a->list == key_b->list;
+}
+
 void
 packet_init(void)
 {
@@ -212,6 +251,9 @@ packet_init(void)
 			NULL, destroy_heuristic_dissector_list);
 
 	heuristic_short_names  = g_hash_table_new(g_str_hash, g_str_equal);
+
+	heur_conv_caches = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
+			heur_conv_key_hash, heur_conv_key_equal);
 }
 
 void
@@ -334,12 +376,33 @@ init_dissection(void)
 	expert_packet_init();
 }
 
+static void
+reset_heur_dissector_counters(gpointer data, gpointer user_data _U_)
+{
+	heur_dtbl_entry_t *hdtbl_entry = (heur_dtbl_entry_t *)data;
+
+	hdtbl_entry->hits    = 0;
+	hdtbl_entry->misses  = 0;
+	hdtbl_entry->time_us = 0;
+}
+
+static void
+reset_heur_list_counters(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+	heur_dissector_list_t sub_dissectors = (heur_dissector_list_t)value;
+
+	g_slist_foreach(sub_dissectors->dissectors, reset_heur_dissector_counters, NULL);
+}
+
 void
 cleanup_dissection(void)
 {
 	/* Cleanup protocol-specific variables. */
 	g_slist_foreach(cleanup_routines, &call_routine, NULL);
 
+	/* Start counting the heuristic dissector hits afresh for the next file */
+	g_hash_table_foreach(heur_dissector_lists, reset_heur_list_counters, NULL);
+
 	/* Cleanup the stream-handling tables */
 	stream_cleanup();
 
@@ -2701,6 +2764,9 @@ heur_dissector_add(const char *name, heur_dissector_t dissector, const char *dis
 	hdtbl_entry->short_name = g_strdup(internal_name);
 	hdtbl_entry->list_name = g_strdup(name);
 	hdtbl_entry->enabled   = (enable == HEURISTIC_ENABLE);
+	hdtbl_entry->hits      = 0;
+	hdtbl_entry->misses    = 0;
+	hdtbl_entry->time_us   = 0;
 
 	/* do the table insertion */
 	g_hash_table_insert(heuristic_short_names, (gpointer)hdtbl_entry->short_name, hdtbl_entry);
@@ -2729,6 +2795,15 @@ find_matching_heur_dissector(gconstpointer a, gconstpointer b) {
 		(hdtbl_entry_a->protocol == hdtbl_entry_b->protocol) ? 0 : 1;
 }
 
+static void
+forget_heur_winner(gpointer key _U_, gpointer value, gpointer user_data)
+{
+	heur_conv_cache_t *conv_cache = (heur_conv_cache_t *)value;
+
+	if (conv_cache->winner == user_data)
+		conv_cache->winner = NULL;
+}
+
 void
 heur_dissector_delete(const char *name, heur_dissector_t dissector, const int proto) {
 	heur_dissector_list_t  sub_dissectors = find_heur_dissector_list(name);
@@ -2746,6 +2821,7 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 
 	if (found_entry) {
 		heur_dtbl_entry_t *found_hdtbl_entry = (heur_dtbl_entry_t *)(found_entry->data);
+		wmem_map_foreach(heur_conv_caches, forget_heur_winner, found_hdtbl_entry);
 		g_free(found_hdtbl_entry->list_name);
 		g_hash_table_remove(heuristic_short_names, found_hdtbl_entry->short_name);
 		g_free(found_hdtbl_entry->short_name);
@@ -2755,6 +2831,103 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 	}
 }
 
+void
+heur_dissector_set_timing(gboolean enable)
+{
+	heur_timing = enable;
+}
+
+static gboolean
+heur_dissector_is_enabled(const heur_dtbl_entry_t *hdtbl_entry)
+{
+	return hdtbl_entry->protocol == NULL ||
+		(hdtbl_entry->enabled && proto_is_protocol_enabled(hdtbl_entry->protocol));
+}
+
+/*
+ * Call one heuristic dissector, taking its protocol off the layers again
+ * if it doesn't take the packet.  Returns what the dissector returned.
+ */
+static int
+call_heur_dissector_entry(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+			  packet_info *pinfo, proto_tree *tree, void *data,
+			  guint saved_layers_len, guint saved_tree_count)
+{
+	int    proto_id;
+	int    len;
+	gint64 start_time = 0;
+
+	if (hdtbl_entry->protocol != NULL) {
+		proto_id = proto_get_id(hdtbl_entry->protocol);
+		/* do NOT change this behavior - wslua uses the protocol short name set here in order
+		   to determine which Lua-based heurisitc dissector to call */
+		pinfo->current_proto =
+			proto_get_protocol_short_name(hdtbl_entry->protocol);
+
+		/*
+		 * Add the protocol name to the layers; we'll remove it
+		 * if the dissector fails.
+		 */
+		pinfo->curr_layer_num++;
+		wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
+	}
+
+	pinfo->heur_list_name = hdtbl_entry->list_name;
+
+	if (heur_timing)
+		start_time = g_get_monotonic_time();
+	len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+	if (heur_timing)
+		hdtbl_entry->time_us += g_get_monotonic_time() - start_time;
+
+	if (hdtbl_entry->protocol != NULL &&
+		(len == 0 || (tree && saved_tree_count == tree->tree_data->count))) {
+		/*
+		 * We added a protocol layer above. The dissector
+		 * didn't accept the packet or it didn't add any
+		 * items to the tree so remove it from the list.
+		 */
+		while (wmem_list_count(pinfo->layers) > saved_layers_len) {
+			if (len == 0) {
+				/*
+				 * Only reduce the layer number if the dissector
+				 * rejected the data. Since tree can be NULL on
+				 * the first pass, we cannot check it or it will
+				 * break dissectors that rely on a stable value.
+				 */
+				pinfo->curr_layer_num--;
+			}
+			wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
+		}
+	}
+
+	if (len)
+		hdtbl_entry->hits++;
+	else
+		hdtbl_entry->misses++;
+	return len;
+}
+
+/*
+ * Keep the list ordered by the number of hits, so that the dissectors
+ * that take the most packets are tried first: move the entry that just
+ * took a packet ahead of those with fewer hits.
+ */
+static void
+heur_dissector_promote(heur_dissector_list_t sub_dissectors, GSList *entry)
+{
+	heur_dtbl_entry_t *hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
+	GSList            *pos;
+
+	for (pos = sub_dissectors->dissectors; pos != entry; pos = g_slist_next(pos)) {
+		if (((heur_dtbl_entry_t *)pos->data)->hits < hdtbl_entry->hits) {
+			sub_dissectors->dissectors = g_slist_delete_link(sub_dissectors->dissectors, entry);
+			sub_dissectors->dissectors = g_slist_insert_before(sub_dissectors->dissectors, pos, hdtbl_entry);
+			return;
+		}
+	}
+}
+
 gboolean
 dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **heur_dtbl_entry, void *data)
@@ -2763,12 +2936,13 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	const char        *saved_curr_proto;
 	const char        *saved_heur_list_name;
 	GSList            *entry;
-	GSList            *prev_entry = NULL;
 	guint16            saved_can_desegment;
 	guint              saved_layers_len = 0;
 	heur_dtbl_entry_t *hdtbl_entry;
-	int                proto_id;
-	int                len;
+	heur_dtbl_entry_t *winner = NULL;
+	conversation_t    *conv;
+	heur_conv_key_t    conv_key;
+	heur_conv_cache_t *conv_cache = NULL;
 	guint              saved_tree_count = tree ? tree->tree_data->count : 0;
 
 	/* can_desegment is set to 2 by anyone which offers this api/service.
@@ -2793,72 +2967,90 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 
 	DISSECTOR_ASSERT(saved_layers_len < PINFO_LAYER_MAX_RECURSION_DEPTH);
 
-	for (entry = sub_dissectors->dissectors; entry != NULL;
+	/*
+	 * Packets of a conversation are usually all taken by the same
+	 * heuristic dissector, or by none of them; remember which.
+	 */
+	conv = find_conversation_pinfo_ro(pinfo, 0);
+	conv_key.conv = conv;
+	conv_key.list = sub_dissectors;
+	if (conv != NULL) {
+		conv_cache = (heur_conv_cache_t *)wmem_map_lookup(heur_conv_caches, &conv_key);
+	}
+
+	if (conv_cache != NULL && pinfo->fd->visited &&
+	    pinfo->num > conv_cache->first_tried && pinfo->num <= conv_cache->last_tried &&
+	    pinfo->num < conv_cache->first_match) {
+		/*
+		 * None of them took any packet of this conversation up to and
+		 * including this one on the first pass, so they won't take
+		 * this one now.  Frames up to the one in which the cache was
+		 * made are always tried: the conversation may not have existed
+		 * yet when they were first dissected (the dissector that took
+		 * them may well have created it), so they weren't tried
+		 * against it.
+		 */
+		goto done;
+	}
+
+	if (conv_cache != NULL && conv_cache->winner != NULL &&
+	    heur_dissector_is_enabled(conv_cache->winner)) {
+		pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
+		if (call_heur_dissector_entry(conv_cache->winner, tvb, pinfo, tree, data,
+					      saved_layers_len, saved_tree_count)) {
+			winner = conv_cache->winner;
+			heur_dissector_promote(sub_dissectors,
+			    g_slist_find(sub_dissectors->dissectors, winner));
+		}
+	}
+
+	for (entry = sub_dissectors->dissectors; winner == NULL && entry != NULL;
 	    entry = g_slist_next(entry)) {
 		/* XXX - why set this now and above? */
 		pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
 		hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
 
-		if (hdtbl_entry->protocol != NULL &&
-			(!proto_is_protocol_enabled(hdtbl_entry->protocol)||(hdtbl_entry->enabled==FALSE))) {
+		if (!heur_dissector_is_enabled(hdtbl_entry) ||
+		    (conv_cache != NULL && hdtbl_entry == conv_cache->winner)) {
 			/*
-			 * No - don't try this dissector.
+			 * No - don't try this dissector (again).
 			 */
 			continue;
 		}
 
-		if (hdtbl_entry->protocol != NULL) {
-			proto_id = proto_get_id(hdtbl_entry->protocol);
-			/* do NOT change this behavior - wslua uses the protocol short name set here in order
-			   to determine which Lua-based heurisitc dissector to call */
-			pinfo->current_proto =
-				proto_get_protocol_short_name(hdtbl_entry->protocol);
-
-			/*
-			 * Add the protocol name to the layers; we'll remove it
-			 * if the dissector fails.
-			 */
-			pinfo->curr_layer_num++;
-			wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
+		if (call_heur_dissector_entry(hdtbl_entry, tvb, pinfo, tree, data,
+					      saved_layers_len, saved_tree_count)) {
+			winner = hdtbl_entry;
+			heur_dissector_promote(sub_dissectors, entry);
+			break;
 		}
+	}
 
-		pinfo->heur_list_name = hdtbl_entry->list_name;
+	if (winner != NULL) {
+		*heur_dtbl_entry = winner;
+		status = TRUE;
+	}
 
-		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
-		if (hdtbl_entry->protocol != NULL &&
-			(len == 0 || (tree && saved_tree_count == tree->tree_data->count))) {
-			/*
-			 * We added a protocol layer above. The dissector
-			 * didn't accept the packet or it didn't add any
-			 * items to the tree so remove it from the list.
-			 */
-			while (wmem_list_count(pinfo->layers) > saved_layers_len) {
-				if (len == 0) {
-					/*
-					 * Only reduce the layer number if the dissector
-					 * rejected the data. Since tree can be NULL on
-					 * the first pass, we cannot check it or it will
-					 * break dissectors that rely on a stable value.
-					 */
-					pinfo->curr_layer_num--;
-				}
-				wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
-			}
-		}
-		if (len) {
-			*heur_dtbl_entry = hdtbl_entry;
+	if (conv != NULL && !pinfo->fd->visited) {
+		if (conv_cache == NULL) {
+			heur_conv_key_t *new_key = wmem_new(wmem_file_scope(), heur_conv_key_t);
 
-			/* Bubble the matched entry to the top for faster search next time. */
-			if (prev_entry != NULL) {
-				sub_dissectors->dissectors = g_slist_remove_link(sub_dissectors->dissectors, entry);
-				sub_dissectors->dissectors = g_slist_concat(entry, sub_dissectors->dissectors);
-			}
-			status = TRUE;
-			break;
+			*new_key = conv_key;
+			conv_cache = wmem_new(wmem_file_scope(), heur_conv_cache_t);
+			conv_cache->winner = NULL;
+			conv_cache->first_tried = pinfo->num;
+			conv_cache->first_match = G_MAXUINT32;
+			wmem_map_insert(heur_conv_caches, new_key, conv_cache);
+		}
+		conv_cache->last_tried = pinfo->num;
+		if (winner != NULL) {
+			conv_cache->winner = winner;
+			if (pinfo->num < conv_cache->first_match)
+				conv_cache->first_match = pinfo->num;
 		}
-		prev_entry = entry;
 	}
 
+done:
 	pinfo->current_proto = saved_curr_proto;
 	pinfo->heur_list_name = saved_heur_list_name;
 	pinfo->can_desegment = saved_can_desegment;
@@ -439,6 +439,9 @@ typedef struct heur_dtbl_entry {
 	const gchar *display_name;     /* the string used to present heuristic to user */
 	gchar *short_name;     /* string used for "internal" use to uniquely identify heuristic */
 	gboolean enabled;
+	guint64 hits;         /* number of times this dissector accepted a packet */
+	guint64 misses;       /* number of times it was tried and rejected a packet */
+	guint64 time_us;      /* time spent in it, if heur_dissector_set_timing() enabled timing */
 } heur_dtbl_entry_t;
 
 /** A protocol uses this function to register a heuristic sub-dissector list.
@@ -495,6 +498,16 @@ WS_DLL_PUBLIC gboolean has_heur_dissector_list(const gchar *name);
 WS_DLL_PUBLIC gboolean dissector_try_heuristic(heur_dissector_list_t sub_dissectors,
     tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **hdtbl_entry, void *data);
 
+/** Enable or disable timing heuristic dissectors.
+ *
+ * The hits and misses of heuristic dissectors are always counted; with
+ * timing enabled, the time spent in each of them is added up too, at
+ * the cost of reading the clock twice per call.
+ *
+ * @param enable TRUE to time heuristic dissectors
+ */
+WS_DLL_PUBLIC void heur_dissector_set_timing(gboolean enable);
+
 /** Find a heuristic dissector table by table name.
  *
  * @param name name of the dissector table
@@ -28,7 +28,9 @@
 #include <epan/print.h>
 #include <epan/charsets.h>
 #include <wsutil/json_dumper.h>
+#include <wsutil/arrow_writer.h>
 #include <wsutil/filesystem.h>
+#include <wsutil/strtoi.h>
 #include <version_info.h>
 #include <wsutil/utf8_entities.h>
 #include <ftypes/ftypes-int.h>
@@ -81,6 +83,11 @@ struct _output_fields {
     GPtrArray   **field_values;
     gchar         quote;
     gboolean      includes_col_fields;
+    arrow_writer *arrow;
+    arrow_type   *arrow_types;
+    GPtrArray   **field_finfos;
+    guint32       arrow_batch_rows;
+    GString      *ek_buffer;  /* Output buffer reused for each packet with -T ek */
 };
 
 static gchar *get_field_hex_value(GSList *src_list, field_info *fi);
@@ -306,7 +313,7 @@ write_pdml_proto_tree(output_fields_t* fields, gchar **protocolfilter, pf_flags
     g_assert(edt);
     g_assert(fh);
 
-    cfp = edt->pi.fd->color_filter;
+    cfp = color_filters_get_frame_filter(edt->pi.fd);
 
     /* Create the output */
     if (use_color && (cfp != NULL)) {
@@ -351,9 +358,16 @@ write_ek_proto_tree(output_fields_t* fields,
 
     write_json_data data;
 
+    /* Reuse one buffer for all the packets rather than allocating one for
+     * each of them. */
+    if (fields != NULL && fields->ek_buffer == NULL) {
+        fields->ek_buffer = g_string_sized_new(4096);
+    }
+
     json_dumper dumper = {
         .output_file = fh,
-        .flags = JSON_DUMPER_DOT_TO_UNDERSCORE
+        .flags = JSON_DUMPER_DOT_TO_UNDERSCORE,
+        .output_buffer = fields != NULL ? fields->ek_buffer : NULL
     };
 
     data.dumper = &dumper;
@@ -366,7 +380,8 @@ write_ek_proto_tree(output_fields_t* fields,
     json_dumper_value_string(&dumper, "doc");
     json_dumper_end_object(&dumper);
     json_dumper_end_object(&dumper);
-    json_dumper_finish(&dumper);
+    /* Both documents of the packet are written out at once below. */
+    json_dumper_end_document(&dumper);
     json_dumper_begin_object(&dumper);
 
     /* Timestamp added for time indexing in Elasticsearch */
@@ -1570,7 +1585,7 @@ void
 write_psml_columns(epan_dissect_t *edt, FILE *fh, gboolean use_color)
 {
     gint i;
-    const color_filter_t *cfp = edt->pi.fd->color_filter;
+    const color_filter_t *cfp = color_filters_get_frame_filter(edt->pi.fd);
 
     if (use_color && (cfp != NULL)) {
         fprintf(fh, "<packet foreground='#%06x' background='#%06x'>\n",
@@ -1769,65 +1784,60 @@ static void
 print_escaped_xml(FILE *fh, const char *unescaped_string)
 {
     const char *p;
-
-#define ESCAPED_BUFFER_MAX 256
-    static char temp_buffer[ESCAPED_BUFFER_MAX];
-    gint        offset = 0;
+    size_t      len;
 
     if (fh == NULL || unescaped_string == NULL) {
         return;
     }
 
-    for (p = unescaped_string; *p != '\0'; p++) {
+    for (p = unescaped_string; ; p++) {
+        /* Write the run of characters that need no escaping at once. */
+        len = strcspn(p, "&<>\"'");
+        if (len) {
+            fwrite(p, 1, len, fh);
+            p += len;
+        }
         switch (*p) {
+        case '\0':
+            return;
         case '&':
-            g_strlcpy(&temp_buffer[offset], "&amp;", ESCAPED_BUFFER_MAX-offset);
-            offset += 5;
+            fputs("&amp;", fh);
             break;
         case '<':
-            g_strlcpy(&temp_buffer[offset], "&lt;", ESCAPED_BUFFER_MAX-offset);
-            offset += 4;
+            fputs("&lt;", fh);
             break;
         case '>':
-            g_strlcpy(&temp_buffer[offset], "&gt;", ESCAPED_BUFFER_MAX-offset);
-            offset += 4;
+            fputs("&gt;", fh);
             break;
         case '"':
-            g_strlcpy(&temp_buffer[offset], "&quot;", ESCAPED_BUFFER_MAX-offset);
-            offset += 6;
+            fputs("&quot;", fh);
             break;
         case '\'':
-            g_strlcpy(&temp_buffer[offset], "&#x27;", ESCAPED_BUFFER_MAX-offset);
-            offset += 6;
+            fputs("&#x27;", fh);
             break;
-        default:
-            temp_buffer[offset++] = *p;
-        }
-        if (offset > ESCAPED_BUFFER_MAX-8) {
-            /* Getting close to end of buffer so flush to fh */
-            temp_buffer[offset] = '\0';
-            fputs(temp_buffer, fh);
-            offset = 0;
         }
     }
-    if (offset) {
-        /* Flush any outstanding data */
-        temp_buffer[offset] = '\0';
-        fputs(temp_buffer, fh);
-    }
 }
 
 static void
 print_escaped_csv(FILE *fh, const char *unescaped_string)
 {
     const char *p;
+    size_t      len;
 
     if (fh == NULL || unescaped_string == NULL) {
         return;
     }
 
-    for (p = unescaped_string; *p != '\0'; p++) {
+    for (p = unescaped_string; ; p++) {
+        len = strcspn(p, "\b\f\n\r\t");
+        if (len) {
+            fwrite(p, 1, len, fh);
+            p += len;
+        }
         switch (*p) {
+        case '\0':
+            return;
         case '\b':
             fputs("\\b", fh);
             break;
@@ -1843,8 +1853,6 @@ print_escaped_csv(FILE *fh, const char *unescaped_string)
         case '\t':
             fputs("\\t", fh);
             break;
-        default:
-            fputc(*p, fh);
         }
     }
 }
@@ -2096,6 +2104,17 @@ void output_fields_free(output_fields_t* fields)
             g_free(fields->field_values);
         }
 
+        if (NULL != fields->field_finfos) {
+            for (i = 0; i < fields->fields->len; ++i) {
+                if (NULL != fields->field_finfos[i]) {
+                    g_ptr_array_free(fields->field_finfos[i], TRUE);
+                }
+            }
+            g_free(fields->field_finfos);
+        }
+        g_free(fields->arrow_types);
+        arrow_writer_free(fields->arrow);
+
         for (i = 0; i < fields->fields->len; ++i) {
             gchar* field = (gchar *)g_ptr_array_index(fields->fields,i);
             g_free(field);
@@ -2103,6 +2122,10 @@ void output_fields_free(output_fields_t* fields)
         g_ptr_array_free(fields->fields, TRUE);
     }
 
+    if (NULL != fields->ek_buffer) {
+        g_string_free(fields->ek_buffer, TRUE);
+    }
+
     g_free(fields);
 }
 
@@ -2257,6 +2280,14 @@ gboolean output_fields_set_option(output_fields_t *info, gchar *option)
         }
         return TRUE;
     }
+    else if (0 == strcmp(option_name, "batch")) {
+        if (!ws_strtou32(option_value, NULL, &info->arrow_batch_rows) ||
+            info->arrow_batch_rows == 0) {
+            info->arrow_batch_rows = 0;
+            return FALSE;
+        }
+        return TRUE;
+    }
     else if (0 == strcmp(option_name, "bom")) {
         switch (*option_value) {
         case 'n':
@@ -2283,6 +2314,7 @@ void output_fields_list_options(FILE *fh)
     fputs("occurrence=f|l|a  Select the occurrence of a field to use;\n     \"f\" = first, \"l\" = last, \"a\" = all (def: a: all)\n", fh);
     fputs("aggregator=,|/s|<character>   Set the aggregator to use;\n     \",\" = comma, \"/s\" = space (def: ,: comma)\n", fh);
     fputs("quote=d|s|n   Print either d: double-quotes, s: single quotes or \n     n: no quotes around field values (def: n: none)\n", fh);
+    fputs("batch=<rows>  Rows per record batch with -T arrow (def: 65536)\n", fh);
 }
 
 gboolean output_fields_has_cols(output_fields_t* fields)
@@ -2408,6 +2440,26 @@ static void proto_tree_get_node_field_values(proto_node *node, gpointer data)
     }
 }
 
+static void output_fields_prepare_indicies(output_fields_t *fields)
+{
+    gsize i;
+
+    if (NULL == fields->field_indicies) {
+        /* Prepare a lookup table from string abbreviation for field to its index. */
+        fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
+
+        i = 0;
+        while (i < fields->fields->len) {
+            gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
+            /* Store field indicies +1 so that zero is not a valid value,
+             * and can be distinguished from NULL as a pointer.
+             */
+            ++i;
+            g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
+        }
+    }
+}
+
 static void write_specified_fields(fields_format format, output_fields_t *fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh, json_dumper *dumper)
 {
     gsize     i;
@@ -2430,20 +2482,7 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
     data.fields = fields;
     data.edt = edt;
 
-    if (NULL == fields->field_indicies) {
-        /* Prepare a lookup table from string abbreviation for field to its index. */
-        fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
-
-        i = 0;
-        while (i < fields->fields->len) {
-            gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
-            /* Store field indicies +1 so that zero is not a valid value,
-             * and can be distinguished from NULL as a pointer.
-             */
-            ++i;
-            g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
-        }
-    }
+    output_fields_prepare_indicies(fields);
 
     /* Array buffer to store values for this packet              */
     /*  Allocate an array for the 'GPtrarray *' the first time   */
@@ -2596,6 +2635,254 @@ void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
     /* Nothing to do */
 }
 
+/*
+ * Arrow output: the same fields as with write_fields_proto_tree(), but
+ * written as typed columns, taken straight from the field values instead
+ * of formatting them.
+ */
+
+static arrow_type arrow_type_for_ftype(enum ftenum type)
+{
+    if (IS_FT_UINT(type))
+        return ARROW_TYPE_UINT64;
+    if (IS_FT_INT(type))
+        return ARROW_TYPE_INT64;
+
+    switch (type) {
+    case FT_FLOAT:
+    case FT_DOUBLE:
+        return ARROW_TYPE_DOUBLE;
+    case FT_BOOLEAN:
+        return ARROW_TYPE_BOOL;
+    case FT_IPv4:
+        return ARROW_TYPE_UINT32;
+    case FT_ABSOLUTE_TIME:
+        return ARROW_TYPE_TIMESTAMP;
+    case FT_RELATIVE_TIME:
+        return ARROW_TYPE_DURATION;
+    case FT_ETHER:
+    case FT_BYTES:
+    case FT_UINT_BYTES:
+    case FT_IPv6:
+        return ARROW_TYPE_BINARY;
+    default:
+        return ARROW_TYPE_UTF8;
+    }
+}
+
+static arrow_type arrow_type_for_field(const gchar *field)
+{
+    header_field_info *hfinfo;
+    arrow_type         type;
+
+    if (g_str_has_prefix(field, COLUMN_FIELD_FILTER))
+        return ARROW_TYPE_UTF8;
+
+    hfinfo = proto_registrar_get_byname(field);
+    if (hfinfo == NULL)
+        return ARROW_TYPE_UTF8;
+
+    /* Fields with the same name don't necessarily have the same type. */
+    type = arrow_type_for_ftype(hfinfo->type);
+    for (hfinfo = hfinfo->same_name_next; hfinfo != NULL; hfinfo = hfinfo->same_name_next) {
+        if (arrow_type_for_ftype(hfinfo->type) != type)
+            return ARROW_TYPE_UTF8;
+    }
+    return type;
+}
+
+gboolean write_arrow_preamble(output_fields_t* fields, FILE *fh)
+{
+    gsize i;
+
+    g_assert(fields);
+    g_assert(fh);
+    g_assert(fields->fields);
+
+    fields->arrow = arrow_writer_new(fh, fields->arrow_batch_rows);
+    fields->arrow_types = g_new(arrow_type, fields->fields->len);
+    fields->field_finfos = g_new0(GPtrArray*, fields->fields->len);
+    for (i = 0; i < fields->fields->len; ++i) {
+        const gchar* field = (const gchar *)g_ptr_array_index(fields->fields, i);
+
+        fields->arrow_types[i] = arrow_type_for_field(field);
+        /* All occurrences of a field go into a list. */
+        arrow_writer_add_column(fields->arrow, field, fields->arrow_types[i],
+                                fields->occurrence == 'a');
+    }
+    return arrow_writer_begin(fields->arrow);
+}
+
+static void proto_tree_get_node_field_infos(proto_node *node, gpointer data)
+{
+    output_fields_t *fields = (output_fields_t *)data;
+    field_info *fi;
+    gpointer    field_index;
+    guint       indx;
+
+    fi = PNODE_FINFO(node);
+
+    /* dissection with an invisible proto tree? */
+    g_assert(fi);
+
+    field_index = g_hash_table_lookup(fields->field_indicies, fi->hfinfo->abbrev);
+    if (NULL != field_index) {
+        indx = GPOINTER_TO_UINT(field_index) - 1;
+        if (fields->field_finfos[indx] == NULL) {
+            fields->field_finfos[indx] = g_ptr_array_new();
+        }
+        g_ptr_array_add(fields->field_finfos[indx], fi);
+    }
+
+    /* Recurse here. */
+    if (node->first_child != NULL) {
+        proto_tree_children_foreach(node, proto_tree_get_node_field_infos, fields);
+    }
+}
+
+static void write_arrow_field_value(output_fields_t *fields, guint column, field_info *fi, epan_dissect_t *edt)
+{
+    fvalue_t       *fv = &fi->value;
+    enum ftenum     type = fvalue_type_ftenum(fv);
+    const nstime_t *ts;
+    const ipv6_addr_and_prefix *ipv6;
+    const gchar    *str;
+    gchar          *value;
+
+    switch (fields->arrow_types[column]) {
+    case ARROW_TYPE_UINT64:
+        arrow_writer_append_uint(fields->arrow, column,
+                                 IS_FT_UINT32(type) ? fvalue_get_uinteger(fv) : fvalue_get_uinteger64(fv));
+        break;
+    case ARROW_TYPE_INT64:
+        arrow_writer_append_int(fields->arrow, column,
+                                IS_FT_INT32(type) ? fvalue_get_sinteger(fv) : fvalue_get_sinteger64(fv));
+        break;
+    case ARROW_TYPE_BOOL:
+        arrow_writer_append_uint(fields->arrow, column, fvalue_get_uinteger64(fv));
+        break;
+    case ARROW_TYPE_UINT32:
+        /* IPv4 addresses are in network byte order. */
+        arrow_writer_append_uint(fields->arrow, column, g_ntohl(fvalue_get_uinteger(fv)));
+        break;
+    case ARROW_TYPE_DOUBLE:
+        arrow_writer_append_double(fields->arrow, column, fvalue_get_floating(fv));
+        break;
+    case ARROW_TYPE_TIMESTAMP:
+    case ARROW_TYPE_DURATION:
+        ts = (const nstime_t *)fvalue_get(fv);
+        arrow_writer_append_int(fields->arrow, column,
+                                (gint64)ts->secs * 1000000000 + ts->nsecs);
+        break;
+    case ARROW_TYPE_BINARY:
+        if (type == FT_IPv6) {
+            ipv6 = (const ipv6_addr_and_prefix *)fvalue_get(fv);
+            arrow_writer_append_bytes(fields->arrow, column, ipv6->addr.bytes, FT_IPv6_LEN);
+        } else {
+            arrow_writer_append_bytes(fields->arrow, column,
+                                      (const guint8 *)fvalue_get(fv), fvalue_length(fv));
+        }
+        break;
+    default:
+        if (IS_FT_STRING(type) || type == FT_UINT_STRING) {
+            str = (const gchar *)fvalue_get(fv);
+            arrow_writer_append_bytes(fields->arrow, column, (const guint8 *)str, strlen(str));
+        } else {
+            value = get_node_field_value(fi, edt);
+            if (value != NULL) {
+                arrow_writer_append_bytes(fields->arrow, column, (const guint8 *)value, strlen(value));
+                g_free(value);
+            }
+        }
+        break;
+    }
+}
+
+gboolean write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh _U_)
+{
+    GPtrArray  *fi_p;
+    gsize       i;
+    guint       j, first, last, indx;
+    gint        col, col_first, col_end, col_step;
+    gchar      *col_name;
+
+    g_assert(fields);
+    g_assert(fields->arrow);
+    g_assert(edt);
+
+    output_fields_prepare_indicies(fields);
+
+    proto_tree_children_foreach(edt->tree, proto_tree_get_node_field_infos, fields);
+
+    for (i = 0; i < fields->fields->len; ++i) {
+        /* A field given more than once has its values collected for the
+         * last of its columns only; write them to each of its columns. */
+        indx = GPOINTER_TO_UINT(g_hash_table_lookup(fields->field_indicies,
+                                                    g_ptr_array_index(fields->fields, i))) - 1;
+        fi_p = fields->field_finfos[indx];
+        if (NULL == fi_p || 0 == fi_p->len)
+            continue;
+
+        /* Which occurrences of the field to write? */
+        first = 0;
+        last = fi_p->len - 1;
+        if (fields->occurrence == 'f')
+            last = 0;
+        else if (fields->occurrence == 'l')
+            first = last;
+
+        for (j = first; j <= last; j++) {
+            write_arrow_field_value(fields, (guint)i, (field_info *)g_ptr_array_index(fi_p, j), edt);
+        }
+        if (indx == i)
+            g_ptr_array_set_size(fi_p, 0);  /* get ready for the next packet */
+    }
+
+    /* Add columns to fields */
+    if (fields->includes_col_fields) {
+        /* Columns that aren't lists keep the first value they get, so go
+         * through the columns backwards for the last occurrence of a title
+         * given more than once. */
+        if (fields->occurrence == 'l') {
+            col_first = cinfo->num_cols - 1;
+            col_end = -1;
+            col_step = -1;
+        } else {
+            col_first = 0;
+            col_end = cinfo->num_cols;
+            col_step = 1;
+        }
+        for (col = col_first; col != col_end; col += col_step) {
+            if (!get_column_visible(col))
+                continue;
+            /* Prepend COLUMN_FIELD_FILTER as the field name */
+            col_name = g_strdup_printf("%s%s", COLUMN_FIELD_FILTER, cinfo->columns[col].col_title);
+            for (i = 0; i < fields->fields->len; ++i) {
+                if (strcmp(col_name, (const gchar *)g_ptr_array_index(fields->fields, i)) == 0) {
+                    arrow_writer_append_bytes(fields->arrow, (guint)i,
+                                              (const guint8 *)cinfo->columns[col].col_data,
+                                              strlen(cinfo->columns[col].col_data));
+                }
+            }
+            g_free(col_name);
+        }
+    }
+
+    return arrow_writer_end_row(fields->arrow);
+}
+
+gboolean write_arrow_finale(output_fields_t* fields, FILE *fh _U_)
+{
+    gboolean ret;
+
+    g_assert(fields);
+
+    ret = arrow_writer_finish(fields->arrow);
+    arrow_writer_free(fields->arrow);
+    fields->arrow = NULL;
+    return ret;
+}
+
 /* Returns an g_malloced string */
 gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt)
 {
@@ -2733,6 +3020,11 @@ output_fields_t* output_fields_new(void)
     fields->field_values        = NULL;
     fields->quote               ='\0';
     fields->includes_col_fields = FALSE;
+    fields->arrow               = NULL;
+    fields->arrow_types         = NULL;
+    fields->field_finfos        = NULL;
+    fields->arrow_batch_rows    = 0;
+    fields->ek_buffer           = NULL;
     return fields;
 }
 
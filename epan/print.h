@@ -125,6 +125,12 @@ WS_DLL_PUBLIC void write_fields_preamble(output_fields_t* fields, FILE *fh);
 WS_DLL_PUBLIC void write_fields_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh);
 WS_DLL_PUBLIC void write_fields_finale(output_fields_t* fields, FILE *fh);
 
+/* The Arrow writers return FALSE if the output couldn't be written, or if a
+ * row was too large for a record batch; nothing more is written after that. */
+WS_DLL_PUBLIC gboolean write_arrow_preamble(output_fields_t* fields, FILE *fh);
+WS_DLL_PUBLIC gboolean write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh);
+WS_DLL_PUBLIC gboolean write_arrow_finale(output_fields_t* fields, FILE *fh);
+
 WS_DLL_PUBLIC gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt);
 
 extern void print_cache_field_handles(void);
@@ -106,6 +106,7 @@ free_stat_node(stat_node *node)
     }
 
     if (node->hash) g_hash_table_destroy(node->hash);
+    if (node->key_hash) g_hash_table_destroy(node->key_hash);
 
     while (node->bh) {
         bucket = node->bh;
@@ -138,6 +139,9 @@ stats_tree_free(stats_tree *st)
         free_stat_node(child);
     }
 
+    if (st->root.key_hash)
+        g_hash_table_destroy(st->root.key_hash);
+
     if (st->cfg->free_tree_pr)
         st->cfg->free_tree_pr(st);
 
@@ -215,6 +219,11 @@ stats_tree_reinit(void *p)
     }
 
     st->root.children = NULL;
+    st->root.last_child = NULL;
+    if (st->root.key_hash) {
+        g_hash_table_destroy(st->root.key_hash);
+        st->root.key_hash = NULL;
+    }
     st->root.counter = 0;
     switch (st->root.datatype)
     {
@@ -463,7 +472,6 @@ new_stat_node(stats_tree *st, const gchar *name, int parent_id, stat_node_dataty
 {
 
     stat_node *node = g_new0(stat_node, 1);
-    stat_node *last_chld = NULL;
 
     node->datatype = datatype;
     switch (datatype)
@@ -508,17 +516,12 @@ new_stat_node(stats_tree *st, const gchar *name, int parent_id, stat_node_dataty
 
     if (node->parent->children) {
         /* insert as last child */
-
-        for (last_chld = node->parent->children;
-             last_chld->next;
-             last_chld = last_chld->next ) ;
-
-        last_chld->next = node;
-
+        node->parent->last_child->next = node;
     } else {
         /* insert as first child */
         node->parent->children = node;
     }
+    node->parent->last_child = node;
 
     if(node->parent->hash) {
         g_hash_table_replace(node->parent->hash,node->name,node);
@@ -640,32 +643,9 @@ update_burst_calc(stat_node *node, gint value)
     }
 }
 
-/*
- * Increases by delta the counter of the node whose name is given
- * if the node does not exist yet it's created (with counter=1)
- * using parent_name as parent node.
- * with_hash=TRUE to indicate that the created node will have a parent
- */
-int
-stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name,
-              int parent_id, gboolean with_hash, gint value)
+static void
+manip_stat_node_int(stat_node *node, manip_node_mode mode, gint value)
 {
-    stat_node *node = NULL;
-    stat_node *parent = NULL;
-
-    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
-
-    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
-
-    if( parent->hash ) {
-        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
-    } else {
-        node = (stat_node *)g_hash_table_lookup(st->names,name);
-    }
-
-    if ( node == NULL )
-        node = new_stat_node(st,name,parent_id,STAT_DT_INT,with_hash,with_hash);
-
     switch (mode) {
         case MN_INCREASE:
             node->counter += value;
@@ -695,11 +675,81 @@ stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name
             node->st_flags &= ~value;
             break;
     }
+}
 
-    if (node)
-        return node->id;
-    else
-        return -1;
+/*
+ * Increases by delta the counter of the node whose name is given
+ * if the node does not exist yet it's created (with counter=1)
+ * using parent_name as parent node.
+ * with_hash=TRUE to indicate that the created node will have a parent
+ */
+int
+stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name,
+              int parent_id, gboolean with_hash, gint value)
+{
+    stat_node *node = NULL;
+    stat_node *parent = NULL;
+
+    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
+
+    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
+
+    if( parent->hash ) {
+        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
+    } else {
+        node = (stat_node *)g_hash_table_lookup(st->names,name);
+    }
+
+    if ( node == NULL )
+        node = new_stat_node(st,name,parent_id,STAT_DT_INT,with_hash,with_hash);
+
+    manip_stat_node_int(node, mode, value);
+
+    return node->id;
+}
+
+/*
+ * Finds the child of parent_id with the given key, creating it (named by
+ * name_cb) if it does not exist yet.
+ */
+static stat_node *
+stat_node_by_key(stats_tree *st, guint32 key, stat_node_key_name_cb name_cb,
+              const void *data, int parent_id, gboolean with_hash)
+{
+    stat_node *node;
+    stat_node *parent;
+    gchar *name;
+
+    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
+
+    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
+
+    if (parent->key_hash) {
+        node = (stat_node *)g_hash_table_lookup(parent->key_hash, GUINT_TO_POINTER(key));
+        if (node)
+            return node;
+    } else {
+        parent->key_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    name = name_cb(key, data);
+    node = new_stat_node(st,name,parent_id,STAT_DT_INT,with_hash,with_hash);
+    g_free(name);
+    g_hash_table_insert(parent->key_hash, GUINT_TO_POINTER(key), node);
+
+    return node;
+}
+
+int
+stats_tree_manip_node_int_by_key(manip_node_mode mode, stats_tree *st, guint32 key,
+              stat_node_key_name_cb name_cb, const void *data,
+              int parent_id, gboolean with_hash, gint value)
+{
+    stat_node *node = stat_node_by_key(st, key, name_cb, data, parent_id, with_hash);
+
+    manip_stat_node_int(node, mode, value);
+
+    return node->id;
 }
 
 /*
@@ -1004,6 +1054,19 @@ stats_tree_tick_pivot(stats_tree *st, int pivot_id, const gchar *pivot_value)
     return pivot_id;
 }
 
+extern int
+stats_tree_tick_pivot_by_key(stats_tree *st, int pivot_id, guint32 key,
+                 stat_node_key_name_cb name_cb, const void *data)
+{
+    stat_node *parent = (stat_node *)g_ptr_array_index(st->parents,pivot_id);
+
+    parent->counter++;
+    update_burst_calc(parent, 1);
+    stats_tree_manip_node_int_by_key( MN_INCREASE, st, key, name_cb, data, pivot_id, FALSE, 1);
+
+    return pivot_id;
+}
+
 extern gchar*
 stats_tree_get_displayname (gchar* fullname)
 {
@@ -177,6 +177,21 @@ WS_DLL_PUBLIC int stats_tree_tick_pivot(stats_tree *st,
                                         int pivot_id,
                                         const gchar *pivot_value);
 
+/* Returns the name, allocated with g_malloc(), of a node created by one of
+ * the _by_key functions. It's only called when the node is created.
+ * key: the key of the node
+ * data: the data passed to the _by_key function
+ */
+typedef gchar *(*stat_node_key_name_cb)(guint32 key, const void *data);
+
+/* like stats_tree_tick_pivot(), with the value looked up by an integer key
+ * instead of its name, see stats_tree_manip_node_int_by_key() */
+WS_DLL_PUBLIC int stats_tree_tick_pivot_by_key(stats_tree *st,
+                                               int pivot_id,
+                                               guint32 key,
+                                               stat_node_key_name_cb name_cb,
+                                               const void *data);
+
 extern void stats_tree_cleanup(void);
 
 
@@ -201,6 +216,22 @@ WS_DLL_PUBLIC int stats_tree_manip_node_int(manip_node_mode mode,
                                         gboolean with_children,
                                         gint value);
 
+/*
+ * like stats_tree_manip_node_int(), but the node is looked up among the
+ * children of parent_id by an integer key (an address, a port, a code)
+ * rather than by name, so there is no name to format and hash on every
+ * packet. The name is made by name_cb(key, data) when the node is created.
+ * Children of a parent should all be looked up either by key or by name.
+ */
+WS_DLL_PUBLIC int stats_tree_manip_node_int_by_key(manip_node_mode mode,
+                                        stats_tree *st,
+                                        guint32 key,
+                                        stat_node_key_name_cb name_cb,
+                                        const void *data,
+                                        int parent_id,
+                                        gboolean with_children,
+                                        gint value);
+
 WS_DLL_PUBLIC int stats_tree_manip_node_float(manip_node_mode mode,
                                         stats_tree *st,
                                         const gchar *name,
@@ -214,6 +245,9 @@ WS_DLL_PUBLIC int stats_tree_manip_node_float(manip_node_mode mode,
 #define tick_stat_node(st,name,parent_id,with_children)                 \
     (stats_tree_manip_node_int(MN_INCREASE,(st),(name),(parent_id),(with_children),1))
 
+#define tick_stat_node_by_key(st,key,name_cb,data,parent_id,with_children) \
+    (stats_tree_manip_node_int_by_key(MN_INCREASE,(st),(key),(name_cb),(data),(parent_id),(with_children),1))
+
 #define set_stat_node(st,name,parent_id,with_children,value)            \
     (stats_tree_manip_node_int(MN_SET,(st),(name),(parent_id),(with_children),value))
 
@@ -84,12 +84,16 @@ struct _stat_node {
 	/** children nodes by name */
 	GHashTable		*hash;
 
+	/** children nodes by integer key, see stats_tree_manip_node_int_by_key() */
+	GHashTable		*key_hash;
+
 	/** the owner of this node */
 	stats_tree		*st;
 
 	/** relatives */
 	stat_node		*parent;
 	stat_node		*children;
+	stat_node		*last_child;
 	stat_node		*next;
 
 	/** used to check if value is within range */
@@ -16,6 +16,7 @@
 #include "strutil.h"
 
 #include <wsutil/str_util.h>
+#include <wsutil/ws_memmem.h>
 #include <epan/proto.h>
 
 #ifdef _WIN32
@@ -1360,32 +1361,17 @@ xml_escape(const gchar *unescaped)
 
 /* Return the first occurrence of needle in haystack.
  * If not found, return NULL.
- * If either haystack or needle has 0 length, return NULL.
- * Algorithm copied from GNU's glibc 2.3.2 memmem() under LGPL 2.1+ */
+ * If either haystack or needle has 0 length, return NULL. */
 const guint8 *
 epan_memmem(const guint8 *haystack, guint haystack_len,
         const guint8 *needle, guint needle_len)
 {
-    const guint8 *begin;
-    const guint8 *const last_possible = haystack + haystack_len - needle_len;
+    ws_memmem_pattern pattern;
 
-    if (needle_len == 0) {
-        return NULL;
-    }
-
-    if (needle_len > haystack_len) {
-        return NULL;
-    }
-
-    for (begin = haystack ; begin <= last_possible; ++begin) {
-        if (begin[0] == needle[0] &&
-                !memcmp(&begin[1], needle + 1,
-                    needle_len - 1)) {
-            return begin;
-        }
-    }
-
-    return NULL;
+    /* Compiling a case-sensitive, narrow pattern doesn't allocate
+     * anything, so there's no need to free it. */
+    ws_memmem_compile(&pattern, needle, needle_len, 0);
+    return ws_memmem_exec(haystack, haystack_len, &pattern);
 }
 
 /*
@@ -93,6 +93,9 @@ typedef struct _tap_listener_t {
 
 static tap_listener_t *tap_listener_queue=NULL;
 
+/* Lets the listener filters share the fields they load from a packet */
+static dfilter_group_t *tap_filter_group=NULL;
+
 static GSList *tap_plugins = NULL;
 
 #ifdef HAVE_PLUGINS
@@ -317,6 +320,10 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 		return;
 	}
 
+	if(!tap_filter_group){
+		tap_filter_group=dfilter_group_new();
+	}
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
@@ -347,7 +354,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 					 * packet passes.
 					 */
 					if(tl->code){
-						if (!dfilter_apply_edt(tl->code, edt)){
+						if (!dfilter_group_apply(tap_filter_group, tl->code, edt->tree)){
 							/* The packet didn't
 							 * pass the filter. */
 							continue;
@@ -376,6 +383,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 			}
 		}
 	}
+	dfilter_group_reset(tap_filter_group);
 }
 
 
@@ -776,6 +784,9 @@ void tap_cleanup(void)
 
 	g_slist_free(tap_plugins);
 	tap_plugins = NULL;
+
+	dfilter_group_free(tap_filter_group);
+	tap_filter_group = NULL;
 }
 
 /*
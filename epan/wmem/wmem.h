@@ -23,6 +23,7 @@
 #include "wmem_strbuf.h"
 #include "wmem_strutl.h"
 #include "wmem_tree.h"
+#include "wmem_btree.h"
 #include "wmem_interval_tree.h"
 #include "wmem_user_cb.h"
 
@@ -32,6 +32,7 @@ struct _wmem_allocator_t {
     /* Producer/Manager functions */
     void  (*free_all)(void *private_data);
     void  (*gc)(void *private_data);
+    size_t (*size)(void *private_data); /* NULL if not kept track of */
     void  (*cleanup)(void *private_data);
 
     /* Callback List */
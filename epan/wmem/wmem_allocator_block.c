@@ -144,6 +144,7 @@
 /* The header for an entire OS-level 'block' of memory */
 typedef struct _wmem_block_hdr_t {
     struct _wmem_block_hdr_t *prev, *next;
+    size_t len; /* Size of the whole block, including this header */
 } wmem_block_hdr_t;
 
 /* The header for a single 'chunk' of memory as returned from alloc/realloc.
@@ -199,6 +200,7 @@ typedef struct _wmem_block_allocator_t {
     wmem_block_hdr_t   *block_list;
     wmem_block_chunk_t *master_head;
     wmem_block_chunk_t *recycler_head;
+    size_t              size; /* Total size of the blocks in block_list */
 } wmem_block_allocator_t;
 
 /* DEBUG AND TEST */
@@ -321,6 +323,7 @@ wmem_block_verify(wmem_allocator_t *allocator)
     wmem_block_hdr_t       *cur;
     wmem_block_allocator_t *private_allocator;
     int                     master_free, recycler_free, chunk_free = 0;
+    size_t                  size = 0;
 
     /* Normally it would be bad for an allocator helper function to depend
      * on receiving the right type of allocator, but this is for testing only
@@ -332,6 +335,7 @@ wmem_block_verify(wmem_allocator_t *allocator)
     if (private_allocator->block_list == NULL) {
         g_assert(! private_allocator->master_head);
         g_assert(! private_allocator->recycler_head);
+        g_assert(private_allocator->size == 0);
         return;
     }
 
@@ -345,10 +349,12 @@ wmem_block_verify(wmem_allocator_t *allocator)
             g_assert(cur->next->prev == cur);
         }
         chunk_free += wmem_block_verify_block(cur);
+        size += cur->len;
         cur = cur->next;
     }
 
     g_assert(chunk_free == master_free + recycler_free);
+    g_assert(size == private_allocator->size);
 }
 
 /* MASTER/RECYCLER HELPERS */
@@ -714,6 +720,7 @@ wmem_block_add_to_block_list(wmem_block_allocator_t *allocator,
         block->next->prev = block;
     }
     allocator->block_list = block;
+    allocator->size += block->len;
 }
 
 /* Remove a block from the allocator's embedded doubly-linked list of OS-level
@@ -732,6 +739,7 @@ wmem_block_remove_from_block_list(wmem_block_allocator_t *allocator,
     if (block->next) {
         block->next->prev = block->prev;
     }
+    allocator->size -= block->len;
 }
 
 /* Initializes a single unused chunk at the beginning of the block, and
@@ -763,6 +771,7 @@ wmem_block_new_block(wmem_block_allocator_t *allocator)
 
     /* allocate the new block and add it to the block list */
     block = (wmem_block_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
+    block->len = WMEM_BLOCK_SIZE;
     wmem_block_add_to_block_list(allocator, block);
 
     /* initialize it */
@@ -782,6 +791,7 @@ wmem_block_alloc_jumbo(wmem_block_allocator_t *allocator, const size_t size)
     block = (wmem_block_hdr_t *) wmem_alloc(NULL, size
             + WMEM_BLOCK_HEADER_SIZE
             + WMEM_CHUNK_HEADER_SIZE);
+    block->len = size + WMEM_BLOCK_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE;
 
     /* add it to the block list */
     wmem_block_add_to_block_list(allocator, block);
@@ -826,6 +836,10 @@ wmem_block_realloc_jumbo(wmem_block_allocator_t *allocator,
             + WMEM_BLOCK_HEADER_SIZE
             + WMEM_CHUNK_HEADER_SIZE);
 
+    allocator->size -= block->len;
+    block->len = size + WMEM_BLOCK_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE;
+    allocator->size += block->len;
+
     if (block->next) {
         block->next->prev = block;
     }
@@ -1040,6 +1054,7 @@ wmem_block_gc(void *private_data)
      * completely destroying unused blocks. */
     cur = allocator->block_list;
     allocator->block_list = NULL;
+    allocator->size       = 0;
 
     while (cur) {
         chunk = WMEM_BLOCK_TO_CHUNK(cur);
@@ -1078,6 +1093,14 @@ wmem_block_gc(void *private_data)
     }
 }
 
+static size_t
+wmem_block_size(void *private_data)
+{
+    wmem_block_allocator_t *allocator = (wmem_block_allocator_t*) private_data;
+
+    return allocator->size;
+}
+
 static void
 wmem_block_allocator_cleanup(void *private_data)
 {
@@ -1102,6 +1125,7 @@ wmem_block_allocator_init(wmem_allocator_t *allocator)
 
     allocator->free_all = &wmem_block_free_all;
     allocator->gc       = &wmem_block_gc;
+    allocator->size     = &wmem_block_size;
     allocator->cleanup  = &wmem_block_allocator_cleanup;
 
     allocator->private_data = (void*) block_allocator;
@@ -1109,6 +1133,7 @@ wmem_block_allocator_init(wmem_allocator_t *allocator)
     block_allocator->block_list    = NULL;
     block_allocator->master_head   = NULL;
     block_allocator->recycler_head = NULL;
+    block_allocator->size          = 0;
 }
 
 /*
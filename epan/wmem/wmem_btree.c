@@ -0,0 +1,435 @@
+/* wmem_btree.c
+ * Wireshark Memory Manager B+Tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_btree.h"
+
+/* The values are stored in the leaves, which are all at the same depth.
+ * Each internal node with n keys has n+1 children, and child i holds the
+ * keys k with keys[i-1] <= k < keys[i]. Keys are never taken out of the
+ * tree, so the first key of every leaf but the leftmost one is equal to
+ * the key that separates it from its left sibling. */
+typedef struct _wmem_btree_node_t {
+    guint    n_keys;
+    gboolean is_leaf;
+    guint32  keys[WMEM_BTREE_NODE_KEYS];
+    union {
+        void                      *values[WMEM_BTREE_NODE_KEYS];
+        struct _wmem_btree_node_t *children[WMEM_BTREE_NODE_KEYS + 1];
+    } u;
+} wmem_btree_node_t;
+
+struct _wmem_btree_t {
+    wmem_allocator_t  *allocator;
+    wmem_btree_node_t *root;
+    gboolean           has_subtrees; /* The values are trees (array keys) */
+};
+
+wmem_btree_t *
+wmem_btree_new(wmem_allocator_t *allocator)
+{
+    wmem_btree_t *tree;
+
+    tree = wmem_new0(allocator, wmem_btree_t);
+    tree->allocator = allocator;
+
+    return tree;
+}
+
+gboolean
+wmem_btree_is_empty(wmem_btree_t *tree)
+{
+    return tree->root == NULL;
+}
+
+static gboolean
+count_values(const void *key _U_, void *value _U_, void *userdata)
+{
+    guint *count = (guint *)userdata;
+
+    (*count)++;
+
+    return FALSE;
+}
+
+guint
+wmem_btree_count(wmem_btree_t *tree)
+{
+    guint count = 0;
+
+    /* Recursing through the tree counts the values in the subtrees too;
+     * removed values are skipped by wmem_btree_foreach */
+    wmem_btree_foreach(tree, count_values, &count);
+
+    return count;
+}
+
+static wmem_btree_node_t *
+create_node(wmem_allocator_t *allocator, gboolean is_leaf)
+{
+    wmem_btree_node_t *node;
+
+    node = wmem_new(allocator, wmem_btree_node_t);
+    node->n_keys = 0;
+    node->is_leaf = is_leaf;
+
+    return node;
+}
+
+/* Returns the index of the first key that is greater than the search key,
+ * which is also the index of the child to descend into. The nodes are small
+ * enough that a linear scan is as fast as a binary search. */
+static inline guint
+node_upper_bound(const wmem_btree_node_t *node, guint32 key)
+{
+    guint i;
+
+    for (i = 0; i < node->n_keys && node->keys[i] <= key; i++)
+        ;
+
+    return i;
+}
+
+/* Inserts the key into the given leaf, splitting it if it is full. Returns
+ * the new right sibling and sets *split_key to its first key if the leaf
+ * was split, or returns NULL. */
+static wmem_btree_node_t *
+leaf_insert(wmem_allocator_t *allocator, wmem_btree_node_t *leaf,
+        guint32 key, void *data, guint32 *split_key)
+{
+    wmem_btree_node_t *right, *target;
+    guint pos, split;
+
+    pos = node_upper_bound(leaf, key);
+    if (pos > 0 && leaf->keys[pos - 1] == key) {
+        leaf->u.values[pos - 1] = data;
+        return NULL;
+    }
+
+    right = NULL;
+    target = leaf;
+    if (leaf->n_keys == WMEM_BTREE_NODE_KEYS) {
+        right = create_node(allocator, TRUE);
+        /* Keys tend to be inserted in increasing order (sequence and frame
+         * numbers), so when appending leave the full leaf as it is instead
+         * of leaving two half-empty ones behind. */
+        split = pos == leaf->n_keys ? leaf->n_keys : leaf->n_keys / 2;
+        right->n_keys = leaf->n_keys - split;
+        memcpy(right->keys, leaf->keys + split, right->n_keys * sizeof(guint32));
+        memcpy(right->u.values, leaf->u.values + split, right->n_keys * sizeof(void *));
+        leaf->n_keys = split;
+        if (pos >= split) {
+            target = right;
+            pos -= split;
+        }
+    }
+
+    memmove(target->keys + pos + 1, target->keys + pos,
+            (target->n_keys - pos) * sizeof(guint32));
+    memmove(target->u.values + pos + 1, target->u.values + pos,
+            (target->n_keys - pos) * sizeof(void *));
+    target->keys[pos] = key;
+    target->u.values[pos] = data;
+    target->n_keys++;
+
+    if (right) {
+        *split_key = right->keys[0];
+    }
+    return right;
+}
+
+/* Inserts the key into the subtree rooted at the given node. Returns the new
+ * right sibling and sets *split_key to the key separating the two if the node
+ * was split, or returns NULL. */
+static wmem_btree_node_t *
+node_insert(wmem_allocator_t *allocator, wmem_btree_node_t *node,
+        guint32 key, void *data, guint32 *split_key)
+{
+    guint32 keys[WMEM_BTREE_NODE_KEYS + 1];
+    wmem_btree_node_t *children[WMEM_BTREE_NODE_KEYS + 2];
+    wmem_btree_node_t *child_right, *right;
+    guint32 child_split_key;
+    guint pos, n_keys, split;
+
+    if (node->is_leaf) {
+        return leaf_insert(allocator, node, key, data, split_key);
+    }
+
+    pos = node_upper_bound(node, key);
+    child_right = node_insert(allocator, node->u.children[pos], key, data,
+            &child_split_key);
+    if (!child_right) {
+        return NULL;
+    }
+
+    if (node->n_keys < WMEM_BTREE_NODE_KEYS) {
+        memmove(node->keys + pos + 1, node->keys + pos,
+                (node->n_keys - pos) * sizeof(guint32));
+        memmove(node->u.children + pos + 2, node->u.children + pos + 1,
+                (node->n_keys - pos) * sizeof(wmem_btree_node_t *));
+        node->keys[pos] = child_split_key;
+        node->u.children[pos + 1] = child_right;
+        node->n_keys++;
+        return NULL;
+    }
+
+    /* The node is full: lay out the keys and children it would have... */
+    n_keys = node->n_keys;
+    memcpy(keys, node->keys, pos * sizeof(guint32));
+    keys[pos] = child_split_key;
+    memcpy(keys + pos + 1, node->keys + pos, (n_keys - pos) * sizeof(guint32));
+    memcpy(children, node->u.children, (pos + 1) * sizeof(wmem_btree_node_t *));
+    children[pos + 1] = child_right;
+    memcpy(children + pos + 2, node->u.children + pos + 1,
+            (n_keys - pos) * sizeof(wmem_btree_node_t *));
+    n_keys++;
+
+    /* ...and split them around a key that moves up to the parent, favoring
+     * the left node when appending as in leaf_insert. */
+    split = pos == node->n_keys ? n_keys - 2 : n_keys / 2;
+    right = create_node(allocator, FALSE);
+    node->n_keys = split;
+    memcpy(node->keys, keys, split * sizeof(guint32));
+    memcpy(node->u.children, children, (split + 1) * sizeof(wmem_btree_node_t *));
+    *split_key = keys[split];
+    right->n_keys = n_keys - split - 1;
+    memcpy(right->keys, keys + split + 1, right->n_keys * sizeof(guint32));
+    memcpy(right->u.children, children + split + 1,
+            (right->n_keys + 1) * sizeof(wmem_btree_node_t *));
+
+    return right;
+}
+
+void
+wmem_btree_insert32(wmem_btree_t *tree, guint32 key, void *data)
+{
+    wmem_btree_node_t *right, *root;
+    guint32 split_key;
+
+    if (!tree->root) {
+        tree->root = create_node(tree->allocator, TRUE);
+    }
+
+    right = node_insert(tree->allocator, tree->root, key, data, &split_key);
+    if (right) {
+        root = create_node(tree->allocator, FALSE);
+        root->n_keys = 1;
+        root->keys[0] = split_key;
+        root->u.children[0] = tree->root;
+        root->u.children[1] = right;
+        tree->root = root;
+    }
+}
+
+void *
+wmem_btree_lookup32(wmem_btree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *node = tree->root;
+    guint pos;
+
+    if (!node) {
+        return NULL;
+    }
+
+    while (!node->is_leaf) {
+        node = node->u.children[node_upper_bound(node, key)];
+    }
+
+    pos = node_upper_bound(node, key);
+    if (pos > 0 && node->keys[pos - 1] == key) {
+        return node->u.values[pos - 1];
+    }
+
+    return NULL;
+}
+
+void *
+wmem_btree_lookup32_le(wmem_btree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *node = tree->root;
+    wmem_btree_node_t *left = NULL;
+    guint pos;
+
+    if (!node) {
+        return NULL;
+    }
+
+    while (!node->is_leaf) {
+        pos = node_upper_bound(node, key);
+        if (pos > 0) {
+            /* The subtree holding the keys just below this one */
+            left = node->u.children[pos - 1];
+        }
+        node = node->u.children[pos];
+    }
+
+    pos = node_upper_bound(node, key);
+    if (pos > 0) {
+        return node->u.values[pos - 1];
+    }
+
+    /* All the keys in this leaf are greater than the search key, so the
+     * answer, if any, is the last key of the leaf to its left. */
+    if (!left) {
+        return NULL;
+    }
+    while (!left->is_leaf) {
+        left = left->u.children[left->n_keys];
+    }
+    return left->n_keys > 0 ? left->u.values[left->n_keys - 1] : NULL;
+}
+
+void *
+wmem_btree_remove32(wmem_btree_t *tree, guint32 key)
+{
+    void *ret = wmem_btree_lookup32(tree, key);
+    if (ret) {
+        /* Not really a remove, but set data to NULL like wmem_tree_remove32 */
+        wmem_btree_insert32(tree, key, NULL);
+    }
+    return ret;
+}
+
+void
+wmem_btree_insert32_array(wmem_btree_t *tree, wmem_tree_key_t *key, void *data)
+{
+    wmem_btree_t *insert_tree = NULL;
+    wmem_btree_t *sub_tree;
+    wmem_tree_key_t *cur_key;
+    guint32 i, insert_key32 = 0;
+
+    for (cur_key = key; cur_key->length > 0; cur_key++) {
+        for (i = 0; i < cur_key->length; i++) {
+            /* Insert using the previous key32 */
+            if (!insert_tree) {
+                insert_tree = tree;
+            } else {
+                sub_tree = (wmem_btree_t *)wmem_btree_lookup32(insert_tree, insert_key32);
+                if (!sub_tree) {
+                    sub_tree = wmem_btree_new(tree->allocator);
+                    insert_tree->has_subtrees = TRUE;
+                    wmem_btree_insert32(insert_tree, insert_key32, sub_tree);
+                }
+                insert_tree = sub_tree;
+            }
+            insert_key32 = cur_key->key[i];
+        }
+    }
+
+    g_assert(insert_tree);
+
+    wmem_btree_insert32(insert_tree, insert_key32, data);
+}
+
+static void *
+wmem_btree_lookup32_array_helper(wmem_btree_t *tree, wmem_tree_key_t *key,
+        void*(*helper)(wmem_btree_t*, guint32))
+{
+    wmem_btree_t *lookup_tree = NULL;
+    wmem_tree_key_t *cur_key;
+    guint32 i, lookup_key32 = 0;
+
+    if (!tree || !key) {
+        return NULL;
+    }
+
+    for (cur_key = key; cur_key->length > 0; cur_key++) {
+        for (i = 0; i < cur_key->length; i++) {
+            /* Lookup using the previous key32 */
+            if (!lookup_tree) {
+                lookup_tree = tree;
+            }
+            else {
+                lookup_tree =
+                    (wmem_btree_t *)(*helper)(lookup_tree, lookup_key32);
+                if (!lookup_tree) {
+                    return NULL;
+                }
+            }
+            lookup_key32 = cur_key->key[i];
+        }
+    }
+
+    /* Assert if we didn't get any valid keys */
+    g_assert(lookup_tree);
+
+    return (*helper)(lookup_tree, lookup_key32);
+}
+
+void *
+wmem_btree_lookup32_array(wmem_btree_t *tree, wmem_tree_key_t *key)
+{
+    return wmem_btree_lookup32_array_helper(tree, key, wmem_btree_lookup32);
+}
+
+void *
+wmem_btree_lookup32_array_le(wmem_btree_t *tree, wmem_tree_key_t *key)
+{
+    return wmem_btree_lookup32_array_helper(tree, key, wmem_btree_lookup32_le);
+}
+
+static gboolean
+wmem_btree_foreach_nodes(wmem_btree_t *tree, wmem_btree_node_t *node,
+        wmem_foreach_func callback, void *user_data)
+{
+    guint i;
+
+    if (!node->is_leaf) {
+        for (i = 0; i <= node->n_keys; i++) {
+            if (wmem_btree_foreach_nodes(tree, node->u.children[i], callback, user_data)) {
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+
+    for (i = 0; i < node->n_keys; i++) {
+        if (tree->has_subtrees) {
+            if (node->u.values[i] &&
+                    wmem_btree_foreach((wmem_btree_t *)node->u.values[i], callback, user_data)) {
+                return TRUE;
+            }
+        } else if (node->u.values[i] &&
+                callback(GUINT_TO_POINTER(node->keys[i]), node->u.values[i], user_data)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+gboolean
+wmem_btree_foreach(wmem_btree_t *tree, wmem_foreach_func callback,
+        void *user_data)
+{
+    if (!tree->root) {
+        return FALSE;
+    }
+
+    return wmem_btree_foreach_nodes(tree, tree->root, callback, user_data);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
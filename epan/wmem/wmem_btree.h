@@ -0,0 +1,151 @@
+/* wmem_btree.h
+ * Definitions for the Wireshark Memory Manager B+Tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WMEM_BTREE_H__
+#define __WMEM_BTREE_H__
+
+#include "wmem_core.h"
+#include "wmem_tree.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @addtogroup wmem
+ *  @{
+ *    @defgroup wmem-btree B+Tree
+ *
+ *    A B+tree keyed by guint32 values, with the same interface as the 32-bit
+ *    key functions of the red/black tree (see wmem_tree.h). Each node holds
+ *    up to WMEM_BTREE_NODE_KEYS sorted keys next to each other, so a lookup
+ *    touches a handful of nodes instead of one node per level of a binary
+ *    tree, and an insert only allocates memory when a node has to be split.
+ *    It is the better choice for large trees that are looked up for each
+ *    packet, such as the sequence number and frame number tables of the
+ *    TCP dissector.
+ *
+ *    @{
+ */
+
+/** The maximum number of keys in a node. */
+#define WMEM_BTREE_NODE_KEYS 16
+
+struct _wmem_btree_t;
+typedef struct _wmem_btree_t wmem_btree_t;
+
+/** Creates a tree with the given allocator scope. When the scope is emptied,
+ * the tree is fully destroyed. */
+WS_DLL_PUBLIC
+wmem_btree_t *
+wmem_btree_new(wmem_allocator_t *allocator)
+G_GNUC_MALLOC;
+
+/** Returns true if the tree is empty (has no nodes). */
+WS_DLL_PUBLIC
+gboolean
+wmem_btree_is_empty(wmem_btree_t *tree);
+
+/** Returns number of values in tree, not counting removed ones. */
+WS_DLL_PUBLIC
+guint
+wmem_btree_count(wmem_btree_t *tree);
+
+/** Insert a value indexed by a guint32 key value. If the key already exists
+ * in the tree its value is overwritten, as with wmem_tree_insert32.
+ */
+WS_DLL_PUBLIC
+void
+wmem_btree_insert32(wmem_btree_t *tree, guint32 key, void *data);
+
+/** Look up a value in the tree indexed by a guint32 integer value. If no value
+ * is found the function will return NULL.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32(wmem_btree_t *tree, guint32 key);
+
+/** Look up a value in the tree indexed by a guint32 integer value.
+ * Returns the value that has the largest key that is less than or equal
+ * to the search key, or NULL if no such key exists.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32_le(wmem_btree_t *tree, guint32 key);
+
+/** Remove a value in the tree indexed by a guint32 integer value. Like
+ * wmem_tree_remove32, this sets the value to NULL rather than removing the
+ * key, so that wmem_btree_lookup32 will not find it.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_remove32(wmem_btree_t *tree, guint32 key);
+
+/** Insert a value indexed by a sequence of guint32 key values. See
+ * wmem_tree_insert32_array for the format of the key and the restrictions
+ * on its length.
+ *
+ * Every key but the last one indexes a subtree, and a subtree holding a
+ * single key still takes a whole leaf node, which is several times the size
+ * of a wmem_tree node. Keys whose leading parts are mostly unique (a frame
+ * number followed by anything else, say) are better kept in a wmem_tree;
+ * use the btree when the subtrees are well populated.
+ */
+WS_DLL_PUBLIC
+void
+wmem_btree_insert32_array(wmem_btree_t *tree, wmem_tree_key_t *key, void *data);
+
+/** Look up a value in the tree indexed by a sequence of guint32 integer
+ * values. See wmem_tree_insert32_array for details on the key.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32_array(wmem_btree_t *tree, wmem_tree_key_t *key);
+
+/** Look up a value in the tree indexed by a multi-part tree value, returning
+ * the one that has the largest key that is equal to or smaller than the
+ * search key, or NULL if no such key was found. See
+ * wmem_tree_lookup32_array_le for the caveats.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32_array_le(wmem_btree_t *tree, wmem_tree_key_t *key);
+
+/** Traverse the tree in key order and call callback(key, value, userdata) for
+ * each value found, where key is the guint32 key cast with GUINT_TO_POINTER.
+ * Removed (NULL) values are skipped.
+ *
+ * Returns TRUE if the traversal was ended prematurely by the callback.
+ */
+WS_DLL_PUBLIC
+gboolean
+wmem_btree_foreach(wmem_btree_t *tree, wmem_foreach_func callback,
+        void *user_data);
+
+/**   @}
+ *  @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_BTREE_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -116,6 +116,16 @@ wmem_gc(wmem_allocator_t *allocator)
     allocator->gc(allocator->private_data);
 }
 
+size_t
+wmem_allocator_size(wmem_allocator_t *allocator)
+{
+    if (allocator->size) {
+        return allocator->size(allocator->private_data);
+    }
+
+    return 0;
+}
+
 void
 wmem_destroy_allocator(wmem_allocator_t *allocator)
 {
@@ -142,6 +152,7 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     allocator->type      = real_type;
     allocator->callbacks = NULL;
     allocator->in_scope  = TRUE;
+    allocator->size      = NULL;
 
     switch (real_type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -176,6 +176,17 @@ WS_DLL_PUBLIC
 void
 wmem_gc(wmem_allocator_t *allocator);
 
+/** Get how much memory the allocator is holding, including memory that
+ * has been freed but not yet returned to the operating system by wmem_gc().
+ *
+ * @param allocator The allocator to get the size of.
+ * @return The size in bytes, or 0 if the allocator doesn't keep track of it
+ *         (only block allocators do).
+ */
+WS_DLL_PUBLIC
+size_t
+wmem_allocator_size(wmem_allocator_t *allocator);
+
 /** Destroy the given allocator, freeing all memory allocated in it. Once this
  * function has been called, no memory allocated with the allocator is valid.
  *
@@ -43,6 +43,7 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
     allocator->type = type;
     allocator->callbacks = NULL;
     allocator->in_scope = TRUE;
+    allocator->size = NULL;
 
     switch (type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -337,12 +338,54 @@ wmem_test_allocator(wmem_allocator_type_t type, wmem_verify_func verify,
     wmem_destroy_allocator(allocator);
 }
 
+static void
+wmem_test_allocator_size(void)
+{
+    wmem_allocator_t *allocator;
+    char *ptr;
+    size_t size;
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_BLOCK);
+    g_assert(wmem_allocator_size(allocator) == 0);
+
+    /* A block from the OS */
+    wmem_alloc(allocator, 8);
+    size = wmem_allocator_size(allocator);
+    g_assert(size > 0);
+
+    /* Jumbo allocations are counted, and resized */
+    ptr = (char *)wmem_alloc(allocator, 10*1024*1024);
+    g_assert(wmem_allocator_size(allocator) > size + 10*1024*1024);
+    ptr = (char *)wmem_realloc(allocator, ptr, 20*1024*1024);
+    g_assert(wmem_allocator_size(allocator) > size + 20*1024*1024);
+    g_assert(wmem_allocator_size(allocator) < size + 21*1024*1024);
+    wmem_free(allocator, ptr);
+    g_assert(wmem_allocator_size(allocator) == size);
+    wmem_block_verify(allocator);
+
+    /* Blocks are kept until they're returned to the OS */
+    wmem_free_all(allocator);
+    g_assert(wmem_allocator_size(allocator) == size);
+    wmem_gc(allocator);
+    g_assert(wmem_allocator_size(allocator) == 0);
+    wmem_block_verify(allocator);
+
+    wmem_destroy_allocator(allocator);
+
+    /* Other allocators don't keep track */
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_SIMPLE);
+    wmem_alloc(allocator, 8);
+    g_assert(wmem_allocator_size(allocator) == 0);
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_allocator_block(void)
 {
     wmem_test_allocator(WMEM_ALLOCATOR_BLOCK, &wmem_block_verify,
             MAX_SIMULTANEOUS_ALLOCS*64);
     wmem_test_allocator_jumbo(WMEM_ALLOCATOR_BLOCK, &wmem_block_verify);
+    wmem_test_allocator_size();
 }
 
 static void
@@ -1331,6 +1374,407 @@ wmem_test_tree(void)
 }
 
 
+static gboolean
+wmem_test_btree_order_cb(const void *key, void *value, void *user_data)
+{
+    guint32 *last_key = (guint32 *)user_data;
+
+    g_assert(cb_called_count == 0 || GPOINTER_TO_UINT(key) > *last_key);
+    g_assert(value != NULL);
+    *last_key = GPOINTER_TO_UINT(key);
+    cb_called_count++;
+
+    return FALSE;
+}
+
+/* The values are offset by one, as NULL (removed) values are skipped */
+static gboolean
+wmem_test_btree_foreach_cb(const void *key, void *value, void *user_data)
+{
+    return wmem_test_foreach_cb(key, GINT_TO_POINTER(GPOINTER_TO_INT(value) - 1), user_data);
+}
+
+static void
+wmem_test_btree(void)
+{
+    wmem_allocator_t   *allocator;
+    wmem_btree_t       *tree;
+    guint32             i, last_key;
+    int                 seen_values = 0;
+    int                 j;
+    int                 key_count;
+    wmem_tree_key_t     keys[WMEM_TREE_MAX_KEY_COUNT];
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    tree = wmem_btree_new(allocator);
+    g_assert(tree);
+    g_assert(wmem_btree_is_empty(tree));
+    g_assert(wmem_btree_lookup32(tree, 0) == NULL);
+    g_assert(wmem_btree_lookup32_le(tree, 0) == NULL);
+
+    /* test basic 32-bit key operations, in increasing... */
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_btree_lookup32(tree, i*2) == NULL);
+        if (i > 0) {
+            g_assert(wmem_btree_lookup32_le(tree, i*2) == GINT_TO_POINTER(i));
+        }
+        wmem_btree_insert32(tree, i*2, GINT_TO_POINTER(i+1));
+        g_assert(wmem_btree_lookup32(tree, i*2) == GINT_TO_POINTER(i+1));
+        g_assert(!wmem_btree_is_empty(tree));
+    }
+    g_assert(wmem_btree_count(tree) == CONTAINER_ITERS);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_btree_lookup32(tree, i*2) == GINT_TO_POINTER(i+1));
+        g_assert(wmem_btree_lookup32(tree, i*2+1) == NULL);
+        g_assert(wmem_btree_lookup32_le(tree, i*2+1) == GINT_TO_POINTER(i+1));
+    }
+    wmem_free_all(allocator);
+
+    /* ...decreasing... */
+    tree = wmem_btree_new(allocator);
+    for (i=CONTAINER_ITERS; i>0; i--) {
+        wmem_btree_insert32(tree, i*2, GINT_TO_POINTER(i));
+        g_assert(wmem_btree_lookup32(tree, i*2) == GINT_TO_POINTER(i));
+        g_assert(wmem_btree_lookup32_le(tree, i*2-1) == NULL);
+    }
+    for (i=1; i<=CONTAINER_ITERS; i++) {
+        g_assert(wmem_btree_lookup32(tree, i*2) == GINT_TO_POINTER(i));
+        g_assert(wmem_btree_lookup32_le(tree, i*2+1) == GINT_TO_POINTER(i));
+    }
+    wmem_free_all(allocator);
+
+    /* ...and random order, checking against the red/black tree */
+    {
+        wmem_tree_t *rb_tree = wmem_tree_new(allocator);
+
+        tree = wmem_btree_new(allocator);
+        for (i=0; i<CONTAINER_ITERS; i++) {
+            guint32 rand_int = g_test_rand_int_range(0, CONTAINER_ITERS * 4);
+            wmem_btree_insert32(tree, rand_int, GINT_TO_POINTER(i+1));
+            wmem_tree_insert32(rb_tree, rand_int, GINT_TO_POINTER(i+1));
+            g_assert(wmem_btree_lookup32(tree, rand_int) == GINT_TO_POINTER(i+1));
+        }
+        g_assert(wmem_btree_count(tree) == wmem_tree_count(rb_tree));
+        for (i=0; i<CONTAINER_ITERS * 4; i++) {
+            g_assert(wmem_btree_lookup32(tree, i) == wmem_tree_lookup32(rb_tree, i));
+            g_assert(wmem_btree_lookup32_le(tree, i) == wmem_tree_lookup32_le(rb_tree, i));
+        }
+        wmem_free_all(allocator);
+    }
+
+    /* test remove functionality */
+    tree = wmem_btree_new(allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        wmem_btree_insert32(tree, i, GINT_TO_POINTER(i+1));
+    }
+    for (i=0; i<CONTAINER_ITERS; i+=2) {
+        g_assert(wmem_btree_remove32(tree, i) == GINT_TO_POINTER(i+1));
+        g_assert(wmem_btree_lookup32(tree, i) == NULL);
+        g_assert(wmem_btree_remove32(tree, i) == NULL);
+        g_assert(wmem_btree_lookup32(tree, i+1) == GINT_TO_POINTER(i+2));
+    }
+    g_assert(wmem_btree_count(tree) == CONTAINER_ITERS/2);
+    cb_called_count = 0;
+    last_key = 0;
+    wmem_btree_foreach(tree, wmem_test_btree_order_cb, &last_key);
+    g_assert(cb_called_count == CONTAINER_ITERS/2);
+    wmem_free_all(allocator);
+
+    /* test array key functionality */
+    tree = wmem_btree_new(allocator);
+    key_count = g_random_int_range(1, WMEM_TREE_MAX_KEY_COUNT);
+    for (j=0; j<key_count; j++) {
+        keys[j].length = g_random_int_range(1, WMEM_TREE_MAX_KEY_LEN);
+    }
+    keys[key_count].length = 0;
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        for (j=0; j<key_count; j++) {
+            keys[j].key    = (guint32*)wmem_test_rand_string(allocator,
+                    (keys[j].length*4), (keys[j].length*4)+1);
+        }
+        wmem_btree_insert32_array(tree, keys, GINT_TO_POINTER(i));
+        g_assert(wmem_btree_lookup32_array(tree, keys) == GINT_TO_POINTER(i));
+    }
+    wmem_free_all(allocator);
+
+    tree = wmem_btree_new(allocator);
+    keys[0].length = 1;
+    keys[0].key    = wmem_new(allocator, guint32);
+    *(keys[0].key) = 0;
+    keys[1].length = 0;
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        wmem_btree_insert32_array(tree, keys, GINT_TO_POINTER(i));
+        *(keys[0].key) += 4;
+    }
+    *(keys[0].key) = 0;
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_btree_lookup32_array(tree, keys) == GINT_TO_POINTER(i));
+        for (j=0; j<3; j++) {
+            (*(keys[0].key)) += 1;
+            g_assert(wmem_btree_lookup32_array_le(tree, keys) ==
+                    GINT_TO_POINTER(i));
+        }
+        *(keys[0].key) += 1;
+    }
+    wmem_free_all(allocator);
+
+    /* test for-each functionality */
+    tree = wmem_btree_new(allocator);
+    expected_user_data = GINT_TO_POINTER(g_test_rand_int());
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        gint tmp;
+        do {
+            tmp = g_test_rand_int();
+        } while (wmem_btree_lookup32(tree, tmp));
+        value_seen[i] = FALSE;
+        wmem_btree_insert32(tree, tmp, GINT_TO_POINTER(i+1));
+    }
+
+    cb_called_count    = 0;
+    cb_continue_count  = CONTAINER_ITERS;
+    wmem_btree_foreach(tree, wmem_test_btree_foreach_cb, expected_user_data);
+    g_assert(cb_called_count   == CONTAINER_ITERS);
+    g_assert(cb_continue_count == 0);
+
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(value_seen[i]);
+        value_seen[i] = FALSE;
+    }
+
+    cb_called_count    = 0;
+    cb_continue_count  = 10;
+    wmem_btree_foreach(tree, wmem_test_btree_foreach_cb, expected_user_data);
+    g_assert(cb_called_count   == 10);
+    g_assert(cb_continue_count == 0);
+
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        if (value_seen[i]) {
+            seen_values++;
+        }
+    }
+    g_assert(seen_values == 10);
+
+    /* the traversal is in key order */
+    cb_called_count = 0;
+    last_key        = 0;
+    wmem_btree_foreach(tree, wmem_test_btree_order_cb, &last_key);
+    g_assert(cb_called_count == CONTAINER_ITERS);
+
+    wmem_destroy_allocator(allocator);
+}
+
+/* NOTE: You have to run "wmem_test --verbose" to see results. */
+static void
+wmem_test_btree_perf(void)
+{
+#define TREE_PERF_KEYS      (100 * 1000)
+#define TREE_PERF_LOOKUPS   (1000 * 1000)
+    wmem_allocator_t   *allocator;
+    wmem_tree_t        *rb_tree;
+    wmem_btree_t       *btree;
+    guint32            *keys = g_new(guint32, TREE_PERF_KEYS);
+    guint32             i;
+    guint               found;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    /* Sequence numbers of a TCP stream: increasing, with gaps */
+    keys[0] = g_test_rand_int_range(0, G_MAXINT32);
+    for (i = 1; i < TREE_PERF_KEYS; i++) {
+        keys[i] = keys[i-1] + g_test_rand_int_range(1, 1460);
+    }
+
+    RESOURCE_USAGE_START;
+    rb_tree = wmem_tree_new(allocator);
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        wmem_tree_insert32(rb_tree, keys[i], GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_insert32 %u keys: u %.3f ms s %.3f ms", TREE_PERF_KEYS, utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    btree = wmem_btree_new(allocator);
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        wmem_btree_insert32(btree, keys[i], GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree_insert32 %u keys: u %.3f ms s %.3f ms", TREE_PERF_KEYS, utime_ms, stime_ms);
+
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_LOOKUPS; i++) {
+        if (wmem_tree_lookup32_le(rb_tree, keys[i % TREE_PERF_KEYS] + 1)) {
+            found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_assert(found == TREE_PERF_LOOKUPS);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32_le %u lookups: u %.3f ms s %.3f ms", TREE_PERF_LOOKUPS, utime_ms, stime_ms);
+
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_LOOKUPS; i++) {
+        if (wmem_btree_lookup32_le(btree, keys[i % TREE_PERF_KEYS] + 1)) {
+            found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_assert(found == TREE_PERF_LOOKUPS);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree_lookup32_le %u lookups: u %.3f ms s %.3f ms", TREE_PERF_LOOKUPS, utime_ms, stime_ms);
+
+    /* Random lookups, as when the frames are visited out of order */
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_LOOKUPS; i++) {
+        if (wmem_tree_lookup32(rb_tree, keys[g_test_rand_int_range(0, TREE_PERF_KEYS)])) {
+            found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_assert(found == TREE_PERF_LOOKUPS);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32 %u random lookups: u %.3f ms s %.3f ms", TREE_PERF_LOOKUPS, utime_ms, stime_ms);
+
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_LOOKUPS; i++) {
+        if (wmem_btree_lookup32(btree, keys[g_test_rand_int_range(0, TREE_PERF_KEYS)])) {
+            found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_assert(found == TREE_PERF_LOOKUPS);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree_lookup32 %u random lookups: u %.3f ms s %.3f ms", TREE_PERF_LOOKUPS, utime_ms, stime_ms);
+
+    g_free(keys);
+    wmem_destroy_allocator(allocator);
+}
+
+
+/* Counts what is allocated from the allocator handed to
+ * wmem_test_count_allocs, so that the perf tests can report memory use. */
+static void *(*wmem_test_counted_walloc)(void *private_data, const size_t size);
+static size_t wmem_test_counted_bytes;
+
+static void *
+wmem_test_counting_alloc(void *private_data, const size_t size)
+{
+    wmem_test_counted_bytes += size;
+    return wmem_test_counted_walloc(private_data, size);
+}
+
+static void
+wmem_test_count_allocs(wmem_allocator_t *allocator)
+{
+    wmem_test_counted_walloc = allocator->walloc;
+    allocator->walloc = &wmem_test_counting_alloc;
+    wmem_test_counted_bytes = 0;
+}
+
+/* NOTE: You have to run "wmem_test --verbose" to see results. */
+static void
+wmem_test_btree_array_perf(void)
+{
+    wmem_allocator_t   *allocator;
+    wmem_tree_t        *rb_tree;
+    wmem_btree_t       *btree;
+    wmem_tree_key_t     key[4];
+    guint32             frame, seq, ack;
+    guint32            *seqs = g_new(guint32, TREE_PERF_KEYS);
+    guint32             i;
+    guint               found;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    /* Laid out like the TCP acked table: frame, then seq, then ack, so
+     * every frame gets a subtree holding a single seq, and every seq one
+     * holding a single ack. */
+    key[0].length = 1;
+    key[0].key = &frame;
+    key[1].length = 1;
+    key[1].key = &seq;
+    key[2].length = 1;
+    key[2].key = &ack;
+    key[3].length = 0;
+    key[3].key = NULL;
+
+    seqs[0] = g_test_rand_int_range(0, G_MAXINT32);
+    for (i = 1; i < TREE_PERF_KEYS; i++) {
+        seqs[i] = seqs[i-1] + g_test_rand_int_range(1, 1460);
+    }
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_SIMPLE);
+    wmem_test_count_allocs(allocator);
+    RESOURCE_USAGE_START;
+    rb_tree = wmem_tree_new(allocator);
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        frame = i + 1;
+        seq = seqs[i];
+        ack = seqs[i] / 2;
+        wmem_tree_insert32_array(rb_tree, key, GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_insert32_array %u 3-part keys: u %.3f ms s %.3f ms, %" G_GSIZE_FORMAT " bytes",
+        TREE_PERF_KEYS, utime_ms, stime_ms, wmem_test_counted_bytes);
+
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        frame = i + 1;
+        seq = seqs[i];
+        ack = seqs[i] / 2;
+        if (wmem_tree_lookup32_array(rb_tree, key)) {
+            found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_assert(found == TREE_PERF_KEYS);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32_array %u 3-part keys: u %.3f ms s %.3f ms", TREE_PERF_KEYS, utime_ms, stime_ms);
+    wmem_destroy_allocator(allocator);
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_SIMPLE);
+    wmem_test_count_allocs(allocator);
+    RESOURCE_USAGE_START;
+    btree = wmem_btree_new(allocator);
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        frame = i + 1;
+        seq = seqs[i];
+        ack = seqs[i] / 2;
+        wmem_btree_insert32_array(btree, key, GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree_insert32_array %u 3-part keys: u %.3f ms s %.3f ms, %" G_GSIZE_FORMAT " bytes",
+        TREE_PERF_KEYS, utime_ms, stime_ms, wmem_test_counted_bytes);
+
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        frame = i + 1;
+        seq = seqs[i];
+        ack = seqs[i] / 2;
+        if (GPOINTER_TO_UINT(wmem_btree_lookup32_array(btree, key)) == i + 1) {
+            found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_assert(found == TREE_PERF_KEYS);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree_lookup32_array %u 3-part keys: u %.3f ms s %.3f ms", TREE_PERF_KEYS, utime_ms, stime_ms);
+    wmem_destroy_allocator(allocator);
+
+    g_free(seqs);
+}
+
+
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
     wmem_range_t range;
@@ -1453,6 +1897,8 @@ main(int argc, char **argv)
 
     if (!g_test_perf ()) {
         g_test_add_func("/wmem/utils/stringperf", wmem_test_stringperf);
+        g_test_add_func("/wmem/datastruct/btreeperf", wmem_test_btree_perf);
+        g_test_add_func("/wmem/datastruct/btreearrayperf", wmem_test_btree_array_perf);
     }
 
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
@@ -1462,6 +1908,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/stack",  wmem_test_stack);
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
+    g_test_add_func("/wmem/datastruct/btree",  wmem_test_btree);
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
 
     ret = g_test_run();
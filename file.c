@@ -21,6 +21,7 @@
 #include <wsutil/file_util.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/json_dumper.h>
+#include <wsutil/ws_memmem.h>
 #include <version_info.h>
 
 #include <wiretap/merge.h>
@@ -48,6 +49,7 @@
 #include "frame_tvbuff.h"
 
 #include "ui/alert_box.h"
+#include "ui/filter_results.h"
 #include "ui/simple_dialog.h"
 #include "ui/main_statusbar.h"
 #include "ui/progress_dlg.h"
@@ -93,8 +95,6 @@ static match_result match_narrow(capture_file *cf, frame_data *fdata,
     wtap_rec *, Buffer *, void *criterion);
 static match_result match_wide(capture_file *cf, frame_data *fdata,
     wtap_rec *, Buffer *, void *criterion);
-static match_result match_binary(capture_file *cf, frame_data *fdata,
-    wtap_rec *, Buffer *, void *criterion);
 static match_result match_regex(capture_file *cf, frame_data *fdata,
     wtap_rec *, Buffer *, void *criterion);
 static match_result match_dfilter(capture_file *cf, frame_data *fdata,
@@ -107,6 +107,9 @@ static gboolean find_packet(capture_file *cf, ws_match_function match_function,
     void *criterion, search_direction dir);
 
 static void cf_rename_failure_alert_box(const char *filename, int err);
+static void cf_new_ipv4(const guint addr, const gchar *name);
+static void cf_new_ipv6(const void *addrp, const gchar *name);
+static void cf_new_secrets(guint32 secrets_type, const void *secrets, guint size);
 static void ref_time_packets(capture_file *cf);
 
 /* Seconds spent processing packets between pushing UI updates. */
@@ -249,7 +252,8 @@ ws_epan_new(capture_file *cf)
     ws_get_frame_ts,
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
-    cap_file_provider_get_user_comment
+    cap_file_provider_get_user_comment,
+    cap_file_provider_get_shift_offset
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -325,9 +329,9 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   packet_list_queue_draw();
   cf_callback_invoke(cf_cb_file_opened, cf);
 
-  wtap_set_cb_new_ipv4(cf->provider.wth, add_ipv4_name);
-  wtap_set_cb_new_ipv6(cf->provider.wth, (wtap_new_ipv6_callback_t) add_ipv6_name);
-  wtap_set_cb_new_secrets(cf->provider.wth, secrets_wtap_callback);
+  wtap_set_cb_new_ipv4(cf->provider.wth, cf_new_ipv4);
+  wtap_set_cb_new_ipv6(cf->provider.wth, cf_new_ipv6);
+  wtap_set_cb_new_secrets(cf->provider.wth, cf_new_secrets);
 
   return CF_OK;
 
@@ -368,6 +372,7 @@ cf_close(capture_file *cf)
 
   /* close things, if not already closed before */
   color_filters_cleanup();
+  filter_results_clear(&cf->filter_results);
 
   if (cf->provider.wth) {
     wtap_close(cf->provider.wth);
@@ -408,6 +413,10 @@ cf_close(capture_file *cf)
     g_tree_destroy(cf->provider.frames_user_comments);
     cf->provider.frames_user_comments = NULL;
   }
+  if (cf->provider.frames_shift_offsets) {
+    g_tree_destroy(cf->provider.frames_shift_offsets);
+    cf->provider.frames_shift_offsets = NULL;
+  }
   cf_unselect_packet(cf);   /* nothing to select */
   cf->first_displayed = 0;
   cf->last_displayed = 0;
@@ -488,6 +497,265 @@ calc_progbar_val(capture_file *cf, gint64 size, gint64 file_pos, gchar *status_s
   return progbar_val;
 }
 
+/*
+ * Reading ahead.
+ *
+ * While cf_read() dissects a record, a reader thread does the wiretap
+ * I/O and decompression for the records after it. Records are handed
+ * over through a ring of CF_READ_AHEAD slots, consumed strictly in file
+ * order, so dissection sees exactly what a serial read would have given
+ * it.
+ *
+ * Dissection stays on the main thread, as epan isn't thread-safe. So do
+ * the name resolution and decryption secrets blocks that wiretap reports
+ * through callbacks while reading: the reader thread attaches them to
+ * the slot being filled, and cf_read() hands them on to epan just before
+ * dissecting that slot's record. Everything else that touches the wtap
+ * handle while the reader is running (random access reads and interface
+ * lookups) holds provider.wth_mutex, which the reader holds while reading.
+ */
+#define CF_READ_AHEAD 256
+
+typedef enum {
+  READ_AHEAD_NEW_IPV4,
+  READ_AHEAD_NEW_IPV6,
+  READ_AHEAD_NEW_SECRETS
+} read_ahead_event_type_t;
+
+typedef struct {
+  read_ahead_event_type_t type;
+  guint32   value;            /* IPv4 address or secrets type */
+  guint8   *data;             /* IPv6 address or secrets */
+  guint     size;
+  gchar    *name;
+} read_ahead_event_t;
+
+typedef struct {
+  wtap_rec  rec;
+  Buffer    buf;
+  gint64    data_offset;
+  gint64    file_pos;         /* wtap_read_so_far() after reading it */
+  gboolean  ok;               /* FALSE if this is where reading stopped */
+  int       err;
+  gchar    *err_info;
+  GSList   *events;           /* read_ahead_event_t, newest first */
+} read_ahead_slot_t;
+
+typedef struct {
+  capture_file      *cf;
+  read_ahead_slot_t  slots[CF_READ_AHEAD];
+  guint32            next_read;     /* records read so far */
+  guint32            next_consume;  /* records handed back so far */
+  gboolean           stop;
+  GMutex             lock;
+  GCond              cond;
+  GMutex             wth_mutex;
+  GThread           *thread;
+} read_ahead_t;
+
+/* The slot the current thread is reading into, if it's the reader. */
+static GPrivate read_ahead_filling = G_PRIVATE_INIT(NULL);
+
+static void
+read_ahead_add_event(read_ahead_slot_t *slot, read_ahead_event_type_t type,
+                     guint32 value, const void *data, guint size,
+                     const gchar *name)
+{
+  read_ahead_event_t *event = g_new(read_ahead_event_t, 1);
+
+  event->type = type;
+  event->value = value;
+  event->data = (guint8 *)g_memdup(data, size);
+  event->size = size;
+  event->name = g_strdup(name);
+  slot->events = g_slist_prepend(slot->events, event);
+}
+
+static void
+cf_new_ipv4(const guint addr, const gchar *name)
+{
+  read_ahead_slot_t *slot = (read_ahead_slot_t *)g_private_get(&read_ahead_filling);
+
+  if (slot != NULL)
+    read_ahead_add_event(slot, READ_AHEAD_NEW_IPV4, addr, NULL, 0, name);
+  else
+    add_ipv4_name(addr, name);
+}
+
+static void
+cf_new_ipv6(const void *addrp, const gchar *name)
+{
+  read_ahead_slot_t *slot = (read_ahead_slot_t *)g_private_get(&read_ahead_filling);
+
+  if (slot != NULL)
+    read_ahead_add_event(slot, READ_AHEAD_NEW_IPV6, 0, addrp, sizeof (ws_in6_addr), name);
+  else
+    add_ipv6_name((const ws_in6_addr *)addrp, name);
+}
+
+static void
+cf_new_secrets(guint32 secrets_type, const void *secrets, guint size)
+{
+  read_ahead_slot_t *slot = (read_ahead_slot_t *)g_private_get(&read_ahead_filling);
+
+  if (slot != NULL)
+    read_ahead_add_event(slot, READ_AHEAD_NEW_SECRETS, secrets_type, secrets, size, NULL);
+  else
+    secrets_wtap_callback(secrets_type, secrets, size);
+}
+
+/*
+ * Pass what the reader found while reading a slot's record on to epan,
+ * in the order it was found.
+ */
+static void
+read_ahead_deliver_events(read_ahead_slot_t *slot)
+{
+  GSList             *item;
+  read_ahead_event_t *event;
+
+  slot->events = g_slist_reverse(slot->events);
+  for (item = slot->events; item != NULL; item = g_slist_next(item)) {
+    event = (read_ahead_event_t *)item->data;
+    switch (event->type) {
+
+    case READ_AHEAD_NEW_IPV4:
+      add_ipv4_name(event->value, event->name);
+      break;
+
+    case READ_AHEAD_NEW_IPV6:
+      add_ipv6_name((const ws_in6_addr *)event->data, event->name);
+      break;
+
+    case READ_AHEAD_NEW_SECRETS:
+      secrets_wtap_callback(event->value, event->data, event->size);
+      break;
+    }
+    g_free(event->data);
+    g_free(event->name);
+    g_free(event);
+  }
+  g_slist_free(slot->events);
+  slot->events = NULL;
+}
+
+static gpointer
+read_ahead_thread(gpointer data)
+{
+  read_ahead_t      *ra = (read_ahead_t *)data;
+  read_ahead_slot_t *slot;
+  guint32            seq;
+  gboolean           ok;
+
+  for (seq = 0; ; seq++) {
+    g_mutex_lock(&ra->lock);
+    while (!ra->stop && seq - ra->next_consume >= CF_READ_AHEAD)
+      g_cond_wait(&ra->cond, &ra->lock);
+    if (ra->stop) {
+      g_mutex_unlock(&ra->lock);
+      break;
+    }
+    g_mutex_unlock(&ra->lock);
+
+    slot = &ra->slots[seq % CF_READ_AHEAD];
+    slot->err = 0;
+    slot->err_info = NULL;
+    g_private_set(&read_ahead_filling, slot);
+    g_mutex_lock(&ra->wth_mutex);
+    ok = wtap_read(ra->cf->provider.wth, &slot->rec, &slot->buf, &slot->err,
+                   &slot->err_info, &slot->data_offset);
+    slot->file_pos = wtap_read_so_far(ra->cf->provider.wth);
+    g_mutex_unlock(&ra->wth_mutex);
+    g_private_set(&read_ahead_filling, NULL);
+    slot->ok = ok;
+
+    g_mutex_lock(&ra->lock);
+    ra->next_read = seq + 1;
+    g_cond_broadcast(&ra->cond);
+    g_mutex_unlock(&ra->lock);
+
+    if (!ok)
+      break;
+  }
+  return NULL;
+}
+
+/*
+ * Wait for the reader to fill the slot for the seq'th record and
+ * return it.
+ */
+static read_ahead_slot_t *
+read_ahead_get(read_ahead_t *ra, guint32 seq)
+{
+  g_mutex_lock(&ra->lock);
+  while (ra->next_read <= seq)
+    g_cond_wait(&ra->cond, &ra->lock);
+  g_mutex_unlock(&ra->lock);
+  return &ra->slots[seq % CF_READ_AHEAD];
+}
+
+/*
+ * Hand the slot for the seq'th record back to the reader.
+ */
+static void
+read_ahead_release(read_ahead_t *ra, guint32 seq)
+{
+  g_mutex_lock(&ra->lock);
+  ra->next_consume = seq + 1;
+  g_cond_broadcast(&ra->cond);
+  g_mutex_unlock(&ra->lock);
+}
+
+static read_ahead_t *
+read_ahead_start(capture_file *cf)
+{
+  read_ahead_t *ra = g_new0(read_ahead_t, 1);
+  guint         i;
+
+  ra->cf = cf;
+  for (i = 0; i < CF_READ_AHEAD; i++) {
+    wtap_rec_init(&ra->slots[i].rec);
+    ws_buffer_init(&ra->slots[i].buf, 1514);
+  }
+  g_mutex_init(&ra->lock);
+  g_cond_init(&ra->cond);
+  g_mutex_init(&ra->wth_mutex);
+  cf->provider.wth_mutex = &ra->wth_mutex;
+
+  ra->thread = g_thread_new("cf_read read-ahead", read_ahead_thread, ra);
+  return ra;
+}
+
+static void
+read_ahead_finish(read_ahead_t *ra)
+{
+  guint32 seq;
+  guint   i;
+
+  g_mutex_lock(&ra->lock);
+  ra->stop = TRUE;
+  g_cond_broadcast(&ra->cond);
+  g_mutex_unlock(&ra->lock);
+  g_thread_join(ra->thread);
+
+  ra->cf->provider.wth_mutex = NULL;
+
+  /* Name resolution and secrets read past where we stopped are still
+     worth having. */
+  for (seq = ra->next_consume; seq != ra->next_read; seq++)
+    read_ahead_deliver_events(&ra->slots[seq % CF_READ_AHEAD]);
+
+  for (i = 0; i < CF_READ_AHEAD; i++) {
+    g_free(ra->slots[i].err_info);
+    ws_buffer_free(&ra->slots[i].buf);
+    wtap_rec_cleanup(&ra->slots[i].rec);
+  }
+  g_mutex_clear(&ra->wth_mutex);
+  g_cond_clear(&ra->cond);
+  g_mutex_clear(&ra->lock);
+  g_free(ra);
+}
+
 cf_read_status_t
 cf_read(capture_file *cf, gboolean reloading)
 {
@@ -500,8 +768,7 @@ cf_read(capture_file *cf, gboolean reloading)
   gint64               size;
   gint64               start_time;
   epan_dissect_t       edt;
-  wtap_rec             rec;
-  Buffer               buf;
+  read_ahead_t        *ra;
   dfilter_t           *dfcode;
   column_info         *cinfo;
   volatile gboolean    create_proto_tree;
@@ -577,20 +844,27 @@ cf_read(capture_file *cf, gboolean reloading)
 
   g_timer_start(prog_timer);
 
-  wtap_rec_init(&rec);
-  ws_buffer_init(&buf, 1514);
+  ra = read_ahead_start(cf);
 
   TRY {
     guint32 count             = 0;
 
     gint64  file_pos;
-    gint64  data_offset;
+    guint32 seq;
+    read_ahead_slot_t *slot;
 
     float   progbar_val;
     gchar   status_str[100];
 
-    while ((wtap_read(cf->provider.wth, &rec, &buf, &err, &err_info,
-            &data_offset))) {
+    for (seq = 0; ; seq++) {
+      slot = read_ahead_get(ra, seq);
+      read_ahead_deliver_events(slot);
+      if (!slot->ok) {
+        err = slot->err;
+        err_info = slot->err_info;
+        slot->err_info = NULL;
+        break;
+      }
       if (size >= 0) {
         if (cf->count == max_records) {
             /*
@@ -601,7 +875,7 @@ cf_read(capture_file *cf, gboolean reloading)
             break;
         }
         count++;
-        file_pos = wtap_read_so_far(cf->provider.wth);
+        file_pos = slot->file_pos;
 
         /* Create the progress bar if necessary. */
         if (progress_is_slow(progbar, prog_timer, size, file_pos)) {
@@ -649,7 +923,8 @@ cf_read(capture_file *cf, gboolean reloading)
            hours even on fast machines) just to see that it was the wrong file. */
         break;
       }
-      read_record(cf, &rec, &buf, dfcode, &edt, cinfo, data_offset);
+      read_record(cf, &slot->rec, &slot->buf, dfcode, &edt, cinfo, slot->data_offset);
+      read_ahead_release(ra, seq);
     }
   }
   CATCH(OutOfMemoryError) {
@@ -666,6 +941,8 @@ cf_read(capture_file *cf, gboolean reloading)
   }
   ENDTRY;
 
+  read_ahead_finish(ra);
+
   /* We're done reading sequentially through the file. */
   cf->state = FILE_READ_DONE;
 
@@ -681,8 +958,6 @@ cf_read(capture_file *cf, gboolean reloading)
   dfilter_free(dfcode);
 
   epan_dissect_cleanup(&edt);
-  wtap_rec_cleanup(&rec);
-  ws_buffer_free(&buf);
 
   /* Close the sequential I/O side, to free up memory it requires. */
   wtap_sequential_close(cf->provider.wth);
@@ -1555,6 +1830,8 @@ cf_filter_packets(capture_file *cf, gchar *dftext, gboolean force)
 void
 cf_reftime_packets(capture_file *cf)
 {
+  /* Relative times of frames change; so might what filters make of them. */
+  filter_results_clear(&cf->filter_results);
   ref_time_packets(cf);
 }
 
@@ -1580,6 +1857,20 @@ cf_redissect_packets(capture_file *cf)
   }
 }
 
+static gboolean
+cf_seek_read(capture_file *cf, const frame_data *fdata, wtap_rec *rec,
+             Buffer *buf, int *err, gchar **err_info)
+{
+  gboolean ok;
+
+  if (cf->provider.wth_mutex)
+    g_mutex_lock(cf->provider.wth_mutex);
+  ok = wtap_seek_read(cf->provider.wth, fdata->file_off, rec, buf, err, err_info);
+  if (cf->provider.wth_mutex)
+    g_mutex_unlock(cf->provider.wth_mutex);
+  return ok;
+}
+
 gboolean
 cf_read_record(capture_file *cf, const frame_data *fdata,
                  wtap_rec *rec, Buffer *buf)
@@ -1587,7 +1878,7 @@ cf_read_record(capture_file *cf, const frame_data *fdata,
   int    err;
   gchar *err_info;
 
-  if (!wtap_seek_read(cf->provider.wth, fdata->file_off, rec, buf, &err, &err_info)) {
+  if (!cf_seek_read(cf, fdata, rec, buf, &err, &err_info)) {
     cfile_read_failure_alert_box(cf->filename, err, err_info);
     return FALSE;
   }
@@ -1601,7 +1892,7 @@ cf_read_record_no_alert(capture_file *cf, const frame_data *fdata,
   int    err;
   gchar *err_info;
 
-  if (!wtap_seek_read(cf->provider.wth, fdata->file_off, rec, buf, &err, &err_info)) {
+  if (!cf_seek_read(cf, fdata, rec, buf, &err, &err_info)) {
     g_free(err_info);
     return FALSE;
   }
@@ -1652,6 +1943,12 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   gboolean    compiled;
   guint32     frames_count;
   gboolean    queued_rescan_type = RESCAN_NONE;
+  gchar     **filter_terms = NULL;
+  filter_results_t *prev_results = NULL;
+  guint8     *passed = NULL;
+  guint32     passed_frames = 0;
+  guint32     passed_count = 0;
+  gboolean    skip;
 
   /* Rescan in progress, clear pending actions. */
   cf->redissection_queued = RESCAN_NONE;
@@ -1692,6 +1989,24 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
      (tap_flags & TL_REQUIRES_PROTO_TREE) ||
      (redissect && postdissectors_want_hfids()));
 
+  /* Results of filters applied before don't survive a redissection. */
+  if (redissect)
+    filter_results_clear(&cf->filter_results);
+
+  /*
+   * If the filter narrows down one we applied before, we only need to
+   * look at the frames that passed that one - unless tap listeners want
+   * to see all of them.  Either way, remember which frames pass this one.
+   */
+  if (dfcode != NULL)
+    filter_terms = filter_results_terms_new(cf->dfilter, dfcode);
+  if (filter_terms != NULL) {
+    if (!tap_listeners_require_dissection())
+      prev_results = filter_results_find(cf->filter_results, filter_terms);
+    passed_frames = cf->count;
+    passed = (guint8 *)g_malloc0(passed_frames / 8 + 1);
+  }
+
   reset_tap_listeners();
   /* Which frame, if any, is the currently selected frame?
      XXX - should the selected frame or the focus frame be the "current"
@@ -1789,7 +2104,7 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
      * callback such that wtap resupplies the secrets callback with previously
      * read secrets.
      */
-    wtap_set_cb_new_secrets(cf->provider.wth, secrets_wtap_callback);
+    wtap_set_cb_new_secrets(cf->provider.wth, cf_new_secrets);
   }
 
   for (framenum = 1; framenum <= frames_count; framenum++) {
@@ -1864,7 +2179,13 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
     /* Frame dependencies from the previous dissection/filtering are no longer valid. */
     fdata->dependent_of_displayed = 0;
 
-    if (!cf_read_record(cf, fdata, &rec, &buf))
+    /* Frames that didn't pass the filter we're narrowing down can't pass
+       this one either; don't dissect them again.  Time reference frames
+       are displayed anyway, so they are dissected anyway. */
+    skip = prev_results != NULL && fdata->visited && !fdata->ref_time &&
+           filter_results_excludes(prev_results, framenum);
+
+    if (!skip && !cf_read_record(cf, fdata, &rec, &buf))
       break; /* error reading the frame */
 
     /* If the previous frame is displayed, and we haven't yet seen the
@@ -1875,9 +2196,21 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
       preceding_frame = prev_frame;
     }
 
-    add_packet_to_packet_list(fdata, cf, &edt, dfcode,
-                                    cinfo, &rec, &buf,
-                                    add_to_packet_list);
+    if (skip) {
+      frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                                    &cf->provider.ref, cf->provider.prev_dis);
+      cf->provider.prev_cap = fdata;
+      fdata->passed_dfilter = 0;
+    } else {
+      add_packet_to_packet_list(fdata, cf, &edt, dfcode,
+                                      cinfo, &rec, &buf,
+                                      add_to_packet_list);
+    }
+
+    if (passed != NULL && framenum <= passed_frames && fdata->passed_dfilter) {
+      passed[(framenum - 1) / 8] |= 1 << ((framenum - 1) % 8);
+      passed_count++;
+    }
 
     /* If this frame is displayed, and this is the first frame we've
        seen displayed after the selected frame, remember this frame -
@@ -1899,6 +2232,14 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
     prev_frame = fdata;
   }
 
+  /* Only remember the results if we looked at all the frames. */
+  if (passed != NULL && framenum > frames_count) {
+    filter_results_add(&cf->filter_results, filter_terms, passed, passed_frames, passed_count);
+  } else {
+    g_strfreev(filter_terms);
+    g_free(passed);
+  }
+
   epan_dissect_cleanup(&edt);
   wtap_rec_cleanup(&rec);
   ws_buffer_free(&buf);
@@ -2234,6 +2575,7 @@ process_specified_records(capture_file *cf, packet_range_t *range,
 typedef struct {
   epan_dissect_t edt;
   column_info *cinfo;
+  gboolean restart;     /* the pass was cut short by a queued retap */
 } retap_callback_args_t;
 
 static gboolean
@@ -2242,6 +2584,12 @@ retap_packet(capture_file *cf, frame_data *fdata, wtap_rec *rec, Buffer *buf,
 {
   retap_callback_args_t *args = (retap_callback_args_t *)argsp;
 
+  /* Another retap was requested; cut this pass short to start over. */
+  if (cf->retap_queued) {
+    args->restart = TRUE;
+    return FALSE;
+  }
+
   epan_dissect_run_with_taps(&args->edt, cf->cd_t, rec,
                              frame_tvbuff_new_buffer(&cf->provider, fdata, buf),
                              fdata, args->cinfo);
@@ -2264,41 +2612,67 @@ cf_retap_packets(capture_file *cf)
     return CF_READ_ABORTED;
   }
 
+  /* Requests made while we're retapping, e.g. by a statistics dialog
+     opened while the progress dialog processes events, are folded into
+     the current retap: it's cut short and started over once, so that a
+     single pass feeds the tap listeners registered by all of them.
+     cf->stop_flag is left to the user's Stop button.  Our caller's
+     listeners haven't seen any packets yet when we return, so tell it
+     so; if it keeps them registered, they're fed before
+     cf_cb_file_retap_finished is invoked. */
+  if (cf->retapping) {
+    cf->retap_queued = TRUE;
+    return CF_READ_ABORTED;
+  }
+  cf->retapping = TRUE;
+
   cf_callback_invoke(cf_cb_file_retap_started, cf);
 
-  /* Get the union of the flags for all tap listeners. */
-  tap_flags = union_of_tap_listener_flags();
+  do {
+    cf->retap_queued = FALSE;
+    callback_args.restart = FALSE;
 
-  /* If any tap listeners require the columns, construct them. */
-  callback_args.cinfo = (tap_flags & TL_REQUIRES_COLUMNS) ? &cf->cinfo : NULL;
+    /* Get the union of the flags for all tap listeners. */
+    tap_flags = union_of_tap_listener_flags();
 
-  /*
-   * Determine whether we need to create a protocol tree.
-   * We do if:
-   *
-   *    one of the tap listeners is going to apply a filter;
-   *
-   *    one of the tap listeners requires a protocol tree.
-   */
-  create_proto_tree =
-    (have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE));
+    /* If any tap listeners require the columns, construct them. */
+    callback_args.cinfo = (tap_flags & TL_REQUIRES_COLUMNS) ? &cf->cinfo : NULL;
 
-  /* Reset the tap listeners. */
-  reset_tap_listeners();
+    /*
+     * Determine whether we need to create a protocol tree.
+     * We do if:
+     *
+     *    one of the tap listeners is going to apply a filter;
+     *
+     *    one of the tap listeners requires a protocol tree.
+     */
+    create_proto_tree =
+      (have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE));
 
-  epan_dissect_init(&callback_args.edt, cf->epan, create_proto_tree, FALSE);
+    /* Reset the tap listeners. */
+    reset_tap_listeners();
 
-  /* Iterate through the list of packets, dissecting all packets and
-     re-running the taps. */
-  packet_range_init(&range, cf);
-  packet_range_process_init(&range);
+    epan_dissect_init(&callback_args.edt, cf->epan, create_proto_tree, FALSE);
 
-  ret = process_specified_records(cf, &range, "Recalculating statistics on",
-                                  "all packets", TRUE, retap_packet,
-                                  &callback_args, TRUE);
+    /* Iterate through the list of packets, dissecting all packets and
+       re-running the taps. */
+    packet_range_init(&range, cf);
+    packet_range_process_init(&range);
 
-  packet_range_cleanup(&range);
-  epan_dissect_cleanup(&callback_args.edt);
+    ret = process_specified_records(cf, &range, "Recalculating statistics on",
+                                    "all packets", TRUE, retap_packet,
+                                    &callback_args, TRUE);
+
+    packet_range_cleanup(&range);
+    epan_dissect_cleanup(&callback_args.edt);
+
+    /* Start over if a retap was requested during this pass, unless the
+       user stopped it or it failed for some other reason. */
+  } while (ret != PSP_STOPPED && cf->retap_queued &&
+           (ret == PSP_FINISHED || callback_args.restart));
+
+  cf->retapping = FALSE;
+  cf->retap_queued = FALSE;
 
   cf_callback_invoke(cf_cb_file_retap_finished, cf);
 
@@ -3252,8 +3626,10 @@ match_summary_line(capture_file *cf, frame_data *fdata,
 }
 
 typedef struct {
-    const guint8 *data;
-    size_t        data_len;
+    const guint8     *data;
+    size_t            data_len;
+    ws_memmem_pattern narrow;   /* the data as it is */
+    ws_memmem_pattern wide;     /* the data as UTF-16LE */
 } cbs_t;    /* "Counted byte string" */
 
 
@@ -3271,7 +3647,9 @@ gboolean
 cf_find_packet_data(capture_file *cf, const guint8 *string, size_t string_size,
                     search_direction dir)
 {
-  cbs_t info;
+  cbs_t    info;
+  guint    flags;
+  gboolean found;
 
   info.data = string;
   info.data_len = string_size;
@@ -3282,38 +3660,65 @@ cf_find_packet_data(capture_file *cf, const guint8 *string, size_t string_size,
     return find_packet(cf, match_regex, NULL, dir);
   } else if (cf->string) {
     /* String search - what type of string? */
+    flags = cf->case_type ? WS_MEMMEM_CASELESS : 0;
+    ws_memmem_compile(&info.narrow, string, string_size, flags);
+    ws_memmem_compile(&info.wide, string, string_size, flags | WS_MEMMEM_WIDE);
+
     switch (cf->scs_type) {
 
     case SCS_NARROW_AND_WIDE:
-      return find_packet(cf, match_narrow_and_wide, &info, dir);
+      found = find_packet(cf, match_narrow_and_wide, &info, dir);
+      break;
 
     case SCS_NARROW:
-      return find_packet(cf, match_narrow, &info, dir);
+      found = find_packet(cf, match_narrow, &info, dir);
+      break;
 
     case SCS_WIDE:
-      return find_packet(cf, match_wide, &info, dir);
+      found = find_packet(cf, match_wide, &info, dir);
+      break;
 
     default:
       g_assert_not_reached();
-      return FALSE;
+      found = FALSE;
+      break;
     }
-  } else
-    return find_packet(cf, match_binary, &info, dir);
+    ws_memmem_free(&info.narrow);
+    ws_memmem_free(&info.wide);
+    return found;
+  } else {
+    /* Hex search - the same as a case-sensitive string search */
+    ws_memmem_compile(&info.narrow, string, string_size, 0);
+    found = find_packet(cf, match_narrow, &info, dir);
+    ws_memmem_free(&info.narrow);
+    return found;
+  }
+}
+
+/* Record where the text was found, or return MR_NOTMATCHED. */
+static match_result
+match_found(capture_file *cf, const guint8 *pd, const guint8 *found,
+            const ws_memmem_pattern *pattern, size_t textlen)
+{
+  if (found == NULL)
+    return MR_NOTMATCHED;
+
+  /* Save the position of the last character for highlighting the field. */
+  cf->search_pos = (guint32)(found - pd + pattern->needle_len - 1);
+  cf->search_len = (guint32)textlen;
+  return MR_MATCHED;
 }
 
 static match_result
 match_narrow_and_wide(capture_file *cf, frame_data *fdata,
                       wtap_rec *rec, Buffer *buf, void *criterion)
 {
-  cbs_t        *info       = (cbs_t *)criterion;
-  const guint8 *ascii_text = info->data;
-  size_t        textlen    = info->data_len;
-  match_result  result;
+  cbs_t        *info = (cbs_t *)criterion;
   guint32       buf_len;
   guint8       *pd;
-  guint32       i;
-  guint8        c_char;
-  size_t        c_match    = 0;
+  const guint8 *narrow;
+  const guint8 *wide;
+  size_t        wide_len;
 
   /* Load the frame's data. */
   if (!cf_read_record(cf, fdata, rec, buf)) {
@@ -3321,49 +3726,28 @@ match_narrow_and_wide(capture_file *cf, frame_data *fdata,
     return MR_ERROR;
   }
 
-  result = MR_NOTMATCHED;
   buf_len = fdata->cap_len;
   pd = ws_buffer_start_ptr(buf);
-  i = 0;
-  while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = g_ascii_toupper(c_char);
-    if (c_char != '\0') {
-      if (c_char == ascii_text[c_match]) {
-        c_match += 1;
-        if (c_match == textlen) {
-          result = MR_MATCHED;
-          cf->search_pos = i; /* Save the position of the last character
-                                 for highlighting the field. */
-          cf->search_len = (guint32)textlen;
-          break;
-        }
-      }
-      else {
-        g_assert(i>=c_match);
-        i -= (guint32)c_match;
-        c_match = 0;
-      }
-    }
-    i += 1;
-  }
-  return result;
+  narrow = ws_memmem_exec(pd, buf_len, &info->narrow);
+
+  /* If both are there, report whichever comes first, so only look for
+   * wide text starting before the narrow one. */
+  wide_len = buf_len;
+  if (narrow != NULL)
+    wide_len = MIN(wide_len, (size_t)(narrow - pd) + info->wide.needle_len - 1);
+  wide = ws_memmem_exec(pd, wide_len, &info->wide);
+
+  if (wide != NULL)
+    return match_found(cf, pd, wide, &info->wide, info->data_len);
+  return match_found(cf, pd, narrow, &info->narrow, info->data_len);
 }
 
 static match_result
 match_narrow(capture_file *cf, frame_data *fdata,
              wtap_rec *rec, Buffer *buf, void *criterion)
 {
-  cbs_t        *info       = (cbs_t *)criterion;
-  const guint8 *ascii_text = info->data;
-  size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
+  cbs_t        *info = (cbs_t *)criterion;
   guint8       *pd;
-  guint32       i;
-  guint8        c_char;
-  size_t        c_match    = 0;
 
   /* Load the frame's data. */
   if (!cf_read_record(cf, fdata, rec, buf)) {
@@ -3371,96 +3755,17 @@ match_narrow(capture_file *cf, frame_data *fdata,
     return MR_ERROR;
   }
 
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
   pd = ws_buffer_start_ptr(buf);
-  i = 0;
-  while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = g_ascii_toupper(c_char);
-    if (c_char == ascii_text[c_match]) {
-      c_match += 1;
-      if (c_match == textlen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)textlen;
-        break;
-      }
-    }
-    else {
-      g_assert(i>=c_match);
-      i -= (guint32)c_match;
-      c_match = 0;
-    }
-    i += 1;
-  }
-
-  return result;
+  return match_found(cf, pd, ws_memmem_exec(pd, fdata->cap_len, &info->narrow),
+                     &info->narrow, info->data_len);
 }
 
 static match_result
 match_wide(capture_file *cf, frame_data *fdata,
            wtap_rec *rec, Buffer *buf, void *criterion)
 {
-  cbs_t        *info       = (cbs_t *)criterion;
-  const guint8 *ascii_text = info->data;
-  size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint8       *pd;
-  guint32       i;
-  guint8        c_char;
-  size_t        c_match    = 0;
-
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata, rec, buf)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
-
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(buf);
-  i = 0;
-  while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = g_ascii_toupper(c_char);
-    if (c_char == ascii_text[c_match]) {
-      c_match += 1;
-      if (c_match == textlen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)textlen;
-        break;
-      }
-      i += 1;
-    }
-    else {
-      g_assert(i>=(c_match*2));
-      i -= (guint32)c_match*2;
-      c_match = 0;
-    }
-    i += 1;
-  }
-  return result;
-}
-
-static match_result
-match_binary(capture_file *cf, frame_data *fdata,
-             wtap_rec *rec, Buffer *buf, void *criterion)
-{
-  cbs_t        *info        = (cbs_t *)criterion;
-  const guint8 *binary_data = info->data;
-  size_t        datalen     = info->data_len;
-  match_result  result;
-  guint32       buf_len;
+  cbs_t        *info = (cbs_t *)criterion;
   guint8       *pd;
-  guint32       i;
-  size_t        c_match     = 0;
 
   /* Load the frame's data. */
   if (!cf_read_record(cf, fdata, rec, buf)) {
@@ -3468,29 +3773,9 @@ match_binary(capture_file *cf, frame_data *fdata,
     return MR_ERROR;
   }
 
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
   pd = ws_buffer_start_ptr(buf);
-  i = 0;
-  while (i < buf_len) {
-    if (pd[i] == binary_data[c_match]) {
-      c_match += 1;
-      if (c_match == datalen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)datalen;
-        break;
-      }
-    }
-    else {
-      g_assert(i>=c_match);
-      i -= (guint32)c_match;
-      c_match = 0;
-    }
-    i += 1;
-  }
-  return result;
+  return match_found(cf, pd, ws_memmem_exec(pd, fdata->cap_len, &info->wide),
+                     &info->wide, info->data_len);
 }
 
 static match_result
@@ -3922,6 +4207,7 @@ cf_mark_frame(capture_file *cf, frame_data *frame)
     frame->marked = TRUE;
     if (cf->count > cf->marked_count)
       cf->marked_count++;
+    filter_results_clear(&cf->filter_results);
   }
 }
 
@@ -3935,6 +4221,7 @@ cf_unmark_frame(capture_file *cf, frame_data *frame)
     frame->marked = FALSE;
     if (cf->marked_count > 0)
       cf->marked_count--;
+    filter_results_clear(&cf->filter_results);
   }
 }
 
@@ -3948,6 +4235,7 @@ cf_ignore_frame(capture_file *cf, frame_data *frame)
     frame->ignored = TRUE;
     if (cf->count > cf->ignored_count)
       cf->ignored_count++;
+    filter_results_clear(&cf->filter_results);
   }
 }
 
@@ -3961,6 +4249,7 @@ cf_unignore_frame(capture_file *cf, frame_data *frame)
     frame->ignored = FALSE;
     if (cf->ignored_count > 0)
       cf->ignored_count--;
+    filter_results_clear(&cf->filter_results);
   }
 }
 
@@ -4052,6 +4341,7 @@ cf_set_user_packet_comment(capture_file *cf, frame_data *fd, const gchar *new_co
     cf->packet_comment_count++;
 
   cap_file_provider_set_user_comment(&cf->provider, fd, new_comment);
+  filter_results_clear(&cf->filter_results);
 
   expert_update_comment_count(cf->packet_comment_count);
 
@@ -416,6 +416,13 @@ void cf_redissect_packets(capture_file *cf);
 /**
  * Rescan all packets and just run taps - don't reconstruct the display.
  *
+ * If a retap is already in progress, e.g. because we were called while
+ * its progress dialog processed events, the request is folded into it:
+ * it starts over once it gets back control, and CF_READ_ABORTED is
+ * returned right away. Tap listeners that are removed as soon as this
+ * returns won't have seen any packets in that case; listeners that stay
+ * registered are fed before cf_cb_file_retap_finished.
+ *
  * @param cf the capture file
  * @return one of cf_read_status_t
  */
@@ -30,6 +30,10 @@ cap_file_provider_get_interface_name(struct packet_provider_data *prov, guint32
   wtap_block_t wtapng_if_descr = NULL;
   char* interface_name;
 
+  /* The interface list may be growing on a read-ahead thread. */
+  if (prov->wth_mutex)
+    g_mutex_lock(prov->wth_mutex);
+
   idb_info = wtap_file_get_idb_info(prov->wth);
 
   if (interface_id < idb_info->interface_data->len)
@@ -37,6 +41,9 @@ cap_file_provider_get_interface_name(struct packet_provider_data *prov, guint32
 
   g_free(idb_info);
 
+  if (prov->wth_mutex)
+    g_mutex_unlock(prov->wth_mutex);
+
   if (wtapng_if_descr) {
     if (wtap_block_get_string_option_value(wtapng_if_descr, OPT_IDB_NAME, &interface_name) == WTAP_OPTTYPE_SUCCESS)
       return interface_name;
@@ -55,6 +62,10 @@ cap_file_provider_get_interface_description(struct packet_provider_data *prov, g
   wtap_block_t wtapng_if_descr = NULL;
   char* interface_name;
 
+  /* The interface list may be growing on a read-ahead thread. */
+  if (prov->wth_mutex)
+    g_mutex_lock(prov->wth_mutex);
+
   idb_info = wtap_file_get_idb_info(prov->wth);
 
   if (interface_id < idb_info->interface_data->len)
@@ -62,6 +73,9 @@ cap_file_provider_get_interface_description(struct packet_provider_data *prov, g
 
   g_free(idb_info);
 
+  if (prov->wth_mutex)
+    g_mutex_unlock(prov->wth_mutex);
+
   if (wtapng_if_descr) {
     if (wtap_block_get_string_option_value(wtapng_if_descr, OPT_IDB_DESCR, &interface_name) == WTAP_OPTTYPE_SUCCESS)
       return interface_name;
@@ -90,3 +104,39 @@ cap_file_provider_set_user_comment(struct packet_provider_data *prov, frame_data
 
   fd->has_user_comment = TRUE;
 }
+
+const nstime_t *
+cap_file_provider_get_shift_offset(struct packet_provider_data *prov, const frame_data *fd)
+{
+  if (fd->has_shift_offset && prov->frames_shift_offsets)
+    return (const nstime_t *)g_tree_lookup(prov->frames_shift_offsets, fd);
+
+  return NULL;
+}
+
+void
+cap_file_provider_set_shift_offset(struct packet_provider_data *prov, frame_data *fd, const nstime_t *shift_offset)
+{
+  nstime_t *offset;
+
+  /*
+   * Time shifts are applied to few, if any, frames, so rather than having
+   * an nstime_t in every frame_data, the offsets of shifted frames are
+   * kept here.
+   */
+  if (shift_offset->secs == 0 && shift_offset->nsecs == 0) {
+    if (fd->has_shift_offset && prov->frames_shift_offsets)
+      g_tree_remove(prov->frames_shift_offsets, fd);
+    fd->has_shift_offset = FALSE;
+    return;
+  }
+
+  if (!prov->frames_shift_offsets)
+    prov->frames_shift_offsets = g_tree_new_full(frame_cmp, NULL, NULL, g_free);
+
+  offset = g_new(nstime_t, 1);
+  *offset = *shift_offset;
+  g_tree_replace(prov->frames_shift_offsets, fd, offset);
+
+  fd->has_shift_offset = TRUE;
+}
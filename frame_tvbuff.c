@@ -34,13 +34,19 @@ struct tvb_frame {
 static gboolean
 frame_read(struct tvb_frame *frame_tvb, wtap_rec *rec, Buffer *buf)
 {
-	int    err;
-	gchar *err_info;
+	int      err;
+	gchar   *err_info;
+	gboolean ok;
 
 	/* XXX, what if phdr->caplen isn't equal to
 	 * frame_tvb->tvb.length + frame_tvb->offset?
 	 */
-	if (!wtap_seek_read(frame_tvb->prov->wth, frame_tvb->file_off, rec, buf, &err, &err_info)) {
+	if (frame_tvb->prov->wth_mutex)
+		g_mutex_lock(frame_tvb->prov->wth_mutex);
+	ok = wtap_seek_read(frame_tvb->prov->wth, frame_tvb->file_off, rec, buf, &err, &err_info);
+	if (frame_tvb->prov->wth_mutex)
+		g_mutex_unlock(frame_tvb->prov->wth_mutex);
+	if (!ok) {
 		/* XXX - report error! */
 		switch (err) {
 			case WTAP_ERR_BAD_FILE:
@@ -16,6 +16,7 @@
 #include <epan/prefs.h>
 #include <epan/uat-int.h>
 #include <epan/to_str.h>
+#include <wsutil/pint.h>
 
 #include "pinfo_stats_tree.h"
 
@@ -92,6 +93,25 @@ static void uat_plen_record_post_update_cb(void) {
 
 UAT_RANGE_CB_DEF(uat_plen_records, packet_range, uat_plen_record_t)
 
+static gchar *st_address_name(guint32 key _U_, const void *data) {
+	return address_to_str(NULL, (const address *)data);
+}
+
+/* IPv4 addresses are looked up by their value, others by their name */
+static int tick_address_node(stats_tree *st, packet_info *pinfo, const address *addr, int parent_id, gboolean with_children) {
+	if (addr->type == AT_IPv4 && addr->len == 4)
+		return tick_stat_node_by_key(st, pntoh32(addr->data), st_address_name, addr, parent_id, with_children);
+	return tick_stat_node(st, address_to_str(pinfo->pool, addr), parent_id, with_children);
+}
+
+static gchar *st_port_type_name(guint32 key, const void *data _U_) {
+	return g_strdup(port_type_to_str((port_type)key));
+}
+
+static gchar *st_port_name(guint32 key, const void *data _U_) {
+	return g_strdup_printf("%u", key);
+}
+
 /* ip host stats_tree -- basic test */
 static int st_node_ipv4 = -1;
 static int st_node_ipv6 = -1;
@@ -108,8 +128,8 @@ static void ipv6_hosts_stats_tree_init(stats_tree *st) {
 
 static tap_packet_status ip_hosts_stats_tree_packet(stats_tree *st, packet_info *pinfo, int st_node, const gchar *st_str) {
 	tick_stat_node(st, st_str, 0, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_src), st_node, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_dst), st_node, FALSE);
+	tick_address_node(st, pinfo, &pinfo->net_src, st_node, FALSE);
+	tick_address_node(st, pinfo, &pinfo->net_dst, st_node, FALSE);
 	return TAP_PACKET_REDRAW;
 }
 
@@ -162,10 +182,10 @@ static tap_packet_status ip_srcdst_stats_tree_packet(stats_tree *st,
 						     const gchar *st_str_dst) {
 	/* update source branch */
 	tick_stat_node(st, st_str_src, 0, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_src), st_node_src, FALSE);
+	tick_address_node(st, pinfo, &pinfo->net_src, st_node_src, FALSE);
 	/* update destination branch */
 	tick_stat_node(st, st_str_dst, 0, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_dst), st_node_dst, FALSE);
+	tick_address_node(st, pinfo, &pinfo->net_dst, st_node_dst, FALSE);
 	return TAP_PACKET_REDRAW;
 }
 
@@ -192,12 +212,12 @@ static void ipv6_ptype_stats_tree_init(stats_tree *st) {
 }
 
 static tap_packet_status ipv4_ptype_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	stats_tree_tick_pivot(st, st_node_ipv4_ptype, port_type_to_str(pinfo->ptype));
+	stats_tree_tick_pivot_by_key(st, st_node_ipv4_ptype, pinfo->ptype, st_port_type_name, NULL);
 	return TAP_PACKET_REDRAW;
 }
 
 static tap_packet_status ipv6_ptype_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	stats_tree_tick_pivot(st, st_node_ipv6_ptype, port_type_to_str(pinfo->ptype));
+	stats_tree_tick_pivot_by_key(st, st_node_ipv6_ptype, pinfo->ptype, st_port_type_name, NULL);
 	return TAP_PACKET_REDRAW;
 }
 
@@ -221,15 +241,13 @@ static void ipv6_dsts_stats_tree_init(stats_tree *st) {
 }
 
 static tap_packet_status dsts_stats_tree_packet(stats_tree *st, packet_info *pinfo, int st_node, const gchar *st_str) {
-	static gchar str[128];
 	int ip_dst_node;
 	int protocol_node;
 
 	tick_stat_node(st, st_str, 0, FALSE);
-	ip_dst_node = tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_dst), st_node, TRUE);
-	protocol_node = tick_stat_node(st, port_type_to_str(pinfo->ptype), ip_dst_node, TRUE);
-	g_snprintf(str, sizeof(str) - 1, "%u", pinfo->destport);
-	tick_stat_node(st, str, protocol_node, TRUE);
+	ip_dst_node = tick_address_node(st, pinfo, &pinfo->net_dst, st_node, TRUE);
+	protocol_node = tick_stat_node_by_key(st, pinfo->ptype, st_port_type_name, NULL, ip_dst_node, TRUE);
+	tick_stat_node_by_key(st, pinfo->destport, st_port_name, NULL, protocol_node, TRUE);
 	return TAP_PACKET_REDRAW;
 }
 
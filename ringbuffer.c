@@ -58,6 +58,61 @@
 #include <zlib.h>
 #endif
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/* Compression methods for ringbuffer files */
+typedef enum {
+  RB_COMPRESS_NONE,
+  RB_COMPRESS_GZIP,
+  RB_COMPRESS_ZSTD
+} rb_compress_method;
+
+/* A block of uncompressed data waiting for the compressor */
+typedef struct _rb_chunk {
+  guint8       *data;
+  gsize         len;
+} rb_chunk;
+
+/*
+ * State of a compressor thread.
+ *
+ * The compressor reads uncompressed data from in_fd until end-of-file
+ * and writes it, compressed, to out_fd.  When compressing after a file
+ * has been closed, in_fd is that file.
+ *
+ * When compressing while capturing, in_fd is the read side of a pipe
+ * and the capture file is written to the write side, so the data goes
+ * to disk only once.  A reader thread empties the pipe into an in-memory
+ * queue as fast as it's filled, and the compressor takes its input from
+ * that queue, so the capture loop doesn't have to wait for a compressor
+ * that's fallen behind until the queue holds RB_COMPRESS_QUEUE_LIMIT
+ * bytes.
+ */
+typedef struct _rb_compressor {
+  GThread      *thread;
+  rb_compress_method method;
+  int           level;               /**< compression level, -1 for the default */
+  int           in_fd;               /**< uncompressed input */
+  int           out_fd;              /**< compressed output */
+  gchar        *in_name;             /**< uncompressed file to delete when done, or NULL */
+  GMutex        mutex;               /**< protects bytes_in and the queue */
+  guint64       bytes_in;            /**< uncompressed bytes taken as input so far */
+  guint64       bytes_out;           /**< compressed bytes written */
+  int           err;                 /**< first error seen, or 0 */
+  gchar        *err_info;            /**< details of a WTAP_ERR_INTERNAL error, or NULL */
+
+  /* Only used when compressing while capturing */
+  GThread      *reader;              /**< thread moving data from in_fd to the queue */
+  GQueue       *queue;               /**< rb_chunks waiting to be compressed, or NULL to read in_fd */
+  GCond         queue_cond;          /**< signalled when a chunk is added or removed */
+  gboolean      queue_eof;           /**< TRUE once the reader has seen the end of in_fd */
+  int           queue_err;           /**< error reading in_fd, or 0 */
+  guint64       queued;              /**< bytes in the queue */
+  guint64       max_queued;          /**< most bytes the queue has held */
+} rb_compressor;
+
 /* Ringbuffer file structure */
 typedef struct _rb_file {
   gchar         *name;
@@ -80,6 +135,12 @@ typedef struct _ringbuf_data {
   gboolean      group_read_access;   /**< TRUE if files need to be opened with group read access */
   FILE         *name_h;              /**< write names of completed files to this handle */
   gchar        *compress_type;       /**< compress type */
+  rb_compress_method compress_method;
+  int           compress_level;      /**< compression level, -1 for the default */
+  gboolean      stream_compress;     /**< TRUE to compress while writing rather than after closing */
+  rb_compressor *compressor;         /**< compressor for the current file, if streaming */
+  ringbuf_compress_stats compress_stats; /**< statistics for the last file compressed while writing */
+  gchar        *compress_err_info;   /**< details of the last WTAP_ERR_INTERNAL error from the compressor */
 
   GMutex        mutex;               /**< mutex for oldnames */
   gchar        *oldnames[MAX_FILENAME_QUEUE];       /**< filename list of pending to be deleted */
@@ -123,61 +184,308 @@ static void CleanupOldCap(gchar* name)
   g_mutex_unlock(&rb_data.mutex);
 }
 
+#define RB_COMPRESS_READ_SIZE 65536
+
 /*
- * compress capture file
+ * The most data that's queued for a compressor before the capture loop
+ * has to wait for it.
+ */
+#define RB_COMPRESS_QUEUE_LIMIT (128 * 1024 * 1024)
+
+#ifdef HAVE_ZSTD
+/*
+ * End a zstd frame after this much input, so that readers can seek
+ * to frame boundaries rather than decompressing from the beginning.
+ */
+#define RB_ZSTD_FRAME_SIZE (1024 * 1024)
+
+/* The zstd command's default level; not all libzstd versions define ZSTD_CLEVEL_DEFAULT */
+#define RB_ZSTD_DEFAULT_LEVEL 3
+
+/*
+ * Record a libzstd error.  These aren't errno values; report them as
+ * internal errors, with zstd's description of what went wrong.
  */
-static int ringbuf_exec_compress(gchar* name)
+static void
+rb_zstd_error(rb_compressor *c, size_t ret)
 {
-  guint8  *buffer = NULL;
-  gchar* outgz = NULL;
-  int  fd = -1;
-  ssize_t nread;
-  gboolean delete_org_file = TRUE;
-  gzFile fi = NULL;
+  c->err = WTAP_ERR_INTERNAL;
+  g_free(c->err_info);
+  c->err_info = g_strdup_printf("zstd: %s", ZSTD_getErrorName(ret));
+}
 
-  fd = ws_open(name, O_RDONLY | O_BINARY, 0000);
-  if (fd < 0) {
-    return -1;
+static gboolean
+rb_write_all(rb_compressor *c, const void *data, size_t len)
+{
+  const guint8 *p = (const guint8 *)data;
+  ssize_t nwritten;
+
+  while (len != 0) {
+    nwritten = ws_write(c->out_fd, p, (unsigned int)len);
+    if (nwritten < 0) {
+      c->err = errno;
+      return FALSE;
+    }
+    c->bytes_out += nwritten;
+    p += nwritten;
+    len -= (size_t)nwritten;
   }
+  return TRUE;
+}
 
-  outgz = g_strdup_printf("%s.gz", name);
-  fi = gzopen(outgz, "wb");
-  g_free(outgz);
-  if (fi == NULL) {
-    ws_close(fd);
-    return -1;
+/*
+ * Feed input to the zstd stream, or, if end_frame is TRUE, end the
+ * current frame.
+ */
+static gboolean
+rb_zstd_compress(rb_compressor *c, ZSTD_CStream *zcs, guint8 *obuf, size_t obuf_size,
+                 const guint8 *data, size_t len, gboolean end_frame)
+{
+  ZSTD_inBuffer input = { data, len, 0 };
+  ZSTD_outBuffer output;
+  size_t ret;
+
+  do {
+    output.dst = obuf;
+    output.size = obuf_size;
+    output.pos = 0;
+    if (end_frame)
+      ret = ZSTD_endStream(zcs, &output);
+    else
+      ret = ZSTD_compressStream(zcs, &output, &input);
+    if (ZSTD_isError(ret)) {
+      rb_zstd_error(c, ret);
+      return FALSE;
+    }
+    if (!rb_write_all(c, obuf, output.pos))
+      return FALSE;
+  } while (end_frame ? ret != 0 : input.pos < input.size);
+  return TRUE;
+}
+#endif /* HAVE_ZSTD */
+
+/*
+ * Get the next block of input for the compressor into *buffer, which
+ * holds RB_COMPRESS_READ_SIZE bytes and may be replaced by a queued
+ * block.  Returns its length, 0 at the end of the input, or -1 with
+ * errno set on an error.
+ */
+static ssize_t
+rb_compress_read(rb_compressor *c, guint8 **buffer)
+{
+  rb_chunk *chunk;
+  ssize_t nread;
+  int err;
+
+  if (c->queue == NULL) {
+    nread = ws_read(c->in_fd, *buffer, RB_COMPRESS_READ_SIZE);
+    if (nread > 0) {
+      g_mutex_lock(&c->mutex);
+      c->bytes_in += nread;
+      g_mutex_unlock(&c->mutex);
+    }
+    return nread;
   }
 
-#define FS_READ_SIZE 65536
-  buffer = (guint8*)g_malloc(FS_READ_SIZE);
-  if (buffer == NULL) {
-    ws_close(fd);
-    gzclose(fi);
-    return -1;
+  g_mutex_lock(&c->mutex);
+  while (g_queue_is_empty(c->queue) && !c->queue_eof)
+    g_cond_wait(&c->queue_cond, &c->mutex);
+  chunk = (rb_chunk *)g_queue_pop_head(c->queue);
+  if (chunk == NULL) {
+    err = c->queue_err;
+    g_mutex_unlock(&c->mutex);
+    if (err != 0) {
+      errno = err;
+      return -1;
+    }
+    return 0;
   }
+  c->queued -= chunk->len;
+  c->bytes_in += chunk->len;
+  g_cond_broadcast(&c->queue_cond);
+  g_mutex_unlock(&c->mutex);
+
+  /* Take the chunk's data rather than copying it */
+  g_free(*buffer);
+  *buffer = chunk->data;
+  nread = (ssize_t)chunk->len;
+  g_free(chunk);
+  return nread;
+}
+
+/*
+ * Compress everything from the compressor's input to its output.
+ *
+ * The input is always read to the end, even after an error, so that
+ * whoever is writing to a pipe on the other end never blocks.
+ */
+static void
+rb_compress(rb_compressor *c)
+{
+  guint8  *buffer;
+  ssize_t nread;
+#ifdef HAVE_ZLIB
+  gzFile  gzf = NULL;
+#endif
+#ifdef HAVE_ZSTD
+  ZSTD_CStream *zcs = NULL;
+  guint8  *obuf = NULL;
+  size_t  obuf_size = 0;
+  size_t  frame_in = 0;
+  size_t  zret;
+#endif
+
+  switch (c->method) {
+
+#ifdef HAVE_ZLIB
+  case RB_COMPRESS_GZIP:
+    {
+      char mode[4] = "wb";
+      int gz_fd;
+
+      if (c->level >= 0 && c->level <= 9) {
+        mode[2] = (char)('0' + c->level);
+        mode[3] = '\0';
+      }
+      /* gzclose() closes the descriptor it's given; keep ours open
+         so we can find out how big the compressed file is. */
+      gz_fd = ws_dup(c->out_fd);
+      if (gz_fd == -1) {
+        c->err = errno;
+        break;
+      }
+      /* gzdopen() doesn't set errno if it runs out of memory */
+      errno = 0;
+      gzf = gzdopen(gz_fd, mode);
+      if (gzf == NULL) {
+        /* Get errno before ws_close() can change it */
+        c->err = errno != 0 ? errno : ENOMEM;
+        ws_close(gz_fd);
+      }
+    }
+    break;
+#endif
 
-  while ((nread = ws_read(fd, buffer, FS_READ_SIZE)) > 0) {
-    int n = gzwrite(fi, buffer, (unsigned int)nread);
-    if (n <= 0) {
-      /* mark compression as failed */
-      delete_org_file = FALSE;
+#ifdef HAVE_ZSTD
+  case RB_COMPRESS_ZSTD:
+    zcs = ZSTD_createCStream();
+    if (zcs == NULL) {
+      c->err = ENOMEM;
       break;
     }
+    zret = ZSTD_initCStream(zcs, c->level >= 0 ? c->level : RB_ZSTD_DEFAULT_LEVEL);
+    if (ZSTD_isError(zret)) {
+      rb_zstd_error(c, zret);
+    } else {
+      obuf_size = ZSTD_CStreamOutSize();
+      obuf = (guint8 *)g_malloc(obuf_size);
+    }
+    break;
+#endif
+
+  default:
+    c->err = EINVAL;
+    break;
   }
-  if (nread < 0) {
-    /* mark compression as failed */
-    delete_org_file = FALSE;
+
+  buffer = (guint8 *)g_malloc(RB_COMPRESS_READ_SIZE);
+  while ((nread = rb_compress_read(c, &buffer)) > 0) {
+    if (c->err != 0) {
+      /* Keep draining the input */
+      continue;
+    }
+#ifdef HAVE_ZLIB
+    if (gzf != NULL) {
+      errno = 0;
+      if (gzwrite(gzf, buffer, (unsigned int)nread) <= 0)
+        c->err = errno != 0 ? errno : EIO;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    if (zcs != NULL) {
+      if (rb_zstd_compress(c, zcs, obuf, obuf_size, buffer, nread, FALSE)) {
+        frame_in += nread;
+        if (frame_in >= RB_ZSTD_FRAME_SIZE) {
+          if (rb_zstd_compress(c, zcs, obuf, obuf_size, NULL, 0, TRUE)) {
+            zret = ZSTD_initCStream(zcs, c->level >= 0 ? c->level : RB_ZSTD_DEFAULT_LEVEL);
+            if (ZSTD_isError(zret))
+              rb_zstd_error(c, zret);
+          }
+          frame_in = 0;
+        }
+      }
+    }
+#endif
   }
-  ws_close(fd);
-  gzclose(fi);
+  if (nread < 0 && c->err == 0)
+    c->err = errno;
   g_free(buffer);
 
+#ifdef HAVE_ZLIB
+  if (gzf != NULL) {
+    ws_statb64 statb;
+
+    if (gzclose(gzf) != Z_OK && c->err == 0)
+      c->err = EIO;
+    if (ws_fstat64(c->out_fd, &statb) == 0)
+      c->bytes_out = statb.st_size;
+  }
+#endif
+#ifdef HAVE_ZSTD
+  if (zcs != NULL) {
+    if (c->err == 0)
+      rb_zstd_compress(c, zcs, obuf, obuf_size, NULL, 0, TRUE);
+    ZSTD_freeCStream(zcs);
+  }
+  g_free(obuf);
+#endif
+  if (c->out_fd != -1) {
+    if (ws_close(c->out_fd) != 0 && c->err == 0)
+      c->err = errno;
+    c->out_fd = -1;
+  }
+  if (c->queue == NULL) {
+    /* The reader closes it otherwise */
+    ws_close(c->in_fd);
+    c->in_fd = -1;
+  }
+}
+
+static void
+rb_compressor_free(rb_compressor *c)
+{
+  rb_chunk *chunk;
+
+  if (c->queue != NULL) {
+    while ((chunk = (rb_chunk *)g_queue_pop_head(c->queue)) != NULL) {
+      g_free(chunk->data);
+      g_free(chunk);
+    }
+    g_queue_free(c->queue);
+    g_cond_clear(&c->queue_cond);
+  }
+  g_mutex_clear(&c->mutex);
+  g_free(c->in_name);
+  g_free(c->err_info);
+  g_free(c);
+}
+
+/*
+ * compress capture file
+ */
+static int ringbuf_exec_compress(rb_compressor *c)
+{
+  gboolean delete_org_file;
+
+  rb_compress(c);
+
   /* delete the original file only if compression succeeds */
+  delete_org_file = (c->err == 0);
   if (delete_org_file) {
-    ws_unlink(name);
-    CleanupOldCap(name);
+    ws_unlink(c->in_name);
+    CleanupOldCap(c->in_name);
   }
-  g_free(name);
+  rb_compressor_free(c);
   return 0;
 }
 
@@ -186,20 +494,203 @@ static int ringbuf_exec_compress(gchar* name)
  */
 static void* exec_compress_thread(void* arg)
 {
-  ringbuf_exec_compress((gchar*)arg);
+  ringbuf_exec_compress((rb_compressor*)arg);
   return NULL;
 }
 
+/*
+ * Return the file name extension for the ringbuffer's compression method.
+ */
+static const char *ringbuf_compress_extension(void)
+{
+  switch (rb_data.compress_method) {
+
+  case RB_COMPRESS_GZIP:
+    return ".gz";
+
+  case RB_COMPRESS_ZSTD:
+    return ".zst";
+
+  default:
+    return "";
+  }
+}
+
+static rb_compressor *rb_compressor_new(int in_fd, int out_fd)
+{
+  rb_compressor *c = g_new0(rb_compressor, 1);
+
+  c->method = rb_data.compress_method;
+  c->level = rb_data.compress_level;
+  c->in_fd = in_fd;
+  c->out_fd = out_fd;
+  g_mutex_init(&c->mutex);
+  return c;
+}
+
 /*
  * start a thread to compress capture file
  */
 static int ringbuf_start_compress_file(rb_file* rfile)
 {
-  gchar* name = g_strdup(rfile->name);
-  g_thread_new("exec_compress", &exec_compress_thread, name);
+  rb_compressor *c;
+  gchar *outname;
+  int in_fd, out_fd;
+
+  in_fd = ws_open(rfile->name, O_RDONLY | O_BINARY, 0000);
+  if (in_fd < 0) {
+    return -1;
+  }
+
+  outname = g_strconcat(rfile->name, ringbuf_compress_extension(), NULL);
+  out_fd = ws_open(outname, O_WRONLY|O_BINARY|O_TRUNC|O_CREAT,
+                   rb_data.group_read_access ? 0640 : 0600);
+  g_free(outname);
+  if (out_fd < 0) {
+    ws_close(in_fd);
+    return -1;
+  }
+
+  c = rb_compressor_new(in_fd, out_fd);
+  c->in_name = g_strdup(rfile->name);
+  g_thread_new("exec_compress", &exec_compress_thread, c);
   return 0;
 }
 
+/*
+ * thread to compress the current capture file as it's written
+ */
+static void* stream_compress_thread(void* arg)
+{
+  rb_compress((rb_compressor*)arg);
+  return NULL;
+}
+
+/*
+ * thread to move the current capture file from the pipe it's written
+ * to into the compressor's queue
+ */
+static void* stream_queue_thread(void* arg)
+{
+  rb_compressor *c = (rb_compressor*)arg;
+  rb_chunk *chunk;
+  guint8 *buffer;
+  ssize_t nread;
+  int err;
+
+  for (;;) {
+    buffer = (guint8 *)g_malloc(RB_COMPRESS_READ_SIZE);
+    nread = ws_read(c->in_fd, buffer, RB_COMPRESS_READ_SIZE);
+    if (nread <= 0) {
+      err = nread < 0 ? errno : 0;
+      g_free(buffer);
+      g_mutex_lock(&c->mutex);
+      c->queue_err = err;
+      c->queue_eof = TRUE;
+      g_cond_broadcast(&c->queue_cond);
+      g_mutex_unlock(&c->mutex);
+      break;
+    }
+
+    chunk = g_new(rb_chunk, 1);
+    chunk->data = buffer;
+    chunk->len = (gsize)nread;
+
+    g_mutex_lock(&c->mutex);
+    /* Wait for the compressor if the queue is full (but always let in
+       one chunk, so that we can't wait for an empty queue). */
+    while (c->queued + chunk->len > RB_COMPRESS_QUEUE_LIMIT && !g_queue_is_empty(c->queue))
+      g_cond_wait(&c->queue_cond, &c->mutex);
+    g_queue_push_tail(c->queue, chunk);
+    c->queued += chunk->len;
+    if (c->queued > c->max_queued)
+      c->max_queued = c->queued;
+    g_cond_broadcast(&c->queue_cond);
+    g_mutex_unlock(&c->mutex);
+  }
+
+  ws_close(c->in_fd);
+  c->in_fd = -1;
+  return NULL;
+}
+
+/*
+ * Set up to compress the file that's just been opened as rb_data.fd as
+ * it's written: the capture is written to a pipe, a reader thread
+ * queues what comes out of the pipe, and a compressor thread compresses
+ * the queued data and writes it to the file.  On success, rb_data.fd is
+ * the write side of the pipe.
+ *
+ * The capture loop only blocks on the pipe if the queue is full, i.e.
+ * the compressor is RB_COMPRESS_QUEUE_LIMIT bytes behind.
+ */
+static int ringbuf_start_stream_compress(int *err)
+{
+  int fds[2];
+
+#ifdef _WIN32
+  if (_pipe(fds, RB_COMPRESS_READ_SIZE, _O_BINARY) == -1) {
+#else
+  if (pipe(fds) == -1) {
+#endif
+    if (err != NULL)
+      *err = errno;
+    ws_close(rb_data.fd);
+    rb_data.fd = -1;
+    return -1;
+  }
+
+  rb_data.compressor = rb_compressor_new(fds[0], rb_data.fd);
+  rb_data.compressor->queue = g_queue_new();
+  g_cond_init(&rb_data.compressor->queue_cond);
+  rb_data.compressor->reader = g_thread_new("stream_queue", &stream_queue_thread,
+                                            rb_data.compressor);
+  rb_data.compressor->thread = g_thread_new("stream_compress", &stream_compress_thread,
+                                            rb_data.compressor);
+  rb_data.fd = fds[1];
+  return rb_data.fd;
+}
+
+/*
+ * Wait for the compressor for the file just closed to finish and save
+ * its statistics.  Returns the compressor's error, if any, or 0.
+ */
+static int ringbuf_finish_stream_compress(void)
+{
+  rb_compressor *c = rb_data.compressor;
+  guint64 backlog, max_queued;
+  int err;
+
+  if (c == NULL)
+    return 0;
+
+  /* The file has been closed, so the reader gets to the end of the pipe
+     straight away; whatever it has queued hadn't been compressed yet. */
+  g_thread_join(c->reader);
+  g_mutex_lock(&c->mutex);
+  backlog = c->queued;
+  max_queued = c->max_queued;
+  g_mutex_unlock(&c->mutex);
+
+  g_thread_join(c->thread);
+
+  g_free(rb_data.compress_stats.name);
+  rb_data.compress_stats.name = g_strdup(ringbuf_current_filename());
+  rb_data.compress_stats.bytes_in = c->bytes_in;
+  rb_data.compress_stats.bytes_out = c->bytes_out;
+  rb_data.compress_stats.backlog = backlog;
+  if (max_queued > rb_data.compress_stats.max_backlog)
+    rb_data.compress_stats.max_backlog = max_queued;
+
+  err = c->err;
+  g_free(rb_data.compress_err_info);
+  rb_data.compress_err_info = c->err_info;
+  c->err_info = NULL;
+  rb_compressor_free(c);
+  rb_data.compressor = NULL;
+  return err;
+}
+
 /*
  * create the next filename and open a new binary file with that name
  */
@@ -215,7 +706,7 @@ static int ringbuf_open_file(rb_file *rfile, int *err)
       /* remove old file (if any, so ignore error) */
       ws_unlink(rfile->name);
     }
-    else if (rb_data.compress_type != NULL && strcmp(rb_data.compress_type, "gzip") == 0) {
+    else if (rb_data.compress_method != RB_COMPRESS_NONE && !rb_data.stream_compress) {
       ringbuf_start_compress_file(rfile);
     }
     g_free(rfile->name);
@@ -233,7 +724,9 @@ static int ringbuf_open_file(rb_file *rfile, int *err)
   else
     g_strlcpy(timestr, "196912312359", sizeof(timestr)); /* second before the Epoch */
   rfile->name = g_strconcat(rb_data.fprefix, "_", filenum, "_", timestr,
-                            rb_data.fsuffix, NULL);
+                            rb_data.fsuffix,
+                            rb_data.stream_compress ? ringbuf_compress_extension() : NULL,
+                            NULL);
 
   if (rfile->name == NULL) {
     if (err != NULL)
@@ -248,6 +741,10 @@ static int ringbuf_open_file(rb_file *rfile, int *err)
     *err = errno;
   }
 
+  if (rb_data.fd != -1 && rb_data.stream_compress) {
+    return ringbuf_start_stream_compress(err);
+  }
+
   return rb_data.fd;
 }
 
@@ -255,11 +752,13 @@ static int ringbuf_open_file(rb_file *rfile, int *err)
  * Initialize the ringbuffer data structures
  */
 int
-ringbuf_init(const char *capfile_name, guint num_files, gboolean group_read_access, gchar *compress_type)
+ringbuf_init(const char *capfile_name, guint num_files, gboolean group_read_access, gchar *compress_type,
+             gboolean stream_compress)
 {
   unsigned int i;
   char        *pfx, *last_pathsep;
   gchar       *save_file;
+  const char  *level;
 
   rb_data.files = NULL;
   rb_data.curr_file_num = 0;
@@ -272,8 +771,28 @@ ringbuf_init(const char *capfile_name, guint num_files, gboolean group_read_acce
   rb_data.group_read_access = group_read_access;
   rb_data.name_h = NULL;
   rb_data.compress_type = compress_type;
+  rb_data.compress_method = RB_COMPRESS_NONE;
+  rb_data.compress_level = -1;
+  rb_data.compressor = NULL;
+  memset(&rb_data.compress_stats, 0, sizeof rb_data.compress_stats);
   g_mutex_init(&rb_data.mutex);
 
+  /* The compress type is "<method>[:<level>]" */
+  if (compress_type != NULL) {
+#ifdef HAVE_ZLIB
+    if (strncmp(compress_type, "gzip", 4) == 0)
+      rb_data.compress_method = RB_COMPRESS_GZIP;
+#endif
+#ifdef HAVE_ZSTD
+    if (strncmp(compress_type, "zstd", 4) == 0)
+      rb_data.compress_method = RB_COMPRESS_ZSTD;
+#endif
+    level = strchr(compress_type, ':');
+    if (level != NULL)
+      rb_data.compress_level = (int)strtol(level + 1, NULL, 10);
+  }
+  rb_data.stream_compress = stream_compress && rb_data.compress_method != RB_COMPRESS_NONE;
+
   /* just to be sure ... */
   if (num_files <= RINGBUFFER_MAX_NUM_FILES) {
     rb_data.num_files = num_files;
@@ -386,6 +905,27 @@ const gchar *ringbuf_current_filename(void)
   return rb_data.files[rb_data.curr_file_num % rb_data.num_files].name;
 }
 
+/*
+ * Get the compression statistics for the last file that was compressed
+ * while it was written; returns FALSE if there isn't one.
+ */
+gboolean ringbuf_get_compress_stats(const ringbuf_compress_stats **stats)
+{
+  if (rb_data.compress_stats.name == NULL)
+    return FALSE;
+  *stats = &rb_data.compress_stats;
+  return TRUE;
+}
+
+/*
+ * Get the details of the last WTAP_ERR_INTERNAL error returned for a
+ * file compressed while it was written, or NULL if there aren't any.
+ */
+const gchar *ringbuf_get_compress_err_info(void)
+{
+  return rb_data.compress_err_info;
+}
+
 /*
  * Calls ws_fdopen() for the current ringbuffer file
  */
@@ -424,6 +964,7 @@ ringbuf_switch_file(FILE **pdh, gchar **save_file, int *save_file_fd, int *err)
 {
   int     next_file_index;
   rb_file *next_rfile = NULL;
+  int     compress_err;
 
   /* close current file */
 
@@ -434,6 +975,7 @@ ringbuf_switch_file(FILE **pdh, gchar **save_file, int *save_file_fd, int *err)
     ws_close(rb_data.fd);  /* XXX - the above should have closed this already */
     rb_data.pdh = NULL;    /* it's still closed, we just got an error while closing */
     rb_data.fd = -1;
+    ringbuf_finish_stream_compress();
     g_free(rb_data.io_buffer);
     rb_data.io_buffer = NULL;
     return FALSE;
@@ -442,6 +984,16 @@ ringbuf_switch_file(FILE **pdh, gchar **save_file, int *save_file_fd, int *err)
   rb_data.pdh = NULL;
   rb_data.fd  = -1;
 
+  compress_err = ringbuf_finish_stream_compress();
+  if (compress_err != 0) {
+    if (err != NULL) {
+      *err = compress_err;
+    }
+    g_free(rb_data.io_buffer);
+    rb_data.io_buffer = NULL;
+    return FALSE;
+  }
+
   if (rb_data.name_h != NULL) {
     fprintf(rb_data.name_h, "%s\n", ringbuf_current_filename());
     fflush(rb_data.name_h);
@@ -476,6 +1028,7 @@ gboolean
 ringbuf_libpcap_dump_close(gchar **save_file, int *err)
 {
   gboolean  ret_val = TRUE;
+  int       compress_err;
 
   /* close current file, if it's open */
   if (rb_data.pdh != NULL) {
@@ -491,6 +1044,13 @@ ringbuf_libpcap_dump_close(gchar **save_file, int *err)
     g_free(rb_data.io_buffer);
     rb_data.io_buffer = NULL;
 
+    compress_err = ringbuf_finish_stream_compress();
+    if (compress_err != 0 && ret_val) {
+      if (err != NULL) {
+        *err = compress_err;
+      }
+      ret_val = FALSE;
+    }
   }
 
   if (rb_data.name_h != NULL) {
@@ -533,6 +1093,10 @@ ringbuf_free(void)
     g_free(rb_data.fsuffix);
     rb_data.fsuffix = NULL;
   }
+  g_free(rb_data.compress_stats.name);
+  rb_data.compress_stats.name = NULL;
+  g_free(rb_data.compress_err_info);
+  rb_data.compress_err_info = NULL;
 
   CleanupOldCap(NULL);
 }
@@ -559,6 +1123,9 @@ ringbuf_error_cleanup(void)
     rb_data.fd = -1;
   }
 
+  /* the compressor sees end-of-file now; let it finish before deleting */
+  ringbuf_finish_stream_compress();
+
   if (rb_data.files != NULL) {
     for (i=0; i < rb_data.num_files; i++) {
       if (rb_data.files[i].name != NULL) {
@@ -23,9 +23,21 @@
 /* Maximum number for FAT filesystems */
 #define RINGBUFFER_WARN_NUM_FILES 65535
 
-int ringbuf_init(const char *capture_name, guint num_files, gboolean group_read_access, gchar* compress_type);
+/** Statistics for ringbuffer files compressed while they're written */
+typedef struct {
+  gchar   *name;        /**< name of the last file closed */
+  guint64  bytes_in;    /**< uncompressed size of that file */
+  guint64  bytes_out;   /**< compressed size of that file */
+  guint64  backlog;     /**< bytes queued for the compressor when that file was closed */
+  guint64  max_backlog; /**< most bytes queued for the compressor at any time so far */
+} ringbuf_compress_stats;
+
+int ringbuf_init(const char *capture_name, guint num_files, gboolean group_read_access, gchar* compress_type,
+                 gboolean stream_compress);
 gboolean ringbuf_is_initialized(void);
 const gchar *ringbuf_current_filename(void);
+gboolean ringbuf_get_compress_stats(const ringbuf_compress_stats **stats);
+const gchar *ringbuf_get_compress_err_info(void);
 FILE *ringbuf_init_libpcap_fdopen(int *err);
 gboolean ringbuf_switch_file(FILE **pdh, gchar **save_file, int *save_file_fd,
                              int *err);
@@ -74,6 +74,10 @@ capture_file cfile;
 static guint32 cum_bytes;
 static frame_data ref_frame;
 
+/* The capture file open is the one the daemon loaded (sharkd -r), and the
+   session hasn't asked for it yet. */
+static gboolean cfile_preloaded = FALSE;
+
 static void failure_warning_message(const char *msg_format, va_list ap);
 static void open_failure_message(const char *filename, int err,
     gboolean for_writing);
@@ -230,7 +234,8 @@ sharkd_epan_new(capture_file *cf)
     sharkd_get_frame_ts,
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
-    cap_file_provider_get_user_comment
+    cap_file_provider_get_user_comment,
+    NULL
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -508,6 +513,7 @@ failure_message_cont(const char *msg_format, va_list ap)
 cf_status_t
 sharkd_cf_open(const char *fname, unsigned int type, gboolean is_tempfile, int *err)
 {
+  cfile_preloaded = FALSE;
   return cf_open(&cfile, fname, type, is_tempfile, err);
 }
 
@@ -517,6 +523,51 @@ sharkd_load_cap_file(void)
   return load_cap_file(&cfile, 0, 0);
 }
 
+int
+sharkd_preload_cap_file(const char *fname)
+{
+  int err = 0;
+
+  if (sharkd_cf_open(fname, WTAP_TYPE_AUTO, FALSE, &err) != CF_OK)
+    return err != 0 ? err : -1;
+
+  err = sharkd_load_cap_file();
+  if (err == 0)
+    cfile_preloaded = TRUE;
+
+  return err;
+}
+
+gboolean
+sharkd_cf_take_preloaded(const char *fname)
+{
+  gboolean preloaded = cfile_preloaded && !strcmp(cfile.filename, fname);
+
+  /* Only the first request for it is answered from the preloaded file,
+     later ones read it again as usual. */
+  cfile_preloaded = FALSE;
+
+  return preloaded;
+}
+
+int
+sharkd_cf_reopen(void)
+{
+  int err = 0;
+
+  if (!cfile.provider.wth)
+    return 0;
+
+  /* Don't share the file offset of the random access stream with the
+     process we were forked from, or with the other sessions. Close our
+     copies of the descriptors we inherited first, so they don't leak. */
+  wtap_fdclose(cfile.provider.wth);
+  if (!wtap_fdreopen(cfile.provider.wth, cfile.filename, &err))
+    cfile_open_failure_message("sharkd", cfile.filename, err, NULL);
+
+  return err;
+}
+
 frame_data *
 sharkd_get_frame(guint32 framenum)
 {
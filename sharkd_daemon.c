@@ -61,6 +61,7 @@
 
 static int mode = 0;
 static socket_handle_t _server_fd = INVALID_SOCKET;
+static const char *_preload_filename = NULL;
 
 static socket_handle_t
 socket_init(char *path)
@@ -192,11 +193,15 @@ print_usage(FILE* output)
 	fprintf(output, "  -v, --version            show version information\n");
 	fprintf(output, "  -C <config profile>, --config-profile <config profile>\n");
 	fprintf(output, "                           start with specified configuration profile\n");
+	fprintf(output, "  -r <infile>, --read-file <infile>\n");
+	fprintf(output, "                           load this capture file once, before accepting\n");
+	fprintf(output, "                           connections; sessions loading it share the result\n");
 
 	fprintf(output, "\n");
 	fprintf(output, "  Examples:\n");
 	fprintf(output, "    sharkd -C myprofile\n");
 	fprintf(output, "    sharkd -a tcp:127.0.0.1:4446 -C myprofile\n");
+	fprintf(output, "    sharkd -a tcp:127.0.0.1:4446 -r capture.pcapng\n");
 
 	fprintf(output, "\n");
 	fprintf(output, "See the sharkd page of the Wireshark wiki for full details.\n");
@@ -226,7 +231,7 @@ sharkd_init(int argc, char **argv)
 	 * platform-dependent.
 	 */
 
-#define OPTSTRING "+" "a:hmvC:"
+#define OPTSTRING "+" "a:hmr:vC:"
 
 	static const char    optstring[] = OPTSTRING;
 
@@ -236,6 +241,7 @@ sharkd_init(int argc, char **argv)
 	  {"help", no_argument, NULL, 'h'},
 	  {"version", no_argument, NULL, 'v'},
 	  {"config-profile", required_argument, NULL, 'C'},
+	  {"read-file", required_argument, NULL, 'r'},
 	  {0, 0, 0, 0 }
 	};
 
@@ -330,6 +336,10 @@ sharkd_init(int argc, char **argv)
 				mode = SHARKD_MODE_GOLD_CONSOLE;
 				break;
 
+			case 'r':        /* Capture file to load before accepting connections */
+				_preload_filename = optarg;
+				break;
+
 			case 'v':         /* Show version and exit */
 				show_version();
 				exit(0);
@@ -371,6 +381,31 @@ sharkd_loop(int argc _U_, char* argv[] _U_)
 sharkd_loop(int argc _U_, char* argv[])
 #endif
 {
+#ifndef _WIN32
+	gboolean preload = _preload_filename != NULL;
+#else
+	/*
+	 * The session processes aren't forked off, so loading the file in
+	 * the daemon would do them no good. In gold mode they are passed -r
+	 * and load it themselves; in classic mode they aren't.
+	 */
+	gboolean preload = _preload_filename != NULL &&
+		(mode == SHARKD_MODE_CLASSIC_CONSOLE || mode == SHARKD_MODE_GOLD_CONSOLE);
+#endif
+
+	if (preload)
+	{
+		/*
+		 * Read and dissect the file once, here. The session processes
+		 * forked off below start with it loaded, and share the memory
+		 * holding the results of the first pass with us until they
+		 * change it.
+		 */
+		fprintf(stderr, "load: filename=%s\n", _preload_filename);
+		if (sharkd_preload_cap_file(_preload_filename) != 0)
+			return 1;
+	}
+
 	if (mode == SHARKD_MODE_CLASSIC_CONSOLE || mode == SHARKD_MODE_GOLD_CONSOLE)
 	{
 		return sharkd_session_main(mode);
@@ -406,6 +441,9 @@ sharkd_loop(int argc _U_, char* argv[])
 			dup2(fd, 1);
 			close(fd);
 
+			if (preload && sharkd_cf_reopen() != 0)
+				exit(1);
+
 			exit(sharkd_session_main(mode));
 		}
 
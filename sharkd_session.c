@@ -549,6 +549,14 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
 	fprintf(stderr, "load: filename=%s\n", tok_file);
 
+	if (sharkd_cf_take_preloaded(tok_file))
+	{
+		/* Already loaded by the daemon (sharkd -r) before this session
+		 * was started, no need to read and dissect it again. */
+		sharkd_json_simple_reply(0, NULL);
+		return;
+	}
+
 	if (sharkd_cf_open(tok_file, WTAP_TYPE_AUTO, FALSE, &err) != CF_OK)
 	{
 		sharkd_json_simple_reply(err, NULL);
@@ -773,6 +781,8 @@ sharkd_session_create_columns(column_info *cinfo, const char *buf, const jsmntok
  *   (o) column0...columnXX - requested columns either number in range [0..NUM_COL_FMTS), or custom (syntax <dfilter>:<occurence>).
  *                            If column0 is not specified default column set will be used.
  *   (o) filter - filter to be used
+ *   (o) cursor=N - start after frame N, usually the last frame (num) of the previous page.
+ *                  Unlike skip, the frames before it aren't walked through.
  *   (o) skip=N   - skip N frames
  *   (o) limit=N  - show only N frames
  *   (o) refs  - list (comma separated) with sorted time reference frame numbers.
@@ -791,6 +801,7 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 {
 	const char *tok_filter = json_find_attr(buf, tokens, count, "filter");
 	const char *tok_column = json_find_attr(buf, tokens, count, "column0");
+	const char *tok_cursor = json_find_attr(buf, tokens, count, "cursor");
 	const char *tok_skip   = json_find_attr(buf, tokens, count, "skip");
 	const char *tok_limit  = json_find_attr(buf, tokens, count, "limit");
 	const char *tok_refs   = json_find_attr(buf, tokens, count, "refs");
@@ -799,7 +810,7 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 
 	int col;
 
-	guint32 framenum, prev_dis_num = 0;
+	guint32 framenum, first_framenum = 1, prev_dis_num = 0;
 	guint32 current_ref_frame = 0, next_ref_frame = G_MAXUINT32;
 	guint32 skip;
 	guint32 limit;
@@ -825,6 +836,26 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 		filter_data = filter_item->filtered;
 	}
 
+	if (tok_cursor)
+	{
+		guint32 cursor;
+
+		if (!ws_strtou32(tok_cursor, NULL, &cursor))
+			return;
+
+		if (cursor > cfile.count)
+			cursor = cfile.count;
+		first_framenum = cursor + 1;
+
+		/* The first frame's delta displayed time is relative to the
+		 * last one displayed before it. */
+		for (prev_dis_num = cursor; prev_dis_num > 0; prev_dis_num--)
+		{
+			if (!filter_data || (filter_data[prev_dis_num / 8] & (1 << (prev_dis_num % 8))))
+				break;
+		}
+	}
+
 	skip = 0;
 	if (tok_skip)
 	{
@@ -846,9 +877,10 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 	}
 
 	sharkd_json_array_open(NULL);
-	for (framenum = 1; framenum <= cfile.count; framenum++)
+	for (framenum = first_framenum; framenum <= cfile.count; framenum++)
 	{
 		frame_data *fdata;
+		const color_filter_t *color_filter;
 		guint32 ref_frame = (framenum != 1) ? 1 : 0;
 
 		if (filter_data && !(filter_data[framenum / 8] & (1 << (framenum % 8))))
@@ -893,7 +925,7 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 		}
 
 		fdata = sharkd_get_frame(framenum);
-		sharkd_dissect_columns(fdata, ref_frame, prev_dis_num, cinfo, (fdata->color_filter == NULL));
+		sharkd_dissect_columns(fdata, ref_frame, prev_dis_num, cinfo, (fdata->color_filter_index == 0));
 
 		json_dumper_begin_object(&dumper);
 
@@ -920,10 +952,11 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 		if (fdata->marked)
 			sharkd_json_value_anyf("m", "true");
 
-		if (fdata->color_filter)
+		color_filter = color_filters_get_frame_filter(fdata);
+		if (color_filter)
 		{
-			sharkd_json_value_stringf("bg", "%x", color_t_to_rgb(&fdata->color_filter->bg_color));
-			sharkd_json_value_stringf("fg", "%x", color_t_to_rgb(&fdata->color_filter->fg_color));
+			sharkd_json_value_stringf("bg", "%x", color_t_to_rgb(&color_filter->bg_color));
+			sharkd_json_value_stringf("fg", "%x", color_t_to_rgb(&color_filter->fg_color));
 		}
 
 		json_dumper_end_object(&dumper);
@@ -2773,6 +2806,7 @@ sharkd_session_process_frame_cb(epan_dissect_t *edt, proto_tree *tree, struct ep
 {
 	packet_info *pi = &edt->pi;
 	frame_data *fdata = pi->fd;
+	const color_filter_t *color_filter;
 	const char *pkt_comment = NULL;
 
 	const struct sharkd_frame_request_data * const req_data = (const struct sharkd_frame_request_data * const) data;
@@ -2838,10 +2872,11 @@ sharkd_session_process_frame_cb(epan_dissect_t *edt, proto_tree *tree, struct ep
 	if (fdata->marked)
 		sharkd_json_value_anyf("m", "true");
 
-	if (fdata->color_filter)
+	color_filter = color_filters_get_frame_filter(fdata);
+	if (color_filter)
 	{
-		sharkd_json_value_stringf("bg", "%x", color_t_to_rgb(&fdata->color_filter->bg_color));
-		sharkd_json_value_stringf("fg", "%x", color_t_to_rgb(&fdata->color_filter->fg_color));
+		sharkd_json_value_stringf("bg", "%x", color_t_to_rgb(&color_filter->bg_color));
+		sharkd_json_value_stringf("fg", "%x", color_t_to_rgb(&color_filter->fg_color));
 	}
 
 	if (data_src)
@@ -4253,10 +4288,28 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
 	}
 }
 
+/* Reads a line, however long it is. Returns FALSE at the end of the input. */
+static gboolean
+sharkd_session_read_line(FILE *fp, GString *line)
+{
+	char chunk[2 * 1024];
+
+	g_string_truncate(line, 0);
+	while (fgets(chunk, sizeof(chunk), fp))
+	{
+		g_string_append(line, chunk);
+		if (line->str[line->len - 1] == '\n')
+			return TRUE;
+	}
+
+	return line->len != 0;
+}
+
 int
 sharkd_session_main(int mode_setting)
 {
-	char buf[2 * 1024];
+	GString *line = g_string_sized_new(2 * 1024);
+	char *buf;
 	jsmntok_t *tokens = NULL;
 	int tokens_max = -1;
 
@@ -4273,11 +4326,13 @@ sharkd_session_main(int mode_setting)
 	uat_get_table_by_name("MaxMind Database Paths")->post_update_cb();
 #endif
 
-	while (fgets(buf, sizeof(buf), stdin))
+	while (sharkd_session_read_line(stdin, line))
 	{
 		/* every command is line seperated JSON */
 		int ret;
 
+		buf = line->str;
+
 		ret = json_parse(buf, NULL, 0);
 		if (ret <= 0)
 		{
@@ -4310,6 +4365,7 @@ sharkd_session_main(int mode_setting)
 
 	g_hash_table_destroy(filter_table);
 	g_free(tokens);
+	g_string_free(line, TRUE);
 
 	return 0;
 }
@@ -182,6 +182,8 @@ def features(cmd_tshark, make_env):
         have_gnutls='with GnuTLS' in tshark_v,
         have_pkcs11='and PKCS #11 support' in tshark_v,
         have_brotli='with brotli' in tshark_v,
+        have_lz4='with LZ4' in tshark_v,
+        have_zstd='with Zstandard' in tshark_v,
     )
 
 
@@ -148,6 +148,45 @@ class case_tshark_name_resolution_clopts(subprocesstest.SubprocessTestCase):
 
     # XXX Add invalid name resolution.
 
+    def test_tshark_max_conversations(self, cmd_tshark, capture_file):
+        '''Session auto reset by number of conversations'''
+        self.assertRun((cmd_tshark,
+            '-r', capture_file('dns+icmp.pcapng.gz'),
+            '--max-conversations', '1',
+        ))
+        self.assertTrue(self.grepOutput('^resetting session\\.$'))
+        # All packets are still dissected.
+        self.assertRun((cmd_tshark, '-r', capture_file('dns+icmp.pcapng.gz')))
+        packet_count = self.countOutput()
+        self.assertRun((cmd_tshark,
+            '-r', capture_file('dns+icmp.pcapng.gz'),
+            '--max-conversations', '1',
+        ))
+        self.assertEqual(self.countOutput(), packet_count)
+
+    def test_tshark_max_session_memory(self, cmd_tshark, capture_file):
+        '''Session auto reset by memory used'''
+        self.assertRun((cmd_tshark, '-r', capture_file('dns+icmp.pcapng.gz')))
+        packet_count = self.countOutput()
+        # The first block of memory is already more than this.
+        self.assertRun((cmd_tshark,
+            '-r', capture_file('dns+icmp.pcapng.gz'),
+            '--max-session-memory', '1',
+        ))
+        resets = self.countOutput('^resetting session\\.$', count_stdout=False, count_stderr=True)
+        self.assertGreater(resets, 0)
+        # The resets are counted at the end.
+        self.assertTrue(self.grepOutput('^{} session resets?$'.format(resets)))
+        self.assertEqual(self.countOutput(), packet_count)
+
+    def test_tshark_max_conversations_two_pass(self, cmd_tshark, capture_file):
+        '''Session auto reset is rejected with two-pass analysis'''
+        self.assertRun((cmd_tshark,
+            '-r', capture_file('dns+icmp.pcapng.gz'),
+            '-2', '--max-conversations', '1',
+        ), expected_return=self.exit_command_line)
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_tshark_unicode_clopts(subprocesstest.SubprocessTestCase):
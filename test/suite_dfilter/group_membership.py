@@ -58,3 +58,39 @@ class case_membership(unittest.TestCase):
         dfilter = 'frame.number in {1 "foo"}'
         error = '"foo" cannot be converted to Unsigned integer, 4 bytes.'
         checkDFilterFail(dfilter, error)
+
+    def test_membership_12_many_values(self, checkDFilterCount):
+        dfilter = 'tcp.port in {1 2 3 4 5 6 7 8 9 10 3267 20 21 22 23}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_13_values_and_ranges(self, checkDFilterCount):
+        dfilter = 'tcp.dstport in {1 2 3 70..75 76 77..79 81..90}'
+        checkDFilterCount(dfilter, 0)
+
+    def test_membership_14_overlapping_ranges(self, checkDFilterCount):
+        dfilter = 'tcp.dstport in {1..10 5..60 40..79 79..80}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_15_ip_subnet(self, checkDFilterCount):
+        dfilter = 'ip.addr in {192.0.2.1 10.0.0.0/24 198.51.100.7}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_16_field_element(self, checkDFilterCount):
+        dfilter = 'tcp.dstport in {1 2 tcp.srcport 80}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_17_inverted_ranges(self, checkDFilterCount):
+        dfilter = 'tcp.port in {81..79}'
+        checkDFilterCount(dfilter, 0)
+        dfilter = 'tcp.port in {10..5 90..80}'
+        checkDFilterCount(dfilter, 0)
+
+    def test_membership_18_inverted_and_valid_ranges(self, checkDFilterCount):
+        dfilter = 'tcp.port in {90..81 80}'
+        checkDFilterCount(dfilter, 1)
+        dfilter = 'tcp.dstport in {90..70 3267}'
+        checkDFilterCount(dfilter, 0)
+        dfilter = 'tcp.dstport in {90..70 tcp.dstport}'
+        checkDFilterCount(dfilter, 1)
+        dfilter = 'tcp.dstport in {90..70 tcp.srcport}'
+        checkDFilterCount(dfilter, 0)
@@ -360,6 +360,40 @@ class case_dissect_tcp(subprocesstest.SubprocessTestCase):
             '-Ytls', '-Tfields', '-eframe.number', '-etls.record.length', '-2'))
         self.assertEqual(proc.stdout_str, '2\t16\n')
 
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_dissect_heuristics(subprocesstest.SubprocessTestCase):
+    def test_heuristics_twopass(self, cmd_tshark, capture_file):
+        '''Remembering which heuristic dissector took a conversation must not
+        change what the second pass finds.'''
+        proc = self.assertRun((cmd_tshark,
+                '-r', capture_file('dtls12-aes128ccm8.pcap'),
+                '-Y', 'dtls',
+            ))
+        onepass_lines = proc.stdout_str.splitlines()
+        self.assertTrue(len(onepass_lines) > 0)
+        proc = self.assertRun((cmd_tshark,
+                '-r', capture_file('dtls12-aes128ccm8.pcap'),
+                '-Y', 'dtls',
+                '-2',
+            ))
+        self.assertEqual(len(proc.stdout_str.splitlines()), len(onepass_lines))
+
+    def test_heuristics_z_heur_stat(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark,
+                '-q', '-z', 'heur,stat',
+                '-r', capture_file('dtls12-aes128ccm8.pcap'),
+            ))
+        self.assertTrue(self.grepOutput('Heuristic Dissector Statistics'))
+        self.assertTrue(self.grepOutput(r'^udp\s+dtls_udp\s+[1-9]\d*\s+\d+\s+\d+$'))
+
+    def test_heuristics_z_heur_stat_invalid(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark,
+                '-q', '-z', 'heur,stat,bogus',
+                '-r', capture_file('dtls12-aes128ccm8.pcap'),
+            ), expected_return=self.exit_command_line)
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_dissect_tls(subprocesstest.SubprocessTestCase):
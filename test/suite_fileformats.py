@@ -64,6 +64,42 @@ class case_fileformat_pcap(subprocesstest.SubprocessTestCase):
         self.assertTrue(self.diffOutput(capture_proc.stdout_str, fileformats_baseline_str, 'tshark', baseline_file))
 
 
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_fileformat_compressed(subprocesstest.SubprocessTestCase):
+    def check_compressed(self, cmd_tshark, capture_file, fileformats_baseline_str, pcap_file):
+        '''Compressed pcap direct, stdin and two-pass vs microsecond pcap direct'''
+        for args, shell in (
+                (('-r', capture_file(pcap_file)), False),
+                (('-r', '-', '<', capture_file(pcap_file)), True),
+                (('-2', '-r', capture_file(pcap_file)), False),
+            ):
+            cmd = (cmd_tshark,
+                '-Tfields',
+                '-e', 'frame.number', '-e', 'frame.time_epoch', '-e', 'frame.time_delta',
+                ) + args
+            if shell:
+                cmd = ' '.join(cmd)
+            capture_proc = self.assertRun(cmd, shell=shell)
+            self.assertTrue(self.diffOutput(capture_proc.stdout_str, fileformats_baseline_str, 'tshark', baseline_file))
+
+    def test_pcap_zstd(self, cmd_tshark, capture_file, features, fileformats_baseline_str):
+        if not features.have_zstd:
+            self.skipTest('Requires Zstandard.')
+        self.check_compressed(cmd_tshark, capture_file, fileformats_baseline_str, 'dhcp.pcap.zst')
+
+    def test_pcap_zstd_frames(self, cmd_tshark, capture_file, features, fileformats_baseline_str):
+        '''A zstd file with a frame for each record.'''
+        if not features.have_zstd:
+            self.skipTest('Requires Zstandard.')
+        self.check_compressed(cmd_tshark, capture_file, fileformats_baseline_str, 'dhcp-frames.pcap.zst')
+
+    def test_pcap_lz4(self, cmd_tshark, capture_file, features, fileformats_baseline_str):
+        if not features.have_lz4:
+            self.skipTest('Requires LZ4.')
+        self.check_compressed(cmd_tshark, capture_file, fileformats_baseline_str, 'dhcp.pcap.lz4')
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_fileformat_pcapng(subprocesstest.SubprocessTestCase):
@@ -69,6 +69,17 @@ class case_tshark_io(subprocesstest.SubprocessTestCase):
         '''Read direct and write direct using TShark'''
         check_io_4_packets(self, capture_file, cmd=cmd_tshark)
 
+    def test_tshark_io_two_pass_pcapng_tree(self, cmd_tshark, capture_file):
+        '''Read a pcapng file in two passes with a protocol tree'''
+        # The frame dissector looks up the interface name while the
+        # second pass reads ahead on another thread.
+        self.assertRun((cmd_tshark,
+            '-2', '-V',
+            '-r', capture_file('dhcp.pcapng'),
+        ))
+        self.assertEqual(self.countOutput(r'^Frame \d+:'), 4)
+        self.assertTrue(self.grepOutput(r'Interface id: 0'))
+
 
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
@@ -93,3 +93,76 @@ class case_outputformats(subprocesstest.SubprocessTestCase):
         ''' Check that the option -j works with -Tek.'''
         check_outputformat("ek", extra_args=['-j', 'dhcp'], expected="dhcp-filter.ek",
             multiline=True)
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_outputformat_arrow(subprocesstest.SubprocessTestCase):
+    def run_arrow(self, cmd_tshark, capture_file, extra_args):
+        '''Write dhcp.pcap as Arrow to a file, and return its contents.'''
+        arrow_file = self.filename_from_id('testout.arrow')
+        # The output is binary, so don't read it from stdout_str.
+        self.assertRun('"{}" -r "{}" -T arrow {} > "{}"'.format(
+            cmd_tshark, capture_file('dhcp.pcap'), ' '.join(extra_args), arrow_file),
+            shell=True)
+        with open(arrow_file, 'rb') as f:
+            return arrow_file, f.read()
+
+    def read_arrow(self, arrow_file):
+        try:
+            import pyarrow.ipc
+        except ImportError:
+            self.skipTest('Requires pyarrow.')
+        reader = pyarrow.ipc.open_file(arrow_file)
+        return reader, reader.read_all()
+
+    def test_outputformat_arrow_magic(self, cmd_tshark, capture_file):
+        '''The output starts and ends with the Arrow file magic.'''
+        arrow_file, data = self.run_arrow(cmd_tshark, capture_file,
+            ['-e', 'frame.number', '-e', 'ip.src'])
+        self.assertTrue(data.startswith(b'ARROW1\0\0'))
+        self.assertTrue(data.endswith(b'ARROW1'))
+
+    def test_outputformat_arrow_batches(self, cmd_tshark, capture_file):
+        '''Rows are split into record batches of the requested size.'''
+        arrow_file, data = self.run_arrow(cmd_tshark, capture_file,
+            ['-E', 'occurrence=f', '-E', 'batch=3',
+             '-e', 'frame.number', '-e', 'ip.src', '-e', 'udp.length'])
+        reader, table = self.read_arrow(arrow_file)
+        self.assertEqual(reader.num_record_batches, 2)
+        self.assertEqual(table.column_names, ['frame.number', 'ip.src', 'udp.length'])
+        self.assertEqual(table.column('frame.number').to_pylist(), [1, 2, 3, 4])
+        self.assertEqual(table.column('ip.src').to_pylist(),
+            [0x00000000, 0xc0a80001, 0x00000000, 0xc0a80001])
+        table.validate(full=True)
+
+    def test_outputformat_arrow_lists(self, cmd_tshark, capture_file):
+        '''All occurrences of a field make a list column.'''
+        arrow_file, data = self.run_arrow(cmd_tshark, capture_file,
+            ['-e', 'frame.number', '-e', 'dhcp.option.type'])
+        reader, table = self.read_arrow(arrow_file)
+        self.assertEqual(reader.num_record_batches, 1)
+        self.assertEqual(table.column('frame.number').to_pylist(), [[1], [2], [3], [4]])
+        for options in table.column('dhcp.option.type').to_pylist():
+            self.assertGreater(len(options), 1)
+            self.assertEqual(options[-1], 255)
+        table.validate(full=True)
+
+    def test_outputformat_arrow_duplicate_fields(self, cmd_tshark, capture_file):
+        '''A field or column given twice fills both of its columns.'''
+        arrow_file, data = self.run_arrow(cmd_tshark, capture_file,
+            ['-E', 'occurrence=l',
+             '-e', 'frame.number', '-e', '_ws.col.Protocol',
+             '-e', 'frame.number', '-e', '_ws.col.Protocol'])
+        reader, table = self.read_arrow(arrow_file)
+        columns = [column.to_pylist() for column in table.columns]
+        self.assertEqual(columns[0], [1, 2, 3, 4])
+        self.assertEqual(columns[2], columns[0])
+        self.assertEqual(columns[1], ['DHCP'] * 4)
+        self.assertEqual(columns[3], columns[1])
+        table.validate(full=True)
+
+    def test_outputformat_arrow_bad_batch(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark, '-r', capture_file('dhcp.pcap'),
+            '-T', 'arrow', '-E', 'batch=0', '-e', 'frame.number'),
+            expected_return=self.exit_command_line)
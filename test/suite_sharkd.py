@@ -25,9 +25,9 @@ def cmd_sharkd(program):
 def run_sharkd_session(cmd_sharkd, request):
     self = request.instance
 
-    def run_sharkd_session_real(sharkd_commands):
+    def run_sharkd_session_real(sharkd_commands, sharkd_args=('-',)):
         sharkd_proc = self.startProcess(
-            (cmd_sharkd, '-'), stdin=subprocess.PIPE)
+            (cmd_sharkd,) + tuple(sharkd_args), stdin=subprocess.PIPE)
         sharkd_proc.stdin.write('\n'.join(sharkd_commands).encode('utf8'))
         self.waitProcess(sharkd_proc)
 
@@ -51,9 +51,9 @@ def run_sharkd_session(cmd_sharkd, request):
 def check_sharkd_session(run_sharkd_session, request):
     self = request.instance
 
-    def check_sharkd_session_real(sharkd_commands, expected_outputs):
+    def check_sharkd_session_real(sharkd_commands, expected_outputs, sharkd_args=('-',)):
         sharkd_commands = [json.dumps(x) for x in sharkd_commands]
-        actual_outputs = run_sharkd_session(sharkd_commands)
+        actual_outputs = run_sharkd_session(sharkd_commands, sharkd_args)
         self.assertEqual(expected_outputs, actual_outputs)
     return check_sharkd_session_real
 
@@ -85,6 +85,35 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
                 "filename": "dhcp.pcap", "filesize": 1400},
         ))
 
+    def test_sharkd_preload(self, check_sharkd_session, capture_file):
+        '''sharkd -r loads the file before the first request.'''
+        check_sharkd_session((
+            {"req": "status"},
+            {"req": "load", "file": capture_file('dhcp.pcap')},
+            {"req": "status"},
+        ), (
+            {"frames": 4, "duration": 0.070345000,
+                "filename": "dhcp.pcap", "filesize": 1400},
+            {"err": 0},
+            {"frames": 4, "duration": 0.070345000,
+                "filename": "dhcp.pcap", "filesize": 1400},
+        ), sharkd_args=('-r', capture_file('dhcp.pcap')))
+
+    def test_sharkd_preload_other_file(self, check_sharkd_session, capture_file):
+        '''Loading another file replaces the one loaded by sharkd -r.'''
+        check_sharkd_session((
+            {"req": "load", "file": capture_file('dhcp.pcapng')},
+            {"req": "status"},
+        ), (
+            {"err": 0},
+            {"frames": 4, "duration": MatchAny(float),
+                "filename": "dhcp.pcapng", "filesize": MatchAny(int)},
+        ), sharkd_args=('-r', capture_file('dhcp.pcap')))
+
+    def test_sharkd_preload_bad_pcap(self, cmd_sharkd, capture_file):
+        self.assertRun((cmd_sharkd, '-r', capture_file('non-existant.pcap')),
+            expected_return=1)
+
     def test_sharkd_req_analyse(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"req": "load", "file": capture_file('dhcp.pcap')},
@@ -132,6 +161,20 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
             {"err": 0, "filter": "ok", "field": "ok"},
         ))
 
+    def test_sharkd_req_check_long(self, check_sharkd_session, capture_file):
+        # Longer than the 2 KiB that requests used to be cut into.
+        long_filter = ' || '.join(['frame.number == %d' % i for i in range(1, 200)])
+        self.assertGreater(len(long_filter), 2 * 1024)
+        check_sharkd_session((
+            {"req": "load", "file": capture_file('dhcp.pcap')},
+            {"req": "check", "filter": long_filter},
+            {"req": "check", "filter": "ip"},
+        ), (
+            {"err": 0},
+            {"err": 0, "filter": "ok"},
+            {"err": 0, "filter": "ok"},
+        ))
+
     def test_sharkd_req_complete_field(self, check_sharkd_session):
         check_sharkd_session((
             {"req": "complete"},
@@ -169,6 +212,30 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
             }),
         ))
 
+    def test_sharkd_req_frames_cursor(self, run_sharkd_session, capture_file):
+        '''Pages listed with a cursor continue where the previous one ended.'''
+        pages = (
+            {"req": "frames", "limit": 2},
+            {"req": "frames", "limit": 2, "cursor": 2},
+            {"req": "frames", "limit": 2, "cursor": 4},
+            {"req": "frames", "filter": "udp.srcport == 68"},
+            {"req": "frames", "filter": "udp.srcport == 68", "limit": 1, "cursor": 0},
+            {"req": "frames", "filter": "udp.srcport == 68", "limit": 1, "cursor": 1},
+            {"req": "frames", "filter": "udp.srcport == 68", "limit": 1, "cursor": 3},
+            {"req": "frames"},
+        )
+        outputs = run_sharkd_session(
+            [json.dumps(x) for x in ({"req": "load", "file": capture_file('dhcp.pcap')},) + pages])
+        self.assertEqual(len(outputs), 1 + len(pages))
+        self.assertEqual(outputs[0], {"err": 0})
+        frame_nums = [[frame["num"] for frame in output] for output in outputs[1:]]
+        self.assertEqual(frame_nums[0:3], [[1, 2], [3, 4], []])
+        self.assertEqual(frame_nums[3], [1, 3])
+        self.assertEqual(frame_nums[4:7], [[1], [3], []])
+        # The pages are the same as the full listings, columns included.
+        self.assertEqual(outputs[1] + outputs[2], outputs[8])
+        self.assertEqual(outputs[5] + outputs[6], outputs[4])
+
     def test_sharkd_req_tap_invalid(self, check_sharkd_session, capture_file):
         # XXX Unrecognized taps result in an empty line, modify
         #     run_sharkd_session such that checking for it is possible.
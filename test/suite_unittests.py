@@ -23,6 +23,10 @@ class case_unittests(subprocesstest.SubprocessTestCase):
         '''exntest'''
         self.assertRun(program('exntest'), env=base_env)
 
+    def test_unit_filter_results_test(self, program, base_env):
+        '''filter_results_test'''
+        self.assertRun(program('filter_results_test'), env=base_env)
+
     def test_unit_oids_test(self, program, base_env):
         '''oids_test'''
         self.assertRun(program('oids_test'), env=base_env)
@@ -47,6 +51,14 @@ class case_unittests(subprocesstest.SubprocessTestCase):
             '--verbose'
         ), env=base_env)
 
+    def test_unit_ws_memmem_test(self, program, base_env):
+        '''ws_memmem_test'''
+        self.assertRun(program('ws_memmem_test'), env=base_env)
+
+    def test_unit_ws_regex_test(self, program, base_env):
+        '''ws_regex_test'''
+        self.assertRun(program('ws_regex_test'), env=base_env)
+
     def test_unit_fieldcount(self, cmd_tshark, test_env):
         '''fieldcount'''
         self.assertRun((cmd_tshark, '-G', 'fieldcount'), env=test_env)
@@ -35,6 +35,7 @@
 
 #ifdef _WIN32
 # include <winsock2.h>
+# include <io.h>       /* for _setmode */
 #endif
 
 #ifndef _WIN32
@@ -93,6 +94,7 @@
 #include <epan/epan_dissect.h>
 #include <epan/tap.h>
 #include <epan/stat_tap_ui.h>
+#include <epan/conversation.h>
 #include <epan/conversation_table.h>
 #include <epan/srt_table.h>
 #include <epan/rtd_table.h>
@@ -143,6 +145,8 @@
 #define LONGOPT_COLOR                   LONGOPT_BASE_APPLICATION+2
 #define LONGOPT_NO_DUPLICATE_KEYS       LONGOPT_BASE_APPLICATION+3
 #define LONGOPT_ELASTIC_MAPPING_FILTER  LONGOPT_BASE_APPLICATION+4
+#define LONGOPT_MAX_CONVERSATIONS       LONGOPT_BASE_APPLICATION+5
+#define LONGOPT_MAX_SESSION_MEMORY      LONGOPT_BASE_APPLICATION+6
 
 #if 0
 #define tshark_debug(...) g_warning(__VA_ARGS__)
@@ -160,6 +164,9 @@ static frame_data prev_cap_frame;
 static gboolean perform_two_pass_analysis;
 static guint32 epan_auto_reset_count = 0;
 static gboolean epan_auto_reset = FALSE;
+static guint32 epan_auto_reset_conversations = 0;
+static guint32 epan_auto_reset_memory = 0;        /* in megabytes */
+static guint32 epan_auto_reset_sessions = 0;      /* number of resets done */
 
 /*
  * The way the packet decode is to be written.
@@ -171,7 +178,8 @@ typedef enum {
   WRITE_FIELDS,   /* User defined list of fields */
   WRITE_JSON,     /* JSON */
   WRITE_JSON_RAW, /* JSON only raw hex */
-  WRITE_EK        /* JSON bulk insert to Elasticsearch */
+  WRITE_EK,       /* JSON bulk insert to Elasticsearch */
+  WRITE_ARROW     /* User defined list of fields, as Arrow columns */
   /* Add CSV and the like here */
 } output_action_e;
 
@@ -258,6 +266,7 @@ static process_file_status_t process_cap_file(capture_file *, char *, int, gbool
 static gboolean process_packet_single_pass(capture_file *cf,
     epan_dissect_t *edt, gint64 offset, wtap_rec *rec, Buffer *buf,
     guint tap_flags);
+static void show_print_error(int err);
 static void show_print_file_io_error(int err);
 static gboolean write_preamble(capture_file *cf);
 static gboolean print_packet(capture_file *cf, epan_dissect_t *edt);
@@ -396,6 +405,12 @@ print_usage(FILE *output)
   fprintf(output, "Processing:\n");
   fprintf(output, "  -2                       perform a two-pass analysis\n");
   fprintf(output, "  -M <packet count>        perform session auto reset\n");
+  fprintf(output, "  --max-conversations <count>\n");
+  fprintf(output, "                           perform session auto reset when more than <count>\n");
+  fprintf(output, "                           conversations are being tracked\n");
+  fprintf(output, "  --max-session-memory <megabytes>\n");
+  fprintf(output, "                           perform session auto reset when more than\n");
+  fprintf(output, "                           <megabytes> MB are used for per-file state\n");
   fprintf(output, "  -R <read filter>, --read-filter <read filter>\n");
   fprintf(output, "                           packet Read filter in Wireshark display filter syntax\n");
   fprintf(output, "                           (requires -2)\n");
@@ -451,6 +466,7 @@ print_usage(FILE *output)
   fprintf(output, "     aggregator=,|/s|<char> select comma, space, printable character as\n");
   fprintf(output, "                           aggregator\n");
   fprintf(output, "     quote=d|s|n           select double, single, no quotes for values\n");
+  fprintf(output, "     batch=<rows>          rows per record batch with -Tarrow\n");
   fprintf(output, "  -t a|ad|adoy|d|dd|e|r|u|ud|udoy\n");
   fprintf(output, "                           output format of time stamps (def: r: rel. to first)\n");
   fprintf(output, "  -u s|hms                 output format of seconds (def: s: seconds)\n");
@@ -712,6 +728,8 @@ main(int argc, char *argv[])
     {"color", no_argument, NULL, LONGOPT_COLOR},
     {"no-duplicate-keys", no_argument, NULL, LONGOPT_NO_DUPLICATE_KEYS},
     {"elastic-mapping-filter", required_argument, NULL, LONGOPT_ELASTIC_MAPPING_FILTER},
+    {"max-conversations", required_argument, NULL, LONGOPT_MAX_CONVERSATIONS},
+    {"max-session-memory", required_argument, NULL, LONGOPT_MAX_SESSION_MEMORY},
     {0, 0, 0, 0 }
   };
   gboolean             arg_error = FALSE;
@@ -1101,7 +1119,7 @@ main(int argc, char *argv[])
   while ((opt = getopt_long(argc, argv, optstring, long_options, NULL)) != -1) {
     switch (opt) {
     case '2':        /* Perform two pass analysis */
-      if(epan_auto_reset){
+      if(epan_auto_reset || epan_auto_reset_conversations || epan_auto_reset_memory){
         cmdarg_err("-2 does not support auto session reset.");
         arg_error=TRUE;
       }
@@ -1115,6 +1133,20 @@ main(int argc, char *argv[])
       epan_auto_reset_count = get_positive_int(optarg, "epan reset count");
       epan_auto_reset = TRUE;
       break;
+    case LONGOPT_MAX_CONVERSATIONS:
+      if(perform_two_pass_analysis){
+        cmdarg_err("--max-conversations does not support two pass analysis.");
+        arg_error=TRUE;
+      }
+      epan_auto_reset_conversations = get_positive_int(optarg, "maximum number of conversations");
+      break;
+    case LONGOPT_MAX_SESSION_MEMORY:
+      if(perform_two_pass_analysis){
+        cmdarg_err("--max-session-memory does not support two pass analysis.");
+        arg_error=TRUE;
+      }
+      epan_auto_reset_memory = get_positive_int(optarg, "maximum session memory");
+      break;
     case 'a':        /* autostop criteria */
     case 'b':        /* Ringbuffer option */
     case 'f':        /* capture filter */
@@ -1381,11 +1413,17 @@ main(int argc, char *argv[])
         output_action = WRITE_JSON_RAW;
         print_details = TRUE;   /* Need details */
         print_summary = FALSE;  /* Don't allow summary */
+      } else if (strcmp(optarg, "arrow") == 0) {
+        output_action = WRITE_ARROW;
+        print_details = TRUE;   /* Need full tree info */
+        print_summary = FALSE;  /* Don't allow summary */
       }
       else {
         cmdarg_err("Invalid -T parameter \"%s\"; it must be one of:", optarg);                   /* x */
         cmdarg_err_cont("\t\"fields\"  The values of fields specified with the -e option, in a form\n"
                         "\t          specified by the -E option.\n"
+                        "\t\"arrow\"   The values of fields specified with the -e option, as typed\n"
+                        "\t          columns in an Apache Arrow IPC file.\n"
                         "\t\"pdml\"    Packet Details Markup Language, an XML-based format for the\n"
                         "\t          details of a decoded packet. This information is equivalent to\n"
                         "\t          the packet details printed with the -V flag.\n"
@@ -1549,14 +1587,15 @@ main(int argc, char *argv[])
   }
 
   /* If we specified output fields, but not the output field type... */
-  if ((WRITE_FIELDS != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action) && 0 != output_fields_num_fields(output_fields)) {
+  if ((WRITE_FIELDS != output_action && WRITE_ARROW != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action) && 0 != output_fields_num_fields(output_fields)) {
         cmdarg_err("Output fields were specified with \"-e\", "
-            "but \"-Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
+            "but \"-Tarrow, -Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
         exit_status = INVALID_OPTION;
         goto clean_exit;
-  } else if (WRITE_FIELDS == output_action && 0 == output_fields_num_fields(output_fields)) {
-        cmdarg_err("\"-Tfields\" was specified, but no fields were "
-                    "specified with \"-e\".");
+  } else if ((WRITE_FIELDS == output_action || WRITE_ARROW == output_action) && 0 == output_fields_num_fields(output_fields)) {
+        cmdarg_err("\"-T%s\" was specified, but no fields were "
+                    "specified with \"-e\".",
+                    WRITE_FIELDS == output_action ? "fields" : "arrow");
 
         exit_status = INVALID_OPTION;
         goto clean_exit;
@@ -2261,7 +2300,7 @@ main(int argc, char *argv[])
 
     if (print_packet_info) {
       if (!write_preamble(&cfile)) {
-        show_print_file_io_error(errno);
+        show_print_error(errno);
         exit_status = INVALID_FILE;
         goto clean_exit;
       }
@@ -2299,7 +2338,7 @@ main(int argc, char *argv[])
 
     if (print_packet_info) {
       if (!write_finale()) {
-        show_print_file_io_error(errno);
+        show_print_error(errno);
       }
     }
 
@@ -2324,6 +2363,9 @@ main(int argc, char *argv[])
 
   if (draw_taps)
     draw_tap_listeners(TRUE);
+  if (epan_auto_reset_sessions != 0 && !really_quiet)
+    fprintf(stderr, "%u session reset%s\n", epan_auto_reset_sessions,
+            plurality(epan_auto_reset_sessions, "", "s"));
   /* Memory cleanup */
   reset_tap_listeners();
   funnel_dump_all_text_windows();
@@ -2486,6 +2528,7 @@ tshark_epan_new(capture_file *cf)
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
     NULL,
+    NULL,
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -3212,6 +3255,7 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
 {
   column_info    *cinfo;
   gboolean        passed;
+  gboolean        printed;
 
   /* If we're not running a display filter and we're not printing any
      packet information, we don't need to do a dissection. This means
@@ -3269,7 +3313,7 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
     if (print_packet_info) {
       /* We're printing packet information; print the information for
          this packet. */
-      print_packet(cf, edt);
+      printed = print_packet(cf, edt);
 
       /* If we're doing "line-buffering", flush the standard output
          after every packet.  See the comment above, for the "-l"
@@ -3277,8 +3321,8 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
       if (line_buffered)
         fflush(stdout);
 
-      if (ferror(stdout)) {
-        show_print_file_io_error(errno);
+      if (!printed || ferror(stdout)) {
+        show_print_error(errno);
         exit(2);
       }
     }
@@ -3315,19 +3359,165 @@ process_new_idbs(wtap *wth, wtap_dumper *pdh, int *err, gchar **err_info)
   return TRUE;
 }
 
+/*
+ * Read-ahead for the second pass.
+ *
+ * After the first pass, the frame_data_sequence is complete and is only
+ * read from, so a reader thread can walk it and do the random-access
+ * wiretap reads for upcoming frames while the main thread dissects and
+ * prints the current one.  Records are handed over through a ring of
+ * SECOND_PASS_READ_AHEAD slots, consumed strictly in frame order, so the
+ * output is identical to that of a purely serial pass.
+ *
+ * Dissection itself stays on the main thread; the only state shared
+ * with the reader is the random-access side of the wtap handle, which
+ * is serialized with wth_mutex (frame_tvbuff takes it too if it has to
+ * re-read a frame).
+ */
+#define SECOND_PASS_READ_AHEAD 256
+
+typedef struct {
+  wtap_rec  rec;
+  Buffer    buf;
+  gboolean  ok;
+  int       err;
+  gchar    *err_info;
+} read_ahead_slot_t;
+
+typedef struct {
+  capture_file      *cf;
+  read_ahead_slot_t  slots[SECOND_PASS_READ_AHEAD];
+  guint32            next_read;     /* next frame the reader will fill */
+  guint32            next_consume;  /* next frame the main thread wants */
+  gboolean           stop;
+  GMutex             lock;
+  GCond              cond;
+  GMutex             wth_mutex;
+} read_ahead_t;
+
+static gpointer
+read_ahead_thread(gpointer data)
+{
+  read_ahead_t      *ra = (read_ahead_t *)data;
+  capture_file      *cf = ra->cf;
+  guint32            framenum;
+  frame_data        *fdata;
+  read_ahead_slot_t *slot;
+  gboolean           ok;
+
+  for (framenum = 1; framenum <= cf->count; framenum++) {
+    g_mutex_lock(&ra->lock);
+    while (!ra->stop && framenum - ra->next_consume >= SECOND_PASS_READ_AHEAD)
+      g_cond_wait(&ra->cond, &ra->lock);
+    if (ra->stop) {
+      g_mutex_unlock(&ra->lock);
+      break;
+    }
+    g_mutex_unlock(&ra->lock);
+
+    slot = &ra->slots[framenum % SECOND_PASS_READ_AHEAD];
+    fdata = frame_data_sequence_find(cf->provider.frames, framenum);
+    g_mutex_lock(&ra->wth_mutex);
+    ok = wtap_seek_read(cf->provider.wth, fdata->file_off, &slot->rec,
+                        &slot->buf, &slot->err, &slot->err_info);
+    g_mutex_unlock(&ra->wth_mutex);
+    slot->ok = ok;
+
+    g_mutex_lock(&ra->lock);
+    ra->next_read = framenum + 1;
+    g_cond_broadcast(&ra->cond);
+    g_mutex_unlock(&ra->lock);
+
+    if (!ok)
+      break;
+  }
+  return NULL;
+}
+
+/*
+ * Wait for the reader to fill the slot for framenum and return it.
+ */
+static read_ahead_slot_t *
+read_ahead_get(read_ahead_t *ra, guint32 framenum)
+{
+  g_mutex_lock(&ra->lock);
+  while (ra->next_read <= framenum)
+    g_cond_wait(&ra->cond, &ra->lock);
+  g_mutex_unlock(&ra->lock);
+  return &ra->slots[framenum % SECOND_PASS_READ_AHEAD];
+}
+
+/*
+ * Hand the slot for framenum back to the reader.
+ */
+static void
+read_ahead_release(read_ahead_t *ra, guint32 framenum)
+{
+  g_mutex_lock(&ra->lock);
+  ra->next_consume = framenum + 1;
+  g_cond_broadcast(&ra->cond);
+  g_mutex_unlock(&ra->lock);
+}
+
+static read_ahead_t *
+read_ahead_start(capture_file *cf, GThread **thread)
+{
+  read_ahead_t *ra = g_new0(read_ahead_t, 1);
+  guint         i;
+
+  ra->cf = cf;
+  ra->next_read = 1;
+  ra->next_consume = 1;
+  for (i = 0; i < SECOND_PASS_READ_AHEAD; i++) {
+    wtap_rec_init(&ra->slots[i].rec);
+    ws_buffer_init(&ra->slots[i].buf, 1514);
+  }
+  g_mutex_init(&ra->lock);
+  g_cond_init(&ra->cond);
+  g_mutex_init(&ra->wth_mutex);
+  cf->provider.wth_mutex = &ra->wth_mutex;
+
+  *thread = g_thread_new("tshark read-ahead", read_ahead_thread, ra);
+  return ra;
+}
+
+static void
+read_ahead_finish(read_ahead_t *ra, GThread *thread)
+{
+  guint i;
+
+  g_mutex_lock(&ra->lock);
+  ra->stop = TRUE;
+  g_cond_broadcast(&ra->cond);
+  g_mutex_unlock(&ra->lock);
+  g_thread_join(thread);
+
+  ra->cf->provider.wth_mutex = NULL;
+  for (i = 0; i < SECOND_PASS_READ_AHEAD; i++) {
+    g_free(ra->slots[i].err_info);
+    ws_buffer_free(&ra->slots[i].buf);
+    wtap_rec_cleanup(&ra->slots[i].rec);
+  }
+  g_mutex_clear(&ra->wth_mutex);
+  g_cond_clear(&ra->cond);
+  g_mutex_clear(&ra->lock);
+  g_free(ra);
+}
+
 static pass_status_t
 process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
                              int *err, gchar **err_info,
                              volatile guint32 *err_framenum)
 {
-  wtap_rec        rec;
-  Buffer          buf;
-  guint32         framenum;
-  frame_data     *fdata;
-  gboolean        filtering_tap_listeners;
-  guint           tap_flags;
-  epan_dissect_t *edt = NULL;
-  pass_status_t   status = PASS_SUCCEEDED;
+  read_ahead_t      *ra;
+  GThread           *ra_thread;
+  read_ahead_slot_t *slot;
+  guint32            framenum;
+  frame_data        *fdata;
+  gboolean           filtering_tap_listeners;
+  guint              tap_flags;
+  epan_dissect_t    *edt = NULL;
+  pass_status_t      status = PASS_SUCCEEDED;
 
   /*
    * Process whatever IDBs we haven't seen yet.  This will be all
@@ -3339,9 +3529,6 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
     return PASS_WRITE_ERROR;
   }
 
-  wtap_rec_init(&rec);
-  ws_buffer_init(&buf, 1514);
-
   /* Do we have any tap listeners with filters? */
   filtering_tap_listeners = have_filtering_tap_listeners();
 
@@ -3383,26 +3570,31 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
    */
   set_resolution_synchrony(TRUE);
 
+  ra = read_ahead_start(cf, &ra_thread);
+
   for (framenum = 1; framenum <= cf->count; framenum++) {
     if (read_interrupted) {
       status = PASS_INTERRUPTED;
       break;
     }
     fdata = frame_data_sequence_find(cf->provider.frames, framenum);
-    if (!wtap_seek_read(cf->provider.wth, fdata->file_off, &rec, &buf, err,
-                        err_info)) {
+    slot = read_ahead_get(ra, framenum);
+    if (!slot->ok) {
       /* Error reading from the input file. */
+      *err = slot->err;
+      *err_info = slot->err_info;
+      slot->err_info = NULL;
       status = PASS_READ_ERROR;
       break;
     }
     tshark_debug("tshark: invoking process_packet_second_pass() for frame #%d", framenum);
-    if (process_packet_second_pass(cf, edt, fdata, &rec, &buf, tap_flags)) {
+    if (process_packet_second_pass(cf, edt, fdata, &slot->rec, &slot->buf, tap_flags)) {
       /* Either there's no read filtering or this packet passed the
          filter, so, if we're writing to a capture file, write
          this packet out. */
       if (pdh != NULL) {
         tshark_debug("tshark: writing packet #%d to outfile", framenum);
-        if (!wtap_dump(pdh, &rec, ws_buffer_start_ptr(&buf), err, err_info)) {
+        if (!wtap_dump(pdh, &slot->rec, ws_buffer_start_ptr(&slot->buf), err, err_info)) {
           /* Error writing to the output file. */
           tshark_debug("tshark: error writing to a capture file (%d)", *err);
           *err_framenum = framenum;
@@ -3411,14 +3603,14 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
         }
       }
     }
+    read_ahead_release(ra, framenum);
   }
 
+  read_ahead_finish(ra, ra_thread);
+
   if (edt)
     epan_dissect_free(edt);
 
-  ws_buffer_free(&buf);
-  wtap_rec_cleanup(&rec);
-
   return status;
 }
 
@@ -3603,7 +3795,7 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
     /* Set up to print packet information. */
     if (print_packet_info) {
       if (!write_preamble(cf)) {
-        show_print_file_io_error(errno);
+        show_print_error(errno);
         status = PROCESS_FILE_NO_FILE_PROCESSED;
         goto out;
       }
@@ -3784,7 +3976,7 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
   } else {
     if (print_packet_info) {
       if (!write_finale()) {
-        show_print_file_io_error(errno);
+        show_print_error(errno);
         status = PROCESS_FILE_ERROR;
       }
     }
@@ -3806,6 +3998,7 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
   frame_data      fdata;
   column_info    *cinfo;
   gboolean        passed;
+  gboolean        printed;
 
   /* Count this packet. */
   cf->count++;
@@ -3875,7 +4068,7 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
       /* We're printing packet information; print the information for
          this packet. */
       g_assert(edt);
-      print_packet(cf, edt);
+      printed = print_packet(cf, edt);
 
       /* If we're doing "line-buffering", flush the standard output
          after every packet.  See the comment above, for the "-l"
@@ -3883,8 +4076,8 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
       if (line_buffered)
         fflush(stdout);
 
-      if (ferror(stdout)) {
-        show_print_file_io_error(errno);
+      if (!printed || ferror(stdout)) {
+        show_print_error(errno);
         exit(2);
       }
     }
@@ -3923,6 +4116,12 @@ write_preamble(capture_file *cf)
     write_fields_preamble(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_ARROW:
+#ifdef _WIN32
+    _setmode(1, O_BINARY);
+#endif
+    return write_arrow_preamble(output_fields, stdout) && !ferror(stdout);
+
   case WRITE_JSON:
   case WRITE_JSON_RAW:
     jdumper = write_json_preamble(stdout);
@@ -4006,7 +4205,7 @@ print_columns(capture_file *cf, const epan_dissect_t *edt)
   *line_bufp = '\0';
 
   if (dissect_color)
-    color_filter = edt->pi.fd->color_filter;
+    color_filter = color_filters_get_frame_filter(edt->pi.fd);
 
   for (i = 0; i < cf->cinfo.num_cols; i++) {
     col_item = &cf->cinfo.columns[i];
@@ -4276,6 +4475,10 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
     }
     break;
 
+  case WRITE_ARROW:
+    return write_arrow_proto_tree(output_fields, edt, &cf->cinfo, stdout) &&
+           !ferror(stdout);
+
   case WRITE_JSON:
     if (print_summary)
       g_assert_not_reached();
@@ -4283,6 +4486,8 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
       write_json_proto_tree(output_fields, print_dissections_expanded,
                             print_hex, protocolfilter, protocolfilter_flags,
                             edt, &cf->cinfo, node_children_grouper, &jdumper);
+      if (line_buffered)
+        json_dumper_flush(&jdumper);
       return !ferror(stdout);
     }
     break;
@@ -4294,6 +4499,8 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
       write_json_proto_tree(output_fields, print_dissections_none, TRUE,
                             protocolfilter, protocolfilter_flags,
                             edt, &cf->cinfo, node_children_grouper, &jdumper);
+      if (line_buffered)
+        json_dumper_flush(&jdumper);
       return !ferror(stdout);
     }
     break;
@@ -4339,6 +4546,9 @@ write_finale(void)
     write_fields_finale(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_ARROW:
+    return write_arrow_finale(output_fields, stdout) && !ferror(stdout);
+
   case WRITE_JSON:
   case WRITE_JSON_RAW:
     write_json_finale(&jdumper);
@@ -4430,6 +4640,22 @@ fail:
   return CF_ERROR;
 }
 
+/*
+ * Report a failure to print packets, or the preamble or finale: an I/O
+ * error if there was one, otherwise the output format couldn't hold
+ * what we had to print.
+ */
+static void
+show_print_error(int err)
+{
+  if (output_action == WRITE_ARROW && !ferror(stdout)) {
+    cmdarg_err("Not all the packets could be printed because a packet had "
+"more data than an Arrow record batch can hold.");
+  } else {
+    show_print_file_io_error(err);
+  }
+}
+
 static void
 show_print_file_io_error(int err)
 {
@@ -4516,10 +4742,15 @@ write_failure_message(const char *filename, int err)
 
 static void reset_epan_mem(capture_file *cf,epan_dissect_t *edt, gboolean tree, gboolean visual)
 {
-  if (!epan_auto_reset || (cf->count < epan_auto_reset_count))
+  if ((!epan_auto_reset || (cf->count < epan_auto_reset_count)) &&
+      (!epan_auto_reset_conversations || (conversation_count() <= epan_auto_reset_conversations)) &&
+      (!epan_auto_reset_memory || (wmem_allocator_size(wmem_file_scope()) <= (gsize)epan_auto_reset_memory * 1024 * 1024)))
     return;
 
+  /* Conversations can't be dropped one by one, as the dissectors keep
+     pointers to them in their own state; the whole session goes. */
   fprintf(stderr, "resetting session.\n");
+  epan_auto_reset_sessions++;
 
   epan_dissect_cleanup(edt);
   epan_free(cf->epan);
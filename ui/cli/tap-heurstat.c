@@ -0,0 +1,135 @@
+/* tap-heurstat.c
+ * Heuristic dissector statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* This module shows how often each heuristic dissector was tried, how
+ * often it took the packet, and how long it took doing so. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+
+#include <ui/cmdarg_err.h>
+
+void register_tap_listener_heurstat(void);
+
+static void
+heurstat_add_entry(const gchar *table_name _U_, heur_dtbl_entry_t *hdtbl_entry, gpointer user_data)
+{
+	GPtrArray *entries = (GPtrArray *)user_data;
+
+	if (hdtbl_entry->hits != 0 || hdtbl_entry->misses != 0)
+		g_ptr_array_add(entries, hdtbl_entry);
+}
+
+static void
+heurstat_add_table(const char *table_name, struct heur_dissector_list *table _U_, gpointer user_data)
+{
+	heur_dissector_table_foreach(table_name, heurstat_add_entry, user_data);
+}
+
+/* By list, then by the time spent in them, then by the number of calls. */
+static gint
+heurstat_compare(gconstpointer a, gconstpointer b)
+{
+	const heur_dtbl_entry_t *entry_a = *(const heur_dtbl_entry_t * const *)a;
+	const heur_dtbl_entry_t *entry_b = *(const heur_dtbl_entry_t * const *)b;
+	int ret;
+
+	ret = strcmp(entry_a->list_name, entry_b->list_name);
+	if (ret != 0)
+		return ret;
+	if (entry_a->time_us != entry_b->time_us)
+		return entry_a->time_us > entry_b->time_us ? -1 : 1;
+	if (entry_a->hits + entry_a->misses != entry_b->hits + entry_b->misses)
+		return entry_a->hits + entry_a->misses > entry_b->hits + entry_b->misses ? -1 : 1;
+	return strcmp(entry_a->short_name, entry_b->short_name);
+}
+
+static void
+heurstat_draw(void *arg _U_)
+{
+	GPtrArray *entries = g_ptr_array_new();
+	heur_dtbl_entry_t *hdtbl_entry;
+	guint i;
+
+	dissector_all_heur_tables_foreach_table(heurstat_add_table, entries, NULL);
+	g_ptr_array_sort(entries, heurstat_compare);
+
+	printf("\n");
+	printf("===================================================================\n");
+	printf("Heuristic Dissector Statistics\n");
+	printf("%-16s %-24s %12s %12s %12s\n", "List", "Dissector", "Hits", "Misses", "Time (us)");
+	for (i = 0; i < entries->len; i++) {
+		hdtbl_entry = (heur_dtbl_entry_t *)g_ptr_array_index(entries, i);
+		printf("%-16s %-24s %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u\n",
+			hdtbl_entry->list_name, hdtbl_entry->short_name,
+			hdtbl_entry->hits, hdtbl_entry->misses, hdtbl_entry->time_us);
+	}
+	printf("===================================================================\n");
+
+	g_ptr_array_free(entries, TRUE);
+}
+
+static void
+heurstat_init(const char *opt_arg, void *userdata _U_)
+{
+	GString *error_string;
+
+	if (strcmp("heur,stat", opt_arg) != 0) {
+		cmdarg_err("invalid \"-z heur,stat\" argument");
+		exit(1);
+	}
+
+	heur_dissector_set_timing(TRUE);
+
+	/* We only need to be told when to print; the counting is done as
+	 * the heuristic dissectors are called. */
+	error_string = register_tap_listener("frame", NULL, NULL, 0, NULL, NULL, heurstat_draw, NULL);
+	if (error_string) {
+		cmdarg_err("Couldn't register heur,stat tap: %s",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+}
+
+static stat_tap_ui heurstat_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"heur,stat",
+	heurstat_init,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_heurstat(void)
+{
+	register_stat_tap_ui(&heurstat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
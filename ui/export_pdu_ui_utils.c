@@ -37,6 +37,7 @@ exp_pdu_file_open(exp_pdu_t *exp_pdu_tap_data)
     int   file_type_subtype;
     char *capfile_name, *comment;
     gboolean status;
+    cf_read_status_t retap_status;
     int   err;
     gchar *err_info;
 
@@ -63,12 +64,25 @@ exp_pdu_file_open(exp_pdu_t *exp_pdu_tap_data)
     }
 
     /* Run the tap */
-    cf_retap_packets(&cfile);
+    retap_status = cf_retap_packets(&cfile);
 
     if (!exp_pdu_close(exp_pdu_tap_data, &err, &err_info)) {
         cfile_close_failure_alert_box(capfile_name, err, err_info);
     }
 
+    if (retap_status != CF_READ_OK) {
+        /* Not all the PDUs were written; don't replace the capture file
+           with what we got. */
+        if (retap_status == CF_READ_ABORTED && cfile.retapping) {
+            /* We were called during another retap, which our tap can't
+               join as it's removed when we return. */
+            simple_dialog(ESD_TYPE_WARN, ESD_BTN_OK,
+                          "The packets are being processed for statistics; "
+                          "export the PDUs again when that's finished.");
+        }
+        goto end;
+    }
+
     /* XXX: should this use the open_routine type in the cfile instead of WTAP_TYPE_AUTO? */
     if (cf_open(&cfile, capfile_name, WTAP_TYPE_AUTO, TRUE /* temporary file */, &err) != CF_OK) {
         /* cf_open() has put up a dialog box for the error */
@@ -0,0 +1,310 @@
+/* filter_results.c
+ * Per-frame results of recently applied display filters
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/proto.h>
+#include <epan/dfilter/dfilter.h>
+
+#include "filter_results.h"
+
+/*
+ * Fields whose values don't only depend on the frame and the state of
+ * the dissectors, but on what was displayed before or on the coloring
+ * rules; filters testing them can't be reused.
+ */
+static const char *filter_results_volatile_fields[] = {
+    "frame.time_delta_displayed",
+    "frame.cum_bytes",
+    "frame.coloring_rule.name",
+    "frame.coloring_rule.string",
+};
+
+static gboolean
+filter_is_name_char(char c)
+{
+    return g_ascii_isalnum(c) || c == '_' || c == '.' || c == '-' || c == ':';
+}
+
+/*
+ * Scan the filter text from "p" to "end" up to the first "&&" or "and"
+ * that isn't inside a quoted string or any kind of brackets.  Returns a
+ * pointer to it and sets "len" to its length, or returns "end" if there's
+ * none.
+ */
+static const char *
+filter_find_and(const char *p, const char *end, size_t *len)
+{
+    const char *start = p;
+    int         depth = 0;
+    char        quote = '\0';
+
+    for (; p < end; p++) {
+        if (quote != '\0') {
+            if (*p == '\\' && p + 1 < end)
+                p++;
+            else if (*p == quote)
+                quote = '\0';
+        } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+        } else if (*p == '(' || *p == '[' || *p == '{') {
+            depth++;
+        } else if (*p == ')' || *p == ']' || *p == '}') {
+            depth--;
+        } else if (depth == 0) {
+            if (p + 2 <= end && p[0] == '&' && p[1] == '&') {
+                *len = 2;
+                return p;
+            }
+            if (p + 3 <= end && strncmp(p, "and", 3) == 0 &&
+                (p == start || !filter_is_name_char(p[-1])) &&
+                (p + 3 == end || !filter_is_name_char(p[3]))) {
+                *len = 3;
+                return p;
+            }
+        }
+    }
+    return end;
+}
+
+/* Is the filter text from "start" to "end" all inside one pair of parentheses? */
+static gboolean
+filter_in_parens(const char *start, const char *end)
+{
+    const char *p;
+    int         depth = 0;
+    char        quote = '\0';
+
+    if (end - start < 2 || *start != '(' || end[-1] != ')')
+        return FALSE;
+
+    for (p = start; p < end - 1; p++) {
+        if (quote != '\0') {
+            if (*p == '\\' && p + 1 < end)
+                p++;
+            else if (*p == quote)
+                quote = '\0';
+        } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+        } else if (*p == '(') {
+            depth++;
+        } else if (*p == ')') {
+            /* Closing the first one before the end? */
+            if (--depth == 0)
+                return FALSE;
+        }
+    }
+    return depth == 1;
+}
+
+/*
+ * Split the filter text from "start" to "end" into the terms of the
+ * conjunction it is, stripping the parentheses around them and collapsing
+ * runs of white space outside of quoted strings, and add them to "terms".
+ */
+static void
+filter_split_terms(const char *start, const char *end, GPtrArray *terms)
+{
+    const char *p, *and_p;
+    size_t      and_len;
+    char        quote = '\0';
+    GString    *term;
+
+    for (;;) {
+        while (start < end && g_ascii_isspace(*start))
+            start++;
+        while (end > start && g_ascii_isspace(end[-1]))
+            end--;
+        if (!filter_in_parens(start, end))
+            break;
+        start++;
+        end--;
+    }
+
+    and_p = filter_find_and(start, end, &and_len);
+    if (and_p != end) {
+        filter_split_terms(start, and_p, terms);
+        filter_split_terms(and_p + and_len, end, terms);
+        return;
+    }
+
+    term = g_string_sized_new(end - start);
+    for (p = start; p < end; p++) {
+        if (quote != '\0') {
+            if (*p == '\\' && p + 1 < end)
+                g_string_append_c(term, *p++);
+            else if (*p == quote)
+                quote = '\0';
+        } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+        } else if (g_ascii_isspace(*p)) {
+            if (!g_ascii_isspace(p[1]))
+                g_string_append_c(term, ' ');
+            continue;
+        }
+        g_string_append_c(term, *p);
+    }
+    g_ptr_array_add(terms, g_string_free(term, FALSE));
+}
+
+static gint
+filter_term_compare(gconstpointer a, gconstpointer b)
+{
+    return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+gchar **
+filter_results_terms_new(const char *dftext, dfilter_t *dfcode)
+{
+    GPtrArray *terms;
+    guint      i;
+    int        hfid;
+
+    /* The same macro could expand to something else next time. */
+    if (strchr(dftext, '$') != NULL)
+        return NULL;
+
+    for (i = 0; i < G_N_ELEMENTS(filter_results_volatile_fields); i++) {
+        hfid = proto_registrar_get_id_byname(filter_results_volatile_fields[i]);
+        if (hfid != -1 && dfilter_interested_in_field(dfcode, hfid))
+            return NULL;
+    }
+
+    terms = g_ptr_array_new();
+    filter_split_terms(dftext, dftext + strlen(dftext), terms);
+    g_ptr_array_sort(terms, filter_term_compare);
+    g_ptr_array_add(terms, NULL);
+    return (gchar **)g_ptr_array_free(terms, FALSE);
+}
+
+/* Is every term of "sub" one of the terms of "terms"? */
+static gboolean
+filter_terms_included(gchar **sub, gchar **terms)
+{
+    int cmp;
+
+    while (*sub != NULL) {
+        if (*terms == NULL)
+            return FALSE;
+        cmp = strcmp(*sub, *terms);
+        if (cmp < 0)
+            return FALSE;
+        if (cmp == 0)
+            sub++;
+        terms++;
+    }
+    return TRUE;
+}
+
+static void
+filter_results_free(gpointer data)
+{
+    filter_results_t *results = (filter_results_t *)data;
+
+    g_strfreev(results->terms);
+    g_free(results->passed);
+    g_free(results);
+}
+
+void
+filter_results_clear(GQueue **cache)
+{
+    if (*cache != NULL) {
+        g_queue_free_full(*cache, filter_results_free);
+        *cache = NULL;
+    }
+}
+
+filter_results_t *
+filter_results_find(GQueue *cache, gchar **terms)
+{
+    GList            *item;
+    filter_results_t *results, *best = NULL;
+
+    if (cache == NULL)
+        return NULL;
+
+    for (item = cache->head; item != NULL; item = item->next) {
+        results = (filter_results_t *)item->data;
+        if ((best == NULL || results->passed_count < best->passed_count) &&
+            filter_terms_included(results->terms, terms))
+            best = results;
+    }
+
+    if (best != NULL) {
+        /* It's the most recently used one now. */
+        g_queue_remove(cache, best);
+        g_queue_push_head(cache, best);
+    }
+    return best;
+}
+
+void
+filter_results_add(GQueue **cache, gchar **terms, guint8 *passed,
+                   guint32 frames, guint32 passed_count)
+{
+    filter_results_t *results;
+    GList            *item, *next;
+    gsize             size = frames / 8 + 1;
+    gsize             total = size;
+
+    if (*cache == NULL)
+        *cache = g_queue_new();
+
+    if (size > FILTER_RESULTS_BUDGET) {
+        g_strfreev(terms);
+        g_free(passed);
+        return;
+    }
+
+    /* Drop the old results of the same filter, and see how much the
+       others take. */
+    for (item = (*cache)->head; item != NULL; item = next) {
+        next = item->next;
+        results = (filter_results_t *)item->data;
+        if (filter_terms_included(results->terms, terms) &&
+            filter_terms_included(terms, results->terms)) {
+            filter_results_free(results);
+            g_queue_delete_link(*cache, item);
+        } else {
+            total += results->frames / 8 + 1;
+        }
+    }
+
+    while (total > FILTER_RESULTS_BUDGET && !g_queue_is_empty(*cache)) {
+        results = (filter_results_t *)g_queue_pop_tail(*cache);
+        total -= results->frames / 8 + 1;
+        filter_results_free(results);
+    }
+
+    results = g_new(filter_results_t, 1);
+    results->terms = terms;
+    results->passed = passed;
+    results->frames = frames;
+    results->passed_count = passed_count;
+    g_queue_push_head(*cache, results);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
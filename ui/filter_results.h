@@ -0,0 +1,95 @@
+/* filter_results.h
+ * Per-frame results of recently applied display filters
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __FILTER_RESULTS_H__
+#define __FILTER_RESULTS_H__
+
+#include <glib.h>
+
+#include <epan/dfilter/dfilter.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Filters are usually narrowed down step by step, e.g. "ip.addr==x" into
+ * "ip.addr==x && tcp.port==443".  When the new filter is a conjunction
+ * that includes all the terms of a filter applied before, the frames that
+ * didn't pass that filter can't pass the new one either, so they don't
+ * have to be dissected again.
+ *
+ * The results are kept in a cache, a GQueue of them that is most recently
+ * used first.  They are only valid as long as the dissection doesn't
+ * change, so the cache must be cleared when the packets are redissected,
+ * or when anything a filter can test for (marks, comments, time
+ * references, ...) changes.
+ */
+typedef struct {
+    gchar  **terms;        /* Normalized terms of the conjunction, sorted */
+    guint8  *passed;       /* Bit set for each frame that passed the filter */
+    guint32  frames;       /* Number of frames covered */
+    guint32  passed_count; /* Number of frames that passed the filter */
+} filter_results_t;
+
+/* Memory we're willing to spend on the per-frame results, in bytes. */
+#define FILTER_RESULTS_BUDGET (64 * 1024 * 1024)
+
+/*
+ * Get the sorted terms of a display filter, or NULL if results of the
+ * filter can't be reused, e.g. because it tests fields whose values
+ * depend on what was displayed before.  Free them with g_strfreev().
+ */
+extern gchar **filter_results_terms_new(const char *dftext, dfilter_t *dfcode);
+
+/*
+ * Find the results of the most selective filter applied before whose
+ * terms are all part of "terms", or NULL if there's none.
+ */
+extern filter_results_t *filter_results_find(GQueue *cache, gchar **terms);
+
+/* Does the frame with the given number not pass the filter? */
+static inline gboolean
+filter_results_excludes(const filter_results_t *results, guint32 framenum)
+{
+    return framenum <= results->frames &&
+           !(results->passed[(framenum - 1) / 8] & (1 << ((framenum - 1) % 8)));
+}
+
+/*
+ * Remember the results of a filter, creating the cache if needed, taking
+ * ownership of "terms" and "passed", which has a bit for each of "frames"
+ * frames, and dropping the least recently used results if we'd spend more
+ * than FILTER_RESULTS_BUDGET.
+ */
+extern void filter_results_add(GQueue **cache, gchar **terms, guint8 *passed,
+                               guint32 frames, guint32 passed_count);
+
+/* Throw away all the results. */
+extern void filter_results_clear(GQueue **cache);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FILTER_RESULTS_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
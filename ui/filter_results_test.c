@@ -0,0 +1,206 @@
+/* filter_results_test.c
+ * Tests for reusing the results of display filters
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include <epan/epan.h>
+#include <epan/dfilter/dfilter.h>
+#include <wiretap/wtap.h>
+
+#include "filter_results.h"
+
+#define TEST_FRAMES 20
+
+/* Compile the filter and get its terms, or NULL if they can't be reused. */
+static gchar **
+terms_for(const char *text)
+{
+    dfilter_t *dfcode;
+    gchar    **terms;
+    gchar     *err_msg = NULL;
+
+    if (!dfilter_compile(text, &dfcode, &err_msg)) {
+        g_test_message("%s: %s", text, err_msg);
+        g_free(err_msg);
+        g_assert_not_reached();
+    }
+    g_assert(dfcode != NULL);
+
+    terms = filter_results_terms_new(text, dfcode);
+    dfilter_free(dfcode);
+    return terms;
+}
+
+/* Add results in which the frames with the given numbers passed. */
+static void
+add_results(GQueue **cache, const char *text, const guint32 *framenums, guint count)
+{
+    guint8 *passed = (guint8 *)g_malloc0(TEST_FRAMES / 8 + 1);
+    guint   i;
+
+    for (i = 0; i < count; i++)
+        passed[(framenums[i] - 1) / 8] |= 1 << ((framenums[i] - 1) % 8);
+    filter_results_add(cache, terms_for(text), passed, TEST_FRAMES, count);
+}
+
+static filter_results_t *
+find_results(GQueue *cache, const char *text)
+{
+    gchar           **terms = terms_for(text);
+    filter_results_t *results;
+
+    g_assert(terms != NULL);
+    results = filter_results_find(cache, terms);
+    g_strfreev(terms);
+    return results;
+}
+
+static void
+filter_results_test_terms(void)
+{
+    gchar **terms;
+
+    /* Sorted, without the parentheses around them and extra white space */
+    terms = terms_for("(tcp.port == 443)  and ((ip.addr == 10.0.0.1))");
+    g_assert(g_strv_length(terms) == 2);
+    g_assert_cmpstr(terms[0], ==, "ip.addr == 10.0.0.1");
+    g_assert_cmpstr(terms[1], ==, "tcp.port == 443");
+    g_strfreev(terms);
+
+    /* Only the top-level conjunction is split */
+    terms = terms_for("ip.addr == 10.0.0.1 || (tcp.port == 443 && udp)");
+    g_assert(g_strv_length(terms) == 1);
+    g_strfreev(terms);
+
+    /* White space and "&&" in a string are left alone */
+    terms = terms_for("http.host == \"a  &&  b\" && tcp");
+    g_assert(g_strv_length(terms) == 2);
+    g_assert_cmpstr(terms[0], ==, "http.host == \"a  &&  b\"");
+    g_assert_cmpstr(terms[1], ==, "tcp");
+    g_strfreev(terms);
+
+    /* "and" at the end of a name isn't a conjunction */
+    terms = terms_for("tcp.options.mptcp.sendrand == 1 and tcp");
+    g_assert(g_strv_length(terms) == 2);
+    g_assert_cmpstr(terms[0], ==, "tcp");
+    g_assert_cmpstr(terms[1], ==, "tcp.options.mptcp.sendrand == 1");
+    g_strfreev(terms);
+}
+
+static void
+filter_results_test_reuse(void)
+{
+    static const guint32 ip_frames[] = { 1, 2, 5, 9, 17 };
+    static const guint32 port_frames[] = { 2, 9 };
+    GQueue           *cache = NULL;
+    filter_results_t *results;
+
+    add_results(&cache, "ip.addr == 10.0.0.1", ip_frames, G_N_ELEMENTS(ip_frames));
+
+    /* Narrowing it down reuses it */
+    results = find_results(cache, "tcp.port == 443 && ip.addr == 10.0.0.1");
+    g_assert(results != NULL);
+    g_assert(results->passed_count == G_N_ELEMENTS(ip_frames));
+    g_assert(!filter_results_excludes(results, 1));
+    g_assert(filter_results_excludes(results, 3));
+    g_assert(!filter_results_excludes(results, 17));
+    g_assert(filter_results_excludes(results, TEST_FRAMES));
+    /* Frames added since then have to be looked at */
+    g_assert(!filter_results_excludes(results, TEST_FRAMES + 1));
+
+    /* So does applying it again */
+    g_assert(find_results(cache, "ip.addr==10.0.0.1") == results);
+
+    /* But not another filter, or a disjunction */
+    g_assert(find_results(cache, "tcp.port == 443 && ip.addr == 10.0.0.2") == NULL);
+    g_assert(find_results(cache, "tcp.port == 443 || ip.addr == 10.0.0.1") == NULL);
+
+    /* The most selective of the filters that apply is used */
+    add_results(&cache, "tcp.port == 443", port_frames, G_N_ELEMENTS(port_frames));
+    results = find_results(cache, "ip.addr == 10.0.0.1 && tcp.port == 443");
+    g_assert(results != NULL);
+    g_assert(results->passed_count == G_N_ELEMENTS(port_frames));
+    g_assert(filter_results_excludes(results, 1));
+    g_assert(!filter_results_excludes(results, 9));
+
+    /* Results of the same filter replace the old ones */
+    add_results(&cache, "ip.addr == 10.0.0.1", port_frames, 1);
+    g_assert(g_queue_get_length(cache) == 2);
+    results = find_results(cache, "ip.addr == 10.0.0.1");
+    g_assert(results != NULL && results->passed_count == 1);
+
+    filter_results_clear(&cache);
+    g_assert(cache == NULL);
+    g_assert(find_results(cache, "ip.addr == 10.0.0.1") == NULL);
+}
+
+static void
+filter_results_test_volatile(void)
+{
+    static const guint32 frames[] = { 1, 2 };
+    GQueue *cache = NULL;
+    gchar **terms;
+
+    /* Fields that depend on what was displayed before bypass the cache */
+    g_assert(terms_for("frame.cum_bytes > 1000") == NULL);
+    g_assert(terms_for("ip.addr == 10.0.0.1 && frame.cum_bytes > 1000") == NULL);
+    g_assert(terms_for("frame.time_delta_displayed > 1") == NULL);
+    g_assert(terms_for("frame.coloring_rule.name == \"TCP\"") == NULL);
+
+    /* ...even if results for the rest of the filter are cached */
+    add_results(&cache, "ip.addr == 10.0.0.1", frames, G_N_ELEMENTS(frames));
+    g_assert(terms_for("ip.addr == 10.0.0.1 && frame.cum_bytes > 1000") == NULL);
+    filter_results_clear(&cache);
+
+    /* Other frame fields don't */
+    terms = terms_for("frame.len > 1000");
+    g_assert(terms != NULL);
+    g_strfreev(terms);
+}
+
+int
+main(int argc, char **argv)
+{
+    int result;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/filter_results/terms",    filter_results_test_terms);
+    g_test_add_func("/filter_results/reuse",    filter_results_test_reuse);
+    g_test_add_func("/filter_results/volatile", filter_results_test_volatile);
+
+    /* The filters test fields registered by the dissectors. */
+    wtap_init(FALSE);
+    if (!epan_init(NULL, NULL, FALSE))
+        return 2;
+
+    result = g_test_run();
+
+    epan_cleanup();
+    wtap_cleanup();
+
+    return result;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
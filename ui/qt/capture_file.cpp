@@ -80,11 +80,18 @@ capture_session * CaptureEvent::capSession() const
 
 QString CaptureFile::no_capture_file_ = QObject::tr("[no capture file]");
 
+// Delayed retaps requested within this time of each other share one pass.
+static const int retap_coalesce_interval_ms = 100;
+
 CaptureFile::CaptureFile(QObject *parent, capture_file *cap_file) :
     QObject(parent),
     cap_file_(cap_file),
     file_state_(QString())
 {
+    retap_timer_.setSingleShot(true);
+    retap_timer_.setInterval(retap_coalesce_interval_ms);
+    connect(&retap_timer_, SIGNAL(timeout()), this, SLOT(retapPackets()));
+
 #ifdef HAVE_LIBPCAP
     capture_callback_add(captureCallback, (gpointer) this);
 #endif
@@ -211,16 +218,23 @@ int CaptureFile::timestampPrecision()
     return WTAP_TSPREC_UNKNOWN;
 }
 
-void CaptureFile::retapPackets()
+bool CaptureFile::retapPackets()
 {
+    // This serves any pending delayed retap as well.
+    retap_timer_.stop();
     if (cap_file_) {
-        cf_retap_packets(cap_file_);
+        return cf_retap_packets(cap_file_) == CF_READ_OK;
     }
+    return false;
 }
 
 void CaptureFile::delayedRetapPackets()
 {
-    QTimer::singleShot(0, this, SLOT(retapPackets()));
+    // Don't restart a pending timer, so that a stream of requests can't
+    // hold off the retap indefinitely.
+    if (!retap_timer_.isActive()) {
+        retap_timer_.start();
+    }
 }
 
 void CaptureFile::reload()
@@ -11,6 +11,7 @@
 #define CAPTURE_FILE_H
 
 #include <QObject>
+#include <QTimer>
 
 #include <config.h>
 
@@ -128,13 +129,19 @@ signals:
 public slots:
     /** Retap the capture file. Convenience wrapper for cf_retap_packets.
      * Application events are processed periodically via update_progress_dlg.
+     *
+     * @return true if the tap listeners saw every packet, false if the
+     * retap was stopped or failed, or if it was folded into one already in
+     * progress, which feeds listeners that are still registered before it
+     * emits its Retap Finished event.
      */
-    void retapPackets();
+    bool retapPackets();
 
     /** Retap the capture file after the current batch of application events
      * is processed. If you call this instead of retapPackets or
      * cf_retap_packets in a dialog's constructor it will be displayed before
-     * tapping starts.
+     * tapping starts. Requests made within a short time of each other, e.g.
+     * by several dialogs opened at once, are served by a single retap.
      */
     void delayedRetapPackets();
 
@@ -162,6 +169,7 @@ private:
 
     capture_file *cap_file_;
     QString file_state_;
+    QTimer retap_timer_;
 };
 
 #endif // CAPTURE_FILE_H
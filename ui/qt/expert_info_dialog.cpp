@@ -149,7 +149,7 @@ void ExpertInfoDialog::retapPackets()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.delayedRetapPackets();
 }
 
 void ExpertInfoDialog::captureEvent(CaptureEvent e)
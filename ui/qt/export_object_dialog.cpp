@@ -170,12 +170,10 @@ void ExportObjectDialog::show()
     }
 
     QDialog::show();
+    // The list is laid out in captureEvent when the retap finishes. If it
+    // was folded into one that's already in progress, that's when that
+    // one finishes, having fed our tap listener too.
     cap_file_.retapPackets();
-    eo_ui_->progressFrame->hide();
-    for (int i = 0; i < eo_ui_->objectTree->model()->columnCount(); i++)
-        eo_ui_->objectTree->resizeColumnToContents(i);
-
-    eo_ui_->objectTree->sortByColumn(ExportObjectModel::colPacket, Qt::AscendingOrder);
 }
 
 void ExportObjectDialog::keyPressEvent(QKeyEvent *evt)
@@ -197,6 +195,19 @@ void ExportObjectDialog::captureEvent(CaptureEvent e)
     {
         close();
     }
+
+    // Only the first retap after we're shown; later ones (for other
+    // dialogs) shouldn't undo the user's column widths and sort order.
+    if ((e.captureContext() == CaptureEvent::Retap) &&
+            (e.eventType() == CaptureEvent::Finished) &&
+            eo_ui_->progressFrame->isVisible())
+    {
+        eo_ui_->progressFrame->hide();
+        for (int i = 0; i < eo_ui_->objectTree->model()->columnCount(); i++)
+            eo_ui_->objectTree->resizeColumnToContents(i);
+
+        eo_ui_->objectTree->sortByColumn(ExportObjectModel::colPacket, Qt::AscendingOrder);
+    }
 }
 
 void ExportObjectDialog::on_buttonBox_helpRequested()
@@ -1143,9 +1143,8 @@ void IOGraphDialog::updateStatistics()
 
     if (need_retap_ && !file_closed_) {
         need_retap_ = false;
-        cap_file_.retapPackets();
-        // The user might have closed the window while tapping, which means
-        // we might no longer exist.
+        // Share the pass with any other dialog that's waiting to retap.
+        cap_file_.delayedRetapPackets();
     } else {
         if (need_recalc_ && !file_closed_) {
             need_recalc_ = false;
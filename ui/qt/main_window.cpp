@@ -1339,6 +1339,15 @@ bool MainWindow::saveCaptureFile(capture_file *cf, bool dont_reopen) {
         if (cf->unsaved_changes) {
             cf_write_status_t status;
 
+            if (!wtap_can_write_compression_type(cf->compression_type)) {
+                /* We can read files compressed this way, but we can't
+                   write them.  Do a "Save As" so the user can choose a
+                   compression type and a file name, rather than failing
+                   or replacing the file with a differently compressed
+                   one under the same name. */
+                return saveAsCaptureFile(cf, FALSE, dont_reopen);
+            }
+
             /* This is not a temporary capture file, but it has unsaved
                changes, so saving it means doing a "safe save" on top
                of the existing file, in the same format - no UI needed
@@ -363,7 +363,11 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     busy_timer_.start();
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
-    std::sort(physical_rows_.begin(), physical_rows_.end(), recordLessThan);
+    if (text_sort_column_ < 0) {
+        std::sort(physical_rows_.begin(), physical_rows_.end(), recordLessThan);
+    } else {
+        sortByColumnKeys();
+    }
 
     emit beginResetModel();
     visible_rows_.resize(0);
@@ -463,7 +467,8 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
 
     // Wherein we try to cram the logic of packet_list_compare_records,
     // _packet_list_compare_records, and packet_list_compare_custom from
-    // gtk/packet_list_store.c into one function
+    // gtk/packet_list_store.c into one function. Text columns are handled
+    // by sortKeyLessThan.
 
     if (busy_timer_.elapsed() > busy_timeout_) {
         // What's the least amount of processing that we can do which will draw
@@ -474,37 +479,82 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
     if (sort_column_ < 0) {
         // No column.
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-    } else if (text_sort_column_ < 0) {
+    } else {
         // Column comes directly from frame data
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
-    } else  {
-        if (r1->columnString(sort_cap_file_, sort_column_).constData() == r2->columnString(sort_cap_file_, sort_column_).constData()) {
-            cmp_val = 0;
-        } else if (sort_column_is_numeric_) {
-            // Custom column with numeric data (or something like a port number).
-            // Attempt to convert to numbers.
-            // XXX This is slow. Can we avoid doing this?
-            bool ok_r1, ok_r2;
-            double num_r1 = parseNumericColumn(r1->columnString(sort_cap_file_, sort_column_), &ok_r1);
-            double num_r2 = parseNumericColumn(r2->columnString(sort_cap_file_, sort_column_), &ok_r2);
-
-            if (!ok_r1 && !ok_r2) {
-                cmp_val = 0;
-            } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
-                // either r1 is invalid (and sort it before others) or both
-                // r1 and r2 are valid (sort normally)
-                cmp_val = -1;
-            } else if (!ok_r2 || (num_r1 > num_r2)) {
-                cmp_val = 1;
-            }
-        } else {
-            cmp_val = r1->columnString(sort_cap_file_, sort_column_).compare(r2->columnString(sort_cap_file_, sort_column_));
+    }
+
+    if (sort_order_ == Qt::AscendingOrder) {
+        return cmp_val < 0;
+    } else {
+        return cmp_val > 0;
+    }
+}
+
+// Sort key for a text column. Column strings may require the packet to be
+// dissected and numeric columns have to be parsed, so we extract the key for
+// each row once instead of on every comparison.
+struct PacketListModel::SortKey {
+    PacketListRecord *record;
+    QString text;
+    double number;
+    bool number_ok;
+};
+
+void PacketListModel::sortByColumnKeys()
+{
+    QVector<SortKey> keys;
+
+    keys.reserve(physical_rows_.count());
+    foreach (PacketListRecord *record, physical_rows_) {
+        SortKey key;
+
+        key.record = record;
+        key.text = record->columnString(sort_cap_file_, sort_column_);
+        key.number = 0.0;
+        key.number_ok = false;
+        if (sort_column_is_numeric_) {
+            key.number = parseNumericColumn(key.text, &key.number_ok);
+        }
+        keys << key;
+
+        if (busy_timer_.elapsed() > busy_timeout_) {
+            wsApp->processEvents(QEventLoop::ExcludeUserInputEvents | QEventLoop::ExcludeSocketNotifiers, 1);
+            busy_timer_.restart();
         }
+    }
+
+    std::sort(keys.begin(), keys.end(), sortKeyLessThan);
+
+    for (int i = 0; i < keys.count(); i++) {
+        physical_rows_[i] = keys[i].record;
+    }
+}
+
+bool PacketListModel::sortKeyLessThan(const SortKey &k1, const SortKey &k2)
+{
+    int cmp_val = 0;
 
-        if (cmp_val == 0) {
-            // All else being equal, compare column numbers.
-            cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
+    if (k1.text.constData() == k2.text.constData()) {
+        cmp_val = 0;
+    } else if (sort_column_is_numeric_) {
+        // Custom column with numeric data (or something like a port number).
+        if (!k1.number_ok && !k2.number_ok) {
+            cmp_val = 0;
+        } else if (!k1.number_ok || (k2.number_ok && k1.number < k2.number)) {
+            // either k1 is invalid (and sort it before others) or both
+            // k1 and k2 are valid (sort normally)
+            cmp_val = -1;
+        } else if (!k2.number_ok || (k1.number > k2.number)) {
+            cmp_val = 1;
         }
+    } else {
+        cmp_val = k1.text.compare(k2.text);
+    }
+
+    if (cmp_val == 0) {
+        // All else being equal, compare column numbers.
+        cmp_val = frame_data_compare(sort_cap_file_->epan, k1.record->frameData(), k2.record->frameData(), COL_NUMBER);
     }
 
     if (sort_order_ == Qt::AscendingOrder) {
@@ -586,12 +636,13 @@ QVariant PacketListModel::data(const QModelIndex &d_index, int role) const
 
     case Qt::BackgroundRole:
         const color_t *color;
+        const color_filter_t *color_filter;
         if (fdata->ignored) {
             color = &prefs.gui_ignored_bg;
         } else if (fdata->marked) {
             color = &prefs.gui_marked_bg;
-        } else if (fdata->color_filter && recent.packet_list_colorize) {
-            const color_filter_t *color_filter = (const color_filter_t *) fdata->color_filter;
+        } else if (fdata->color_filter_index && recent.packet_list_colorize &&
+                   (color_filter = color_filters_get_frame_filter(fdata)) != NULL) {
             color = &color_filter->bg_color;
         } else {
             return QVariant();
@@ -602,8 +653,8 @@ QVariant PacketListModel::data(const QModelIndex &d_index, int role) const
             color = &prefs.gui_ignored_fg;
         } else if (fdata->marked) {
             color = &prefs.gui_marked_fg;
-        } else if (fdata->color_filter && recent.packet_list_colorize) {
-            const color_filter_t *color_filter = (const color_filter_t *) fdata->color_filter;
+        } else if (fdata->color_filter_index && recent.packet_list_colorize &&
+                   (color_filter = color_filters_get_frame_filter(fdata)) != NULL) {
             color = &color_filter->fg_color;
         } else {
             return QVariant();
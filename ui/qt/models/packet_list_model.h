@@ -100,6 +100,9 @@ private:
     static capture_file *sort_cap_file_;
     static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
     static double parseNumericColumn(const QString &val, bool *ok);
+    struct SortKey;
+    static bool sortKeyLessThan(const SortKey &k1, const SortKey &k2);
+    void sortByColumnKeys();
 
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
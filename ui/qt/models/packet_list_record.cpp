@@ -152,7 +152,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
             cacheColumnStrings(cinfo);
         }
         if (dissect_color) {
-            fdata_->color_filter = NULL;
+            fdata_->color_filter_index = 0;
             colorized_ = true;
         }
         ws_buffer_free(&buf);
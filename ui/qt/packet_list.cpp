@@ -1900,8 +1900,8 @@ void PacketList::drawNearOverlay()
 
             frame_data *fdata = packet_list_model_->getRowFdata(row);
             const color_t *bgcolor = NULL;
-            if (fdata->color_filter) {
-                const color_filter_t *color_filter = (const color_filter_t *) fdata->color_filter;
+            const color_filter_t *color_filter = color_filters_get_frame_filter(fdata);
+            if (color_filter) {
                 bgcolor = &color_filter->bg_color;
             }
 
@@ -367,7 +367,11 @@ RtpAnalysisDialog::RtpAnalysisDialog(QWidget &parent, CaptureFile &cf, rtpstream
     }
 
     registerTapListener("rtp", this, NULL, 0, tapReset, tapPacket, tapDraw);
-    cap_file_.retapPackets();
+    if (!cap_file_.retapPackets() && err_str_.isEmpty()) {
+        // Stopped, or folded into a retap in progress that our tap,
+        // removed below, can't join.
+        err_str_ = tr("The packets could not all be analyzed. Please try again.");
+    }
     removeTapListeners();
 
     connect(ui->tabWidget, SIGNAL(currentChanged(int)),
@@ -573,8 +573,9 @@ WirelessTimeline::paintEvent(QPaintEvent *qpe)
         if (first_packet < 0)
             first_packet = packet;
 
-        if (fdata->color_filter) {
-            const color_t *c = &((const color_filter_t *) fdata->color_filter)->fg_color;
+        const color_filter_t *color_filter = color_filters_get_frame_filter(fdata);
+        if (color_filter) {
+            const color_t *c = &color_filter->fg_color;
             red = c->red / 65535.0;
             green = c->green / 65535.0;
             blue = c->blue / 65535.0;
@@ -98,6 +98,20 @@ tapall_tcpip_packet(void *pct, packet_info *pinfo, epan_dissect_t *edt _U_, cons
     return TAP_PACKET_DONT_REDRAW;
 }
 
+static void
+graph_segments_free(struct tcp_graph *tg)
+{
+    struct segment *segment;
+
+    while (tg->segments) {
+        segment = tg->segments->next;
+        free_address(&tg->segments->ip_src);
+        free_address(&tg->segments->ip_dst);
+        g_free(tg->segments);
+        tg->segments = segment;
+    }
+}
+
 /* here we collect all the external data we will ever need */
 void
 graph_segment_list_get(capture_file *cf, struct tcp_graph *tg)
@@ -125,25 +139,22 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg)
         g_string_free(error_string, TRUE);
         exit(1);   /* XXX: fix this */
     }
-    cf_retap_packets(cf);
+    if (cf_retap_packets(cf) != CF_READ_OK) {
+        /* The user stopped us, or we were called during another retap,
+           which our tap can't join as it's removed below; don't graph
+           part of the stream. */
+        graph_segments_free(tg);
+    }
     remove_tap_listener(&ts);
 }
 
 void
 graph_segment_list_free(struct tcp_graph *tg)
 {
-    struct segment *segment;
-
     free_address(&tg->src_address);
     free_address(&tg->dst_address);
 
-    while (tg->segments) {
-        segment = tg->segments->next;
-        free_address(&tg->segments->ip_src);
-        free_address(&tg->segments->ip_dst);
-        g_free(tg->segments);
-        tg->segments = segment;
-    }
+    graph_segments_free(tg);
 }
 
 int
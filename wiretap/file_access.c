@@ -2205,6 +2205,13 @@ wtap_dump_init_dumper(int file_type_subtype, wtap_compression_type compression_t
 		return NULL;
 	}
 
+	/* We can read zstd and LZ4 compressed files, but we can only
+	   write gzip compressed files. */
+	if (!wtap_can_write_compression_type(compression_type)) {
+		*err = WTAP_ERR_COMPRESSION_NOT_SUPPORTED;
+		return NULL;
+	}
+
 	/* Allocate a data structure for the output stream. */
 	wdh = g_new0(wtap_dumper, 1);
 	if (wdh == NULL) {
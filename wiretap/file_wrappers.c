@@ -27,6 +27,18 @@
 #include <zlib.h>
 #endif /* HAVE_ZLIB */
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif /* HAVE_ZSTD */
+
+#ifdef HAVE_LZ4FRAME_H
+#include <lz4frame.h>
+#endif /* HAVE_LZ4FRAME_H */
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif /* HAVE_SYS_MMAN_H */
+
 /*
  * See RFC 1952:
  *
@@ -34,6 +46,22 @@
  *
  * for a description of the gzip file format.
  *
+ * See
+ *
+ *      https://github.com/facebook/zstd/blob/dev/doc/zstd_compression_format.md
+ *
+ * for a description of the zstd format, and
+ *
+ *      https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md
+ *
+ * for a description of the LZ4 frame format.
+ *
+ * Both formats consist of a sequence of independently-decodable frames,
+ * so, when reading them, we add a fast seek point at the beginning of
+ * each frame; files written as many small frames (e.g., in the zstd
+ * "seekable" format) can be read randomly without decompressing
+ * everything before the place we're seeking to.
+ *
  * Some other compressed file formats we might want to support:
  *
  *      XZ format: https://tukaani.org/xz/
@@ -50,20 +78,26 @@ static struct compression_type {
     wtap_compression_type  type;
     const char            *extension;
     const char            *description;
+    gboolean               can_write;
 } compression_types[] = {
 #ifdef HAVE_ZLIB
-    { WTAP_GZIP_COMPRESSED, "gz", "gzip compressed" },
+    { WTAP_GZIP_COMPRESSED, "gz", "gzip compressed", TRUE },
+#endif
+#ifdef HAVE_ZSTD
+    { WTAP_ZSTD_COMPRESSED, "zst", "zstd compressed", FALSE },
 #endif
-    { WTAP_UNCOMPRESSED, NULL, NULL }
+#ifdef HAVE_LZ4FRAME_H
+    { WTAP_LZ4_COMPRESSED, "lz4", "lz4 compressed", FALSE },
+#endif
+    { WTAP_UNCOMPRESSED, NULL, NULL, TRUE }
 };
 
+static wtap_compression_type file_get_compression_type(FILE_T stream);
+
 wtap_compression_type
 wtap_get_compression_type(wtap *wth)
 {
-	gboolean is_compressed;
-
-	is_compressed = file_iscompressed((wth->fh == NULL) ? wth->random_fh : wth->fh);
-	return is_compressed ? WTAP_GZIP_COMPRESSED : WTAP_UNCOMPRESSED;
+	return file_get_compression_type((wth->fh == NULL) ? wth->random_fh : wth->fh);
 }
 
 const char *
@@ -88,6 +122,18 @@ wtap_compression_type_extension(wtap_compression_type compression_type)
 	return NULL;
 }
 
+gboolean
+wtap_can_write_compression_type(wtap_compression_type compression_type)
+{
+	struct compression_type *p;
+
+	for (p = compression_types; p->type != WTAP_UNCOMPRESSED; p++) {
+		if (p->type == compression_type)
+			return p->can_write;
+	}
+	return compression_type == WTAP_UNCOMPRESSED;
+}
+
 GSList *
 wtap_get_all_compression_type_extensions_list(void)
 {
@@ -111,7 +157,13 @@ typedef enum {
     UNCOMPRESSED,  /* uncompressed - copy input directly */
 #ifdef HAVE_ZLIB
     ZLIB,          /* decompress a zlib stream */
-    GZIP_AFTER_HEADER
+    GZIP_AFTER_HEADER,
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD,          /* decompress a zstd stream */
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    LZ4,           /* decompress an LZ4 frame stream */
 #endif
 } compression_t;
 
@@ -131,10 +183,12 @@ struct wtap_reader {
     struct wtap_reader_buf out; /* output buffer, containing uncompressed data */
 
     gboolean eof;               /* TRUE if end of input file reached */
+    gboolean flush_pending;     /* TRUE if the decompressor may have output left even with no more input */
     gint64 start;               /* where the gzip data started, for rewinding */
     gint64 raw;                 /* where the raw data started, for seeking */
     compression_t compression;  /* type of compression, if any */
     gboolean is_compressed;     /* FALSE if completely uncompressed, TRUE otherwise */
+    wtap_compression_type compression_type; /* type of compression, if is_compressed is TRUE */
 
     /* seek request */
     gint64 skip;                /* amount to skip (already rewound if backwards) */
@@ -148,10 +202,20 @@ struct wtap_reader {
     /* zlib inflate stream */
     z_stream strm;              /* stream structure in-place (not a pointer) */
     gboolean dont_check_crc;    /* TRUE if we aren't supposed to check the CRC */
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *zstd_dstream; /* zstd decompression stream, allocated when first needed */
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    LZ4F_decompressionContext_t lz4_dctx; /* LZ4 decompression context, allocated when first needed */
 #endif
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+    /* regular files are mapped where possible, and read from the mapping */
+    guint8 *map;                /* the file as it was when opened, or NULL */
+    gint64 map_size;            /* size of the mapping */
+    gboolean map_random;        /* mapping is read in random order */
 };
 
 /* Current read offset within a buffer. */
@@ -190,6 +254,35 @@ buf_reset(struct wtap_reader_buf *buf)
     buf->avail = 0;
 }
 
+static void file_unmap(FILE_T state);
+
+/*
+ * Check that the file is still as long as it was when we mapped it.  If
+ * it's been truncated, stop using the mapping and read the file instead,
+ * so that we report a short read rather than touch a page past its new
+ * end.
+ *
+ * That costs a system call, so it's only done when we seek and when we
+ * get to the end of the mapping, not on every read; see file_map() for
+ * what that leaves uncovered.
+ */
+static gboolean
+map_still_valid(FILE_T state)
+{
+    ws_statb64 st;
+
+    if (ws_fstat64(state->fd, &st) == 0 && st.st_size >= state->map_size)
+        return TRUE;
+
+    file_unmap(state);
+    /* The descriptor's offset isn't kept up to date while mapped. */
+    if (ws_lseek64(state->fd, state->raw_pos, SEEK_SET) == -1) {
+        state->err = errno;
+        state->err_info = NULL;
+    }
+    return FALSE;
+}
+
 static int
 buf_read(FILE_T state, struct wtap_reader_buf *buf)
 {
@@ -215,6 +308,29 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
         to_read = space_left;
     }
 
+    if (state->map != NULL) {
+        if (state->raw_pos < state->map_size) {
+            if ((gint64)to_read > state->map_size - state->raw_pos)
+                to_read = (guint)(state->map_size - state->raw_pos);
+            memcpy(read_ptr, state->map + state->raw_pos, to_read);
+            state->raw_pos += to_read;
+            buf->avail += to_read;
+            return 0;
+        }
+
+        /* The file has grown since we mapped it, e.g. because it's
+           still being written by a capture; read the new data from the
+           file, whose offset hasn't been kept up to date.  If it has
+           shrunk instead, map_still_valid() does the seek. */
+        if (map_still_valid(state) &&
+            ws_lseek64(state->fd, state->raw_pos, SEEK_SET) == -1) {
+            state->err = errno;
+            state->err_info = NULL;
+        }
+        if (state->err != 0)
+            return -1;
+    }
+
     ret = ws_read(state->fd, read_ptr, to_read);
     if (ret < 0) {
         state->err = errno;
@@ -228,6 +344,44 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
     return 0;
 }
 
+/* Move the raw position to an absolute offset in the file. */
+static int
+raw_seek(FILE_T state, gint64 off)
+{
+    /* Reads come from the mapping, and buf_read() seeks the
+       descriptor itself if it has to read past the end of it.  A seek
+       may go back over data that was truncated away since we last
+       looked, so check first. */
+    if (state->map != NULL) {
+        state->raw_pos = off;
+        if (!map_still_valid(state) && state->err != 0) {
+            errno = state->err;
+            return -1;
+        }
+        return 0;
+    }
+    if (ws_lseek64(state->fd, off, SEEK_SET) == -1)
+        return -1;
+    state->raw_pos = off;
+    return 0;
+}
+
+/* Number of the next len bytes of an uncompressed file that can be
+   copied straight out of the mapping, rather than through the output
+   buffer; 0 if it isn't mapped or there's buffered data to go first. */
+static guint
+mapped_avail(FILE_T state, guint len)
+{
+    if (state->map != NULL && state->compression == UNCOMPRESSED &&
+        state->out.avail == 0 && state->in.avail == 0 && state->err == 0 &&
+        state->raw_pos < state->map_size) {
+        if ((gint64)len > state->map_size - state->raw_pos)
+            return (guint)(state->map_size - state->raw_pos);
+        return len;
+    }
+    return 0;
+}
+
 static int /* gz_avail */
 fill_in_buffer(FILE_T state)
 {
@@ -642,6 +796,255 @@ DIAG_ON(cast-qual)
 }
 #endif
 
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4FRAME_H)
+/*
+ * Make sure at least n bytes are available in the input buffer, unless
+ * we hit the end of the file first; used to look at magic numbers longer
+ * than a byte.  Returns -1 on error, 0 otherwise.
+ */
+static int
+fill_in_buffer_to(FILE_T state, guint n)
+{
+    /* Move what we have to the beginning of the buffer, so that
+       buf_read() appends to it rather than starting over. */
+    if (state->in.avail < n && state->in.next != state->in.buf) {
+        memmove(state->in.buf, state->in.next, state->in.avail);
+        state->in.next = state->in.buf;
+    }
+    while (state->in.avail < n && !state->eof) {
+        if (fill_in_buffer(state) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+/*
+ * Check whether the input buffer begins with the 4-byte little-endian
+ * magic number magic.
+ */
+static gboolean
+in_buffer_has_magic(FILE_T state, guint32 magic)
+{
+    return state->in.avail >= 4 && pletoh32(state->in.next) == magic;
+}
+
+/*
+ * Check whether what the input buffer holds, up to 4 bytes, could be
+ * the start of the 4-byte little-endian magic number magic.
+ */
+static gboolean
+in_buffer_may_have_magic(FILE_T state, guint32 magic)
+{
+    guint i;
+
+    for (i = 0; i < state->in.avail && i < 4; i++) {
+        if (state->in.next[i] != ((magic >> (8 * i)) & 0xFF))
+            return FALSE;
+    }
+    return TRUE;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+#define ZSTD_FRAME_MAGIC    0xFD2FB528
+
+static void
+zstd_read(FILE_T state, unsigned char *buf, unsigned int count)
+{
+    ZSTD_outBuffer output;
+    ZSTD_inBuffer input;
+    size_t ret = 0;
+    size_t before;
+
+    output.dst = buf;
+    output.size = count;
+    output.pos = 0;
+
+    /* fill output buffer up to end of input or error */
+    for (;;) {
+        /* get more input if we've used it all */
+        if (state->in.avail == 0 && fill_in_buffer(state) == -1)
+            break;
+
+        input.src = state->in.next;
+        input.size = state->in.avail;
+        input.pos = 0;
+        before = output.pos;
+        ret = ZSTD_decompressStream(state->zstd_dstream, &output, &input);
+        state->in.next += input.pos;
+        state->in.avail -= (guint)input.pos;
+        if (ZSTD_isError(ret)) {
+            state->err = WTAP_ERR_DECOMPRESS;
+            state->err_info = ZSTD_getErrorName(ret);
+            break;
+        }
+
+        /*
+         * A return value of 0 means we've finished a frame and
+         * flushed all its data; the next frame, if any, can be
+         * decompressed without anything that came before it, so
+         * remember where it starts.
+         */
+        if (ret == 0 && state->fast_seek)
+            fast_seek_header(state, state->raw_pos - state->in.avail,
+                             state->pos + output.pos, ZSTD);
+
+        if (output.pos == output.size)
+            break;
+        if (state->in.avail == 0 && state->eof && output.pos == before) {
+            /* Nothing more to read, and nothing more came out */
+            if (ret != 0) {
+                /* We're in the middle of a frame */
+                state->err = WTAP_ERR_SHORT_READ;
+                state->err_info = NULL;
+            }
+            break;
+        }
+    }
+
+    /* If we stopped because the output buffer is full, in the middle
+       of a frame, the decompressor may still be holding data from input
+       we've already consumed; make sure we come back for it even if
+       we're at the end of the file. */
+    state->flush_pending = (output.pos == output.size && ret != 0);
+
+    state->out.next = buf;
+    state->out.avail = (guint)output.pos;
+}
+#endif /* HAVE_ZSTD */
+
+#ifdef HAVE_LZ4FRAME_H
+#define LZ4_FRAME_MAGIC     0x184D2204
+
+static void
+lz4_read(FILE_T state, unsigned char *buf, unsigned int count)
+{
+    size_t out_used = 0;
+    size_t out_size;
+    size_t in_size;
+    size_t ret = 0;
+
+    /* fill output buffer up to end of input or error */
+    for (;;) {
+        /* get more input if we've used it all */
+        if (state->in.avail == 0 && fill_in_buffer(state) == -1)
+            break;
+
+        out_size = count - out_used;
+        in_size = state->in.avail;
+        ret = LZ4F_decompress(state->lz4_dctx, buf + out_used, &out_size,
+                              state->in.next, &in_size, NULL);
+        state->in.next += in_size;
+        state->in.avail -= (guint)in_size;
+        if (LZ4F_isError(ret)) {
+            state->err = WTAP_ERR_DECOMPRESS;
+            state->err_info = LZ4F_getErrorName(ret);
+            break;
+        }
+        out_used += out_size;
+
+        /* As with zstd, a return value of 0 means the frame is done. */
+        if (ret == 0 && state->fast_seek)
+            fast_seek_header(state, state->raw_pos - state->in.avail,
+                             state->pos + out_used, LZ4);
+
+        if (out_used == count)
+            break;
+        if (state->in.avail == 0 && state->eof && out_size == 0) {
+            /* Nothing more to read, and nothing more came out */
+            if (ret != 0) {
+                /* We're in the middle of a frame */
+                state->err = WTAP_ERR_SHORT_READ;
+                state->err_info = NULL;
+            }
+            break;
+        }
+    }
+
+    /* See zstd_read() */
+    state->flush_pending = (out_used == count && ret != 0);
+
+    state->out.next = buf;
+    state->out.avail = (guint)out_used;
+}
+
+/*
+ * (Re)start LZ4 decompression at the beginning of a frame.  Returns -1
+ * on error, 0 otherwise.
+ */
+static int
+lz4_start(FILE_T state)
+{
+    /* Not all versions of liblz4 have LZ4F_resetDecompressionContext(). */
+    if (state->lz4_dctx != NULL)
+        LZ4F_freeDecompressionContext(state->lz4_dctx);
+    if (LZ4F_isError(LZ4F_createDecompressionContext(&state->lz4_dctx, LZ4F_VERSION))) {
+        state->lz4_dctx = NULL;
+        state->err = ENOMEM;
+        state->err_info = NULL;
+        return -1;
+    }
+    return 0;
+}
+#endif /* HAVE_LZ4FRAME_H */
+
+#ifdef HAVE_ZSTD
+/*
+ * (Re)start zstd decompression at the beginning of a frame.  Returns -1
+ * on error, 0 otherwise.
+ */
+static int
+zstd_start(FILE_T state)
+{
+    if (state->zstd_dstream == NULL) {
+        state->zstd_dstream = ZSTD_createDStream();
+        if (state->zstd_dstream == NULL) {
+            state->err = ENOMEM;
+            state->err_info = NULL;
+            return -1;
+        }
+    }
+    if (ZSTD_isError(ZSTD_initDStream(state->zstd_dstream))) {
+        state->err = WTAP_ERR_DECOMPRESS;
+        state->err_info = "can't initialize zstd decompression";
+        return -1;
+    }
+    return 0;
+}
+#endif /* HAVE_ZSTD */
+
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4FRAME_H)
+static gboolean
+in_buffer_may_have_frame_magic(FILE_T state)
+{
+#ifdef HAVE_ZSTD
+    if (in_buffer_may_have_magic(state, ZSTD_FRAME_MAGIC))
+        return TRUE;
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    if (in_buffer_may_have_magic(state, LZ4_FRAME_MAGIC))
+        return TRUE;
+#endif
+    return FALSE;
+}
+
+/*
+ * Read until the input buffer holds a 4-byte magic number, or until what
+ * it holds can't be the start of one.  A read from a pipe waits until
+ * more is written, so don't ask for bytes we don't need.
+ */
+static int
+fill_in_buffer_for_magic(FILE_T state)
+{
+    while (state->in.avail < 4 && !state->eof &&
+           in_buffer_may_have_frame_magic(state)) {
+        if (fill_in_buffer_to(state, state->in.avail + 1) == -1)
+            return -1;
+    }
+    return 0;
+}
+#endif
+
 static int
 gz_head(FILE_T state)
 {
@@ -767,6 +1170,7 @@ gz_head(FILE_T state)
                 state->strm.adler = crc32(0L, Z_NULL, 0);
                 state->compression = ZLIB;
                 state->is_compressed = TRUE;
+                state->compression_type = WTAP_GZIP_COMPRESSED;
 #ifdef Z_BLOCK
                 if (state->fast_seek) {
                     struct zlib_cur_seek_point *cur = g_new(struct zlib_cur_seek_point,1);
@@ -808,6 +1212,36 @@ gz_head(FILE_T state)
     /* { 0xFD, '7', 'z', 'X', 'Z', 0x00 } */
     /* FD 37 7A 58 5A 00 */
 #endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4FRAME_H)
+    if (fill_in_buffer_for_magic(state) == -1)
+        return -1;
+#endif
+#ifdef HAVE_ZSTD
+    /* 28 B5 2F FD */
+    if (in_buffer_has_magic(state, ZSTD_FRAME_MAGIC)) {
+        if (zstd_start(state) == -1)
+            return -1;
+        state->compression = ZSTD;
+        state->is_compressed = TRUE;
+        state->compression_type = WTAP_ZSTD_COMPRESSED;
+        if (state->fast_seek)
+            fast_seek_header(state, state->raw_pos - state->in.avail, state->pos, ZSTD);
+        return 0;
+    }
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    /* 04 22 4D 18 */
+    if (in_buffer_has_magic(state, LZ4_FRAME_MAGIC)) {
+        if (lz4_start(state) == -1)
+            return -1;
+        state->compression = LZ4;
+        state->is_compressed = TRUE;
+        state->compression_type = WTAP_LZ4_COMPRESSED;
+        if (state->fast_seek)
+            fast_seek_header(state, state->raw_pos - state->in.avail, state->pos, LZ4);
+        return 0;
+    }
+#endif
 
     if (state->fast_seek)
         fast_seek_header(state, state->raw_pos - state->in.avail - state->out.avail, state->pos, UNCOMPRESSED);
@@ -848,6 +1282,16 @@ fill_out_buffer(FILE_T state)
     else if (state->compression == ZLIB) {      /* decompress */
         zlib_read(state, state->out.buf, state->size << 1);
     }
+#endif
+#ifdef HAVE_ZSTD
+    else if (state->compression == ZSTD) {
+        zstd_read(state, state->out.buf, state->size << 1);
+    }
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    else if (state->compression == LZ4) {
+        lz4_read(state, state->out.buf, state->size << 1);
+    }
 #endif
     return 0;
 }
@@ -867,6 +1311,11 @@ gz_skip(FILE_T state, gint64 len)
             state->out.next += n;
             state->pos += n;
             len -= n;
+        } else if ((n = mapped_avail(state, len > G_MAXUINT ? G_MAXUINT : (guint)len)) != 0) {
+            /* Skip over it in the mapping. */
+            state->raw_pos += n;
+            state->pos += n;
+            len -= n;
         } else if (state->err != 0) {
             /* We have nothing in the output buffer, and
                we have an error that may not have been
@@ -874,7 +1323,7 @@ gz_skip(FILE_T state, gint64 len)
                any more data into the output buffer, so
                return an error indication. */
             return -1;
-        } else if (state->eof && state->in.avail == 0) {
+        } else if (state->eof && state->in.avail == 0 && !state->flush_pending) {
             /* We have nothing in the output buffer, and
                we're at the end of the input; just return. */
             break;
@@ -893,6 +1342,7 @@ gz_reset(FILE_T state)
 {
     buf_reset(&state->out);       /* no output data available */
     state->eof = FALSE;           /* not at end of file */
+    state->flush_pending = FALSE; /* no output held by the decompressor */
     state->compression = UNKNOWN; /* look for gzip header */
 
     state->seek_pending = FALSE;  /* no seek request pending */
@@ -902,6 +1352,59 @@ gz_reset(FILE_T state)
     buf_reset(&state->in);        /* no input data yet */
 }
 
+/*
+ * If fd refers to a regular file, map it, so that we can read it without
+ * a system call per buffer and, if it's not compressed, copy records
+ * straight out of the mapping.  If we can't, e.g. because it's a pipe,
+ * we just read it.
+ *
+ * Only what's in the file now is mapped; if it grows, e.g. because a
+ * capture is still being written to it, buf_read() reads the rest.
+ *
+ * If it's truncated in place while we have it open, reading a page of
+ * the mapping past its new end raises SIGBUS, which we don't catch.
+ * map_still_valid() notices the truncation when we seek or reach the end
+ * of the mapping, so a file that was truncated before we got there is
+ * read through the descriptor, but one truncated underneath a sequential
+ * read can still crash us.  Files that are replaced rather than rewritten,
+ * such as ring buffer files and saved captures, keep the old contents
+ * mapped and aren't affected.
+ */
+static void
+file_map(FILE_T state _U_)
+{
+#ifdef HAVE_SYS_MMAN_H
+    ws_statb64 st;
+    void *map;
+
+    if (ws_fstat64(state->fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+        st.st_size <= 0 || (guint64)st.st_size > G_MAXSIZE)
+        return;
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, state->fd, 0);
+    if (map == MAP_FAILED)
+        return;
+#if defined(MADV_SEQUENTIAL) && defined(MADV_RANDOM)
+    /* We read it in order unless file_set_random_access() said otherwise. */
+    (void)madvise(map, (size_t)st.st_size,
+                  state->map_random ? MADV_RANDOM : MADV_SEQUENTIAL);
+#endif
+    state->map = (guint8 *)map;
+    state->map_size = st.st_size;
+#endif
+}
+
+static void
+file_unmap(FILE_T state)
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (state->map != NULL)
+        munmap(state->map, (size_t)state->map_size);
+#endif
+    state->map = NULL;
+    state->map_size = 0;
+}
+
 FILE_T
 file_fdopen(int fd)
 {
@@ -945,12 +1448,15 @@ file_fdopen(int fd)
 
     /* we don't yet know whether it's compressed */
     state->is_compressed = FALSE;
+    state->compression_type = WTAP_UNCOMPRESSED;
 
     /* save the current position for rewinding (only if reading) */
     state->start = ws_lseek64(state->fd, 0, SEEK_CUR);
     if (state->start == -1) state->start = 0;
     state->raw_pos = state->start;
 
+    file_map(state);
+
     /* initialize stream */
     gz_reset(state);
 
@@ -980,6 +1486,7 @@ file_fdopen(int fd)
     if (state->in.buf == NULL || state->out.buf == NULL) {
         g_free(state->out.buf);
         g_free(state->in.buf);
+        file_unmap(state);
         g_free(state);
         errno = ENOMEM;
         return NULL;
@@ -995,6 +1502,7 @@ file_fdopen(int fd)
     if (inflateInit2(&(state->strm), -15) != Z_OK) {    /* raw inflate */
         g_free(state->out.buf);
         g_free(state->in.buf);
+        file_unmap(state);
         g_free(state);
         errno = ENOMEM;
         return NULL;
@@ -1060,9 +1568,16 @@ file_open(const char *path)
 }
 
 void
-file_set_random_access(FILE_T stream, gboolean random_flag _U_, GPtrArray *seek)
+file_set_random_access(FILE_T stream, gboolean random_flag, GPtrArray *seek)
 {
     stream->fast_seek = seek;
+    stream->map_random = random_flag;
+#if defined(HAVE_SYS_MMAN_H) && defined(MADV_RANDOM)
+    /* The random access stream jumps between records, so read-ahead
+       would mostly fetch pages we don't want. */
+    if (random_flag && stream->map != NULL)
+        (void)madvise(stream->map, (size_t)stream->map_size, MADV_RANDOM);
+#endif
 }
 
 gint64
@@ -1199,21 +1714,33 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
             off = here->in;
             off2 = here->out;
         } else
+#endif
+#ifdef HAVE_ZSTD
+        if (here->compression == ZSTD) {
+            off = here->in;
+            off2 = here->out;
+        } else
+#endif
+#ifdef HAVE_LZ4FRAME_H
+        if (here->compression == LZ4) {
+            off = here->in;
+            off2 = here->out;
+        } else
 #endif
         {
             off2 = (file->pos + offset);
             off = here->in + (off2 - here->out);
         }
 
-        if (ws_lseek64(file->fd, off, SEEK_SET) == -1) {
+        if (raw_seek(file, off) == -1) {
             *err = errno;
             return -1;
         }
         fast_seek_reset(file);
 
-        file->raw_pos = off;
         buf_reset(&file->out);
         file->eof = FALSE;
+        file->flush_pending = FALSE;
         file->seek_pending = FALSE;
         file->err = 0;
         file->err_info = NULL;
@@ -1251,6 +1778,24 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
             strm->adler = crc32(0L, Z_NULL, 0);
             file->compression = ZLIB;
         } else
+#endif
+#ifdef HAVE_ZSTD
+        if (here->compression == ZSTD) {
+            if (zstd_start(file) == -1) {
+                *err = file->err;
+                return -1;
+            }
+            file->compression = ZSTD;
+        } else
+#endif
+#ifdef HAVE_LZ4FRAME_H
+        if (here->compression == LZ4) {
+            if (lz4_start(file) == -1) {
+                *err = file->err;
+                return -1;
+            }
+            file->compression = LZ4;
+        } else
 #endif
             file->compression = here->compression;
 
@@ -1285,11 +1830,10 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         /*
          * Yes.  Just seek there within the file.
          */
-        if (ws_lseek64(file->fd, offset - file->out.avail, SEEK_CUR) == -1) {
+        if (raw_seek(file, file->raw_pos + (offset - file->out.avail)) == -1) {
             *err = errno;
             return -1;
         }
-        file->raw_pos += (offset - file->out.avail);
         buf_reset(&file->out);
         file->eof = FALSE;
         file->seek_pending = FALSE;
@@ -1319,12 +1863,11 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         /* rewind, then skip to offset */
 
         /* back up and start over */
-        if (ws_lseek64(file->fd, file->start, SEEK_SET) == -1) {
+        if (raw_seek(file, file->start) == -1) {
             *err = errno;
             return -1;
         }
         fast_seek_reset(file);
-        file->raw_pos = file->start;
         gz_reset(file);
     }
 
@@ -1381,6 +1924,12 @@ file_iscompressed(FILE_T stream)
     return stream->is_compressed;
 }
 
+static wtap_compression_type
+file_get_compression_type(FILE_T stream)
+{
+    return stream->is_compressed ? stream->compression_type : WTAP_UNCOMPRESSED;
+}
+
 int
 file_read(void *buf, unsigned int len, FILE_T file)
 {
@@ -1416,6 +1965,17 @@ file_read(void *buf, unsigned int len, FILE_T file)
             len -= n;
             got += n;
             file->pos += n;
+        } else if ((n = mapped_avail(file, len)) != 0) {
+            /* Copy straight from the mapped file, saving a copy
+               through the output buffer. */
+            if (buf != NULL) {
+                memcpy(buf, file->map + file->raw_pos, n);
+                buf = (char *)buf + n;
+            }
+            file->raw_pos += n;
+            len -= n;
+            got += n;
+            file->pos += n;
         } else if (file->err != 0) {
             /* We have nothing in the output buffer, and
                we have an error that may not have been
@@ -1423,7 +1983,7 @@ file_read(void *buf, unsigned int len, FILE_T file)
                any more data into the output buffer, so
                return an error indication. */
             return -1;
-        } else if (file->eof && file->in.avail == 0) {
+        } else if (file->eof && file->in.avail == 0 && !file->flush_pending) {
             /* We have nothing in the output buffer, and
                we're at the end of the input; just return
                with what we've gotten so far. */
@@ -1478,7 +2038,7 @@ file_peekc(FILE_T file)
         else if (file->err != 0) {
             return -1;
         }
-        else if (file->eof && file->in.avail == 0) {
+        else if (file->eof && file->in.avail == 0 && !file->flush_pending) {
             return -1;
         }
         else if (fill_out_buffer(file) == -1) {
@@ -1594,7 +2154,7 @@ int
 file_eof(FILE_T file)
 {
     /* return end-of-file state */
-    return (file->eof && file->in.avail == 0 && file->out.avail == 0);
+    return (file->eof && file->in.avail == 0 && !file->flush_pending && file->out.avail == 0);
 }
 
 /*
@@ -1636,6 +2196,15 @@ file_fdreopen(FILE_T file, const char *path)
     if ((fd = ws_open(path, O_RDONLY|O_BINARY, 0000)) == -1)
         return FALSE;
     file->fd = fd;
+
+    /* Map the file we now have open rather than the one we had. */
+    file_unmap(file);
+    file_map(file);
+    if (file->map == NULL && ws_lseek64(fd, file->raw_pos, SEEK_SET) == -1) {
+        ws_close(fd);
+        file->fd = -1;
+        return FALSE;
+    }
     return TRUE;
 }
 
@@ -1648,11 +2217,19 @@ file_close(FILE_T file)
     if (file->size) {
 #ifdef HAVE_ZLIB
         inflateEnd(&(file->strm));
+#endif
+#ifdef HAVE_ZSTD
+        ZSTD_freeDStream(file->zstd_dstream);
+#endif
+#ifdef HAVE_LZ4FRAME_H
+        if (file->lz4_dctx != NULL)
+            LZ4F_freeDecompressionContext(file->lz4_dctx);
 #endif
         g_free(file->out.buf);
         g_free(file->in.buf);
     }
     g_free(file->fast_seek_cur);
+    file_unmap(file);
     file->err = 0;
     file->err_info = NULL;
     g_free(file);
@@ -207,21 +207,116 @@ merge_select_frame_type(int in_file_count, merge_in_file_t in_files[])
 }
 
 /*
- * returns TRUE if first argument is earlier than second
+ * Input files that have a record available, kept as a binary min-heap so
+ * that the file whose record is to be written next is at the top.  This
+ * makes choosing the next record O(log n) in the number of input files
+ * instead of a scan of all of them, which matters when merging thousands
+ * of files.
+ */
+typedef struct {
+    merge_in_file_t **files;
+    guint             count;
+    gboolean          filled;    /* every input file has been read from */
+    merge_in_file_t  *consumed;  /* file whose record we returned last */
+} merge_heap_t;
+
+static void
+merge_heap_init(merge_heap_t *heap, guint in_file_count)
+{
+    heap->files = g_new(merge_in_file_t *, in_file_count);
+    heap->count = 0;
+    heap->filled = FALSE;
+    heap->consumed = NULL;
+}
+
+static void
+merge_heap_cleanup(merge_heap_t *heap)
+{
+    g_free(heap->files);
+    heap->files = NULL;
+}
+
+/*
+ * Returns TRUE if the record from file a is to be written before the one
+ * from file b.  Records with no time stamp are treated as earlier than
+ * all other records (yes, this means you won't get a chronological merge
+ * of those records, but you obviously *can't* get that), and go in file
+ * order among themselves; records with equal time stamps are taken from
+ * the later file first.  This matches the order in which the files were
+ * picked by the linear scan that this replaced.
  */
 static gboolean
-is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
+merge_heap_before(const merge_in_file_t *a, const merge_in_file_t *b)
 {
-    if (l->secs > r->secs) {  /* left is later */
-        return FALSE;
-    } else if (l->secs < r->secs) { /* left is earlier */
-        return TRUE;
-    } else if (l->nsecs > r->nsecs) { /* tv_sec equal, l.usec later */
-        return FALSE;
+    gboolean a_has_ts = (a->rec.presence_flags & WTAP_HAS_TS) != 0;
+    gboolean b_has_ts = (b->rec.presence_flags & WTAP_HAS_TS) != 0;
+
+    if (!a_has_ts || !b_has_ts) {
+        if (a_has_ts)
+            return FALSE;
+        if (b_has_ts)
+            return TRUE;
+        return a < b;
     }
-    /* either one < two or one == two
-     * either way, return one
-     */
+    if (a->rec.ts.secs != b->rec.ts.secs)
+        return a->rec.ts.secs < b->rec.ts.secs;
+    if (a->rec.ts.nsecs != b->rec.ts.nsecs)
+        return a->rec.ts.nsecs < b->rec.ts.nsecs;
+    return a > b;
+}
+
+static void
+merge_heap_sift_down(merge_heap_t *heap, guint i)
+{
+    merge_in_file_t *file = heap->files[i];
+    guint child;
+
+    while ((child = 2 * i + 1) < heap->count) {
+        if (child + 1 < heap->count &&
+            merge_heap_before(heap->files[child + 1], heap->files[child]))
+            child++;
+        if (!merge_heap_before(heap->files[child], file))
+            break;
+        heap->files[i] = heap->files[child];
+        i = child;
+    }
+    heap->files[i] = file;
+}
+
+static void
+merge_heap_push(merge_heap_t *heap, merge_in_file_t *file)
+{
+    guint i = heap->count++;
+    guint parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!merge_heap_before(file, heap->files[parent]))
+            break;
+        heap->files[i] = heap->files[parent];
+        i = parent;
+    }
+    heap->files[i] = file;
+}
+
+/*
+ * Read the next record from a file, updating its state.  Returns FALSE
+ * on a read error.
+ */
+static gboolean
+merge_read_next(merge_in_file_t *in_file, int *err, gchar **err_info)
+{
+    gint64 data_offset;
+
+    if (!wtap_read(in_file->wth, &in_file->rec, &in_file->frame_buffer,
+                   err, err_info, &data_offset)) {
+        if (*err != 0) {
+            in_file->state = GOT_ERROR;
+            return FALSE;
+        }
+        in_file->state = AT_EOF;
+    } else
+        in_file->state = RECORD_PRESENT;
     return TRUE;
 }
 
@@ -237,6 +332,7 @@ is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
  * On an EOF (meaning all the files are at EOF), set *err to 0 and return
  * NULL.
  *
+ * @param heap heap of files with a record available
  * @param in_file_count number of entries in in_files
  * @param in_files input file array
  * @param err wiretap error, if failed
@@ -246,80 +342,59 @@ is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
  * all files
  */
 static merge_in_file_t *
-merge_read_packet(int in_file_count, merge_in_file_t in_files[],
-                  int *err, gchar **err_info)
+merge_read_packet(merge_heap_t *heap, int in_file_count,
+                  merge_in_file_t in_files[], int *err, gchar **err_info)
 {
+    merge_in_file_t *in_file;
     int i;
-    int ei = -1;
-    nstime_t tv = NSTIME_INIT_MAX;
-    wtap_rec *rec;
 
-    /*
-     * Make sure we have a record available from each file that's not at
-     * EOF, and search for the record with the earliest time stamp or
-     * with no time stamp (those records are treated as earlier than
-     * all other records).  Yes, this means you won't get a chronological
-     * merge of those records, but you obviously *can't* get that.
-     */
-    for (i = 0; i < in_file_count; i++) {
-        gint64 data_offset;
-
-        if (in_files[i].state == RECORD_NOT_PRESENT) {
-            /*
-             * No packet available, and we haven't seen an error or EOF yet,
-             * so try to read the next packet.
-             */
-            if (!wtap_read(in_files[i].wth, &in_files[i].rec,
-                           &in_files[i].frame_buffer, err, err_info,
-                           &data_offset)) {
-                if (*err != 0) {
-                    in_files[i].state = GOT_ERROR;
-                    return &in_files[i];
-                }
-                in_files[i].state = AT_EOF;
-            } else
-                in_files[i].state = RECORD_PRESENT;
-        }
-
-        if (in_files[i].state == RECORD_PRESENT) {
-            rec = &in_files[i].rec;
-            if (!(rec->presence_flags & WTAP_HAS_TS)) {
-                /*
-                 * No time stamp.  Pick this record, and stop looking.
-                 */
-                ei = i;
-                break;
-            }
-            if (is_earlier(&rec->ts, &tv)) {
-                /*
-                 * This record's time stamp is earlier than any of the
-                 * records we've seen so far.  Pick it, for now, but
-                 * keep looking.
-                 */
-                tv = rec->ts;
-                ei = i;
-            }
+    if (!heap->filled) {
+        /* Get the first record from each file. */
+        for (i = 0; i < in_file_count; i++) {
+            if (in_files[i].state != RECORD_NOT_PRESENT)
+                continue;
+            if (!merge_read_next(&in_files[i], err, err_info))
+                return &in_files[i];
+            if (in_files[i].state == RECORD_PRESENT)
+                merge_heap_push(heap, &in_files[i]);
         }
+        heap->filled = TRUE;
+    } else if (heap->consumed != NULL) {
+        /*
+         * Replace the record we returned last time, which is still at
+         * the top of the heap, with the next one from the same file.
+         */
+        in_file = heap->consumed;
+        heap->consumed = NULL;
+        if (!merge_read_next(in_file, err, err_info))
+            return in_file;
+        if (in_file->state != RECORD_PRESENT)
+            heap->files[0] = heap->files[--heap->count];
+        if (heap->count > 0)
+            merge_heap_sift_down(heap, 0);
     }
 
-    if (ei == -1) {
+    if (heap->count == 0) {
         /* All the streams are at EOF.  Return an EOF indication. */
         *err = 0;
         return NULL;
     }
 
+    in_file = heap->files[0];
+    heap->consumed = in_file;
+
     /* We'll need to read another packet from this file. */
-    in_files[ei].state = RECORD_NOT_PRESENT;
+    in_file->state = RECORD_NOT_PRESENT;
 
     /* Count this packet. */
-    in_files[ei].packet_num++;
+    in_file->packet_num++;
 
     /*
      * Return a pointer to the merge_in_file_t of the file from which the
      * packet was read.
      */
     *err = 0;
-    return &in_files[ei];
+    return in_file;
 }
 
 /** Read the next packet, in file sequence order, from the set of files
@@ -848,10 +923,13 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
 {
     merge_result        status = MERGE_OK;
     merge_in_file_t    *in_file;
+    merge_heap_t        heap;
     int                 count = 0;
     gboolean            stop_flag = FALSE;
     wtap_rec *rec,      snap_rec;
 
+    merge_heap_init(&heap, in_file_count);
+
     for (;;) {
         *err = 0;
 
@@ -860,8 +938,8 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
                                                err_info);
         }
         else {
-            in_file = merge_read_packet(in_file_count, in_files, err,
-                                        err_info);
+            in_file = merge_read_packet(&heap, in_file_count, in_files,
+                                        err, err_info);
         }
 
         if (in_file == NULL) {
@@ -950,6 +1028,8 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
         }
     }
 
+    merge_heap_cleanup(&heap);
+
     if (cb)
         cb->callback_func(MERGE_EVENT_DONE, count, in_files, in_file_count, cb->data);
 
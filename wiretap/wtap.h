@@ -1767,7 +1767,9 @@ void wtap_rec_cleanup(wtap_rec *rec);
  */
 typedef enum {
     WTAP_UNCOMPRESSED,
-    WTAP_GZIP_COMPRESSED
+    WTAP_GZIP_COMPRESSED,
+    WTAP_ZSTD_COMPRESSED,   /* reading only */
+    WTAP_LZ4_COMPRESSED     /* reading only */
 } wtap_compression_type;
 
 WS_DLL_PUBLIC
@@ -1776,6 +1778,9 @@ WS_DLL_PUBLIC
 const char *wtap_compression_type_description(wtap_compression_type compression_type);
 WS_DLL_PUBLIC
 const char *wtap_compression_type_extension(wtap_compression_type compression_type);
+/** Returns TRUE if files can be written with this type of compression. */
+WS_DLL_PUBLIC
+gboolean wtap_can_write_compression_type(wtap_compression_type compression_type);
 WS_DLL_PUBLIC
 GSList *wtap_get_all_compression_type_extensions_list(void);
 
@@ -0,0 +1,788 @@
+/* arrow_writer.c
+ * Routines for writing tables in the Apache Arrow IPC file format.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include "arrow_writer.h"
+
+#include <string.h>
+
+#include "pint.h"
+
+/*
+ * An Arrow IPC file is the "ARROW1" magic, a stream of messages and a
+ * footer with the schema and the locations of the record batches.  Each
+ * message is a FlatBuffers encoded header followed by a body with the
+ * buffers of the columns.  See
+ *
+ *   https://arrow.apache.org/docs/format/Columnar.html
+ *
+ * for the format, and Schema.fbs, Message.fbs and File.fbs in the Arrow
+ * sources for the definitions of the headers.  We only need to write a
+ * handful of FlatBuffers tables, so we build them by hand; as offsets
+ * must point forward, tables are written before what they refer to, and
+ * the offsets are filled in once that has been written.
+ */
+
+#define ARROW_MAGIC                 "ARROW1"
+#define ARROW_CONTINUATION          0xFFFFFFFFU
+
+#define ARROW_METADATA_V5           4
+
+#define ARROW_HEADER_SCHEMA         1
+#define ARROW_HEADER_RECORD_BATCH   3
+
+/* Type union tags */
+#define ARROW_FB_TYPE_INT           2
+#define ARROW_FB_TYPE_FLOATING      3
+#define ARROW_FB_TYPE_BINARY        4
+#define ARROW_FB_TYPE_UTF8          5
+#define ARROW_FB_TYPE_BOOL          6
+#define ARROW_FB_TYPE_TIMESTAMP     10
+#define ARROW_FB_TYPE_LIST          12
+#define ARROW_FB_TYPE_DURATION      18
+
+#define ARROW_PRECISION_DOUBLE      2
+#define ARROW_TIME_UNIT_NANOSECOND  3
+
+/*
+ * The offsets of binary and UTF-8 values are 32-bit signed integers, so
+ * the data of a column must stay below 2 GiB in each record batch.  A
+ * batch is written early once a column holds this much, which leaves
+ * the rest for the values of the row that follows.
+ */
+#define ARROW_BATCH_MAX_BYTES       (1U << 30)
+
+typedef struct {
+    gchar      *name;
+    arrow_type  type;
+    gboolean    list;
+    /* List level: one entry per row, for list columns. */
+    GByteArray *list_validity;
+    GByteArray *list_offsets;
+    guint32     list_nulls;
+    /* Values */
+    GByteArray *validity;
+    GByteArray *offsets;        /* For ARROW_TYPE_BINARY and ARROW_TYPE_UTF8 */
+    GByteArray *data;
+    guint32     length;
+    guint32     nulls;
+    guint32     row_values;     /* Values in the current row */
+} arrow_column;
+
+typedef struct {
+    gint64  offset;
+    gint32  metadata_length;
+    gint64  body_length;
+} arrow_block;
+
+struct arrow_writer {
+    FILE       *fh;
+    guint       batch_rows;
+    GPtrArray  *columns;
+    GArray     *blocks;         /* Record batches written so far */
+    guint32     rows;           /* Rows in the current batch */
+    gint64      offset;         /* Bytes written so far */
+    gboolean    error;
+};
+
+/* A field of a FlatBuffers table: its id and its size. */
+typedef struct {
+    guint8  slot;
+    guint8  size;
+} fb_field_t;
+
+static guint
+fb_reserve(GByteArray *fb, guint len)
+{
+    guint pos = fb->len;
+
+    g_byte_array_set_size(fb, pos + len);
+    memset(fb->data + pos, 0, len);
+    return pos;
+}
+
+static void
+fb_align(GByteArray *fb, guint align)
+{
+    if (fb->len % align != 0)
+        fb_reserve(fb, align - fb->len % align);
+}
+
+/* Point the offset at "at" to the object at "target". */
+static void
+fb_set_offset(GByteArray *fb, guint at, guint target)
+{
+    phtole32(fb->data + at, target - at);
+}
+
+/*
+ * Write a table with the given fields, zeroed, and its vtable.  Returns
+ * the position of the table, and the positions of the fields in
+ * field_pos.
+ */
+static guint
+fb_table(GByteArray *fb, guint slots, const fb_field_t *fields, guint nfields, guint *field_pos)
+{
+    guint16 offsets[8];
+    guint16 size = 4;
+    guint   vtable, table, i;
+
+    g_assert(nfields <= G_N_ELEMENTS(offsets));
+
+    for (i = 0; i < nfields; i++) {
+        size = (size + fields[i].size - 1) & ~(fields[i].size - 1);
+        offsets[i] = size;
+        size += fields[i].size;
+    }
+
+    fb_align(fb, 2);
+    vtable = fb_reserve(fb, 4 + 2 * slots);
+    phtole16(fb->data + vtable, 4 + 2 * slots);
+    phtole16(fb->data + vtable + 2, size);
+    for (i = 0; i < nfields; i++)
+        phtole16(fb->data + vtable + 4 + 2 * fields[i].slot, offsets[i]);
+
+    fb_align(fb, 8);
+    table = fb_reserve(fb, size);
+    phtole32(fb->data + table, table - vtable);
+    for (i = 0; i < nfields; i++)
+        field_pos[i] = table + offsets[i];
+    return table;
+}
+
+static guint
+fb_empty_table(GByteArray *fb)
+{
+    return fb_table(fb, 0, NULL, 0, NULL);
+}
+
+static guint
+fb_string(GByteArray *fb, const char *str)
+{
+    guint len = (guint)strlen(str);
+    guint pos;
+
+    fb_align(fb, 4);
+    pos = fb_reserve(fb, 4 + len + 1);
+    phtole32(fb->data + pos, len);
+    memcpy(fb->data + pos + 4, str, len);
+    return pos;
+}
+
+/* Write a zeroed vector; its elements start at the returned position + 4. */
+static guint
+fb_vector(GByteArray *fb, guint count, guint elem_size, guint elem_align)
+{
+    guint pos;
+
+    fb_align(fb, 4);
+    if ((fb->len + 4) % elem_align != 0)
+        fb_reserve(fb, 4);
+    pos = fb_reserve(fb, 4 + count * elem_size);
+    phtole32(fb->data + pos, count);
+    return pos;
+}
+
+/* Write the table for a type; returns its union tag. */
+static guint8
+fb_type(GByteArray *fb, arrow_type type, guint *table)
+{
+    static const fb_field_t int_fields[] = {
+        { 0, 4 },   /* bitWidth */
+        { 1, 1 },   /* is_signed */
+    };
+    static const fb_field_t unit_fields[] = {
+        { 0, 2 },   /* precision or unit */
+    };
+    static const fb_field_t timestamp_fields[] = {
+        { 1, 4 },   /* timezone */
+        { 0, 2 },   /* unit */
+    };
+    guint pos[2];
+
+    switch (type) {
+
+    case ARROW_TYPE_UINT32:
+    case ARROW_TYPE_UINT64:
+    case ARROW_TYPE_INT64:
+        *table = fb_table(fb, 2, int_fields, G_N_ELEMENTS(int_fields), pos);
+        phtole32(fb->data + pos[0], type == ARROW_TYPE_UINT32 ? 32 : 64);
+        fb->data[pos[1]] = (type == ARROW_TYPE_INT64);
+        return ARROW_FB_TYPE_INT;
+
+    case ARROW_TYPE_DOUBLE:
+        *table = fb_table(fb, 1, unit_fields, G_N_ELEMENTS(unit_fields), pos);
+        phtole16(fb->data + pos[0], ARROW_PRECISION_DOUBLE);
+        return ARROW_FB_TYPE_FLOATING;
+
+    case ARROW_TYPE_BOOL:
+        *table = fb_empty_table(fb);
+        return ARROW_FB_TYPE_BOOL;
+
+    case ARROW_TYPE_TIMESTAMP:
+        *table = fb_table(fb, 2, timestamp_fields, G_N_ELEMENTS(timestamp_fields), pos);
+        phtole16(fb->data + pos[1], ARROW_TIME_UNIT_NANOSECOND);
+        fb_set_offset(fb, pos[0], fb_string(fb, "UTC"));
+        return ARROW_FB_TYPE_TIMESTAMP;
+
+    case ARROW_TYPE_DURATION:
+        *table = fb_table(fb, 1, unit_fields, G_N_ELEMENTS(unit_fields), pos);
+        phtole16(fb->data + pos[0], ARROW_TIME_UNIT_NANOSECOND);
+        return ARROW_FB_TYPE_DURATION;
+
+    case ARROW_TYPE_BINARY:
+        *table = fb_empty_table(fb);
+        return ARROW_FB_TYPE_BINARY;
+
+    case ARROW_TYPE_UTF8:
+    default:
+        *table = fb_empty_table(fb);
+        return ARROW_FB_TYPE_UTF8;
+    }
+}
+
+static guint
+fb_field(GByteArray *fb, const char *name, arrow_type type, gboolean list)
+{
+    static const fb_field_t field_fields[] = {
+        { 0, 4 },   /* name */
+        { 3, 4 },   /* type */
+        { 5, 4 },   /* children */
+        { 1, 1 },   /* nullable */
+        { 2, 1 },   /* type_type */
+    };
+    guint pos[5];
+    guint table, type_table, children;
+    guint8 type_type;
+
+    table = fb_table(fb, 6, field_fields, G_N_ELEMENTS(field_fields), pos);
+    fb->data[pos[3]] = TRUE;
+    fb_set_offset(fb, pos[0], fb_string(fb, name));
+
+    if (list) {
+        fb->data[pos[4]] = ARROW_FB_TYPE_LIST;
+        fb_set_offset(fb, pos[1], fb_empty_table(fb));
+        children = fb_vector(fb, 1, 4, 4);
+        fb_set_offset(fb, pos[2], children);
+        fb_set_offset(fb, children + 4, fb_field(fb, "item", type, FALSE));
+    } else {
+        /* fb_type() may move fb->data. */
+        type_type = fb_type(fb, type, &type_table);
+        fb->data[pos[4]] = type_type;
+        fb_set_offset(fb, pos[1], type_table);
+        fb_set_offset(fb, pos[2], fb_vector(fb, 0, 4, 4));
+    }
+    return table;
+}
+
+static guint
+fb_schema(arrow_writer *writer, GByteArray *fb)
+{
+    static const fb_field_t schema_fields[] = {
+        { 1, 4 },   /* fields */
+    };
+    arrow_column *column;
+    guint pos[1];
+    guint table, fields, i;
+
+    table = fb_table(fb, 2, schema_fields, G_N_ELEMENTS(schema_fields), pos);
+    fields = fb_vector(fb, writer->columns->len, 4, 4);
+    fb_set_offset(fb, pos[0], fields);
+    for (i = 0; i < writer->columns->len; i++) {
+        column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+        fb_set_offset(fb, fields + 4 + 4 * i, fb_field(fb, column->name, column->type, column->list));
+    }
+    return table;
+}
+
+/*
+ * Start a message with the given header type and body length; returns
+ * the position of the offset to the header, which the caller writes.
+ */
+static guint
+fb_message(GByteArray *fb, guint8 header_type, gint64 body_length)
+{
+    static const fb_field_t message_fields[] = {
+        { 3, 8 },   /* bodyLength */
+        { 2, 4 },   /* header */
+        { 0, 2 },   /* version */
+        { 1, 1 },   /* header_type */
+    };
+    guint pos[4];
+    guint root, table;
+
+    root = fb_reserve(fb, 4);
+    table = fb_table(fb, 4, message_fields, G_N_ELEMENTS(message_fields), pos);
+    fb_set_offset(fb, root, table);
+    phtole64(fb->data + pos[0], body_length);
+    phtole16(fb->data + pos[2], ARROW_METADATA_V5);
+    fb->data[pos[3]] = header_type;
+    return pos[1];
+}
+
+static void
+arrow_write(arrow_writer *writer, const void *data, gsize len)
+{
+    if (len == 0 || writer->error)
+        return;
+    if (fwrite(data, 1, len, writer->fh) != len) {
+        writer->error = TRUE;
+        return;
+    }
+    writer->offset += len;
+}
+
+static void
+arrow_write_u32(arrow_writer *writer, guint32 value)
+{
+    guint8 buf[4];
+
+    phtole32(buf, value);
+    arrow_write(writer, buf, sizeof buf);
+}
+
+/* Write a message with its metadata and body, and return where it went. */
+static arrow_block
+arrow_write_message(arrow_writer *writer, GByteArray *fb, const GByteArray *body)
+{
+    arrow_block block;
+
+    fb_align(fb, 8);
+    block.offset = writer->offset;
+    block.metadata_length = 8 + fb->len;
+    block.body_length = body ? body->len : 0;
+
+    arrow_write_u32(writer, ARROW_CONTINUATION);
+    arrow_write_u32(writer, fb->len);
+    arrow_write(writer, fb->data, fb->len);
+    if (body)
+        arrow_write(writer, body->data, body->len);
+    return block;
+}
+
+static void
+bitmap_set(GByteArray *bitmap, guint32 index, gboolean value)
+{
+    guint old_len = bitmap->len;
+
+    if (old_len <= index / 8) {
+        g_byte_array_set_size(bitmap, index / 8 + 1);
+        memset(bitmap->data + old_len, 0, bitmap->len - old_len);
+    }
+    if (value)
+        bitmap->data[index / 8] |= 1 << (index % 8);
+}
+
+static void
+offsets_append(GByteArray *offsets, guint32 value)
+{
+    guint8 buf[4];
+
+    phtole32(buf, value);
+    g_byte_array_append(offsets, buf, sizeof buf);
+}
+
+static guint
+arrow_type_width(arrow_type type)
+{
+    switch (type) {
+    case ARROW_TYPE_UINT32:
+        return 4;
+    case ARROW_TYPE_UINT64:
+    case ARROW_TYPE_INT64:
+    case ARROW_TYPE_DOUBLE:
+    case ARROW_TYPE_TIMESTAMP:
+    case ARROW_TYPE_DURATION:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static void
+column_reset(arrow_column *column)
+{
+    g_byte_array_set_size(column->validity, 0);
+    g_byte_array_set_size(column->data, 0);
+    column->length = 0;
+    column->nulls = 0;
+    if (column->offsets) {
+        g_byte_array_set_size(column->offsets, 0);
+        offsets_append(column->offsets, 0);
+    }
+    if (column->list) {
+        g_byte_array_set_size(column->list_validity, 0);
+        g_byte_array_set_size(column->list_offsets, 0);
+        offsets_append(column->list_offsets, 0);
+        column->list_nulls = 0;
+    }
+}
+
+static void
+column_free(gpointer data)
+{
+    arrow_column *column = (arrow_column *)data;
+
+    g_free(column->name);
+    if (column->list) {
+        g_byte_array_free(column->list_validity, TRUE);
+        g_byte_array_free(column->list_offsets, TRUE);
+    }
+    g_byte_array_free(column->validity, TRUE);
+    if (column->offsets)
+        g_byte_array_free(column->offsets, TRUE);
+    g_byte_array_free(column->data, TRUE);
+    g_free(column);
+}
+
+/*
+ * Get the column to append a value to, or NULL if it already has its
+ * value for this row.
+ */
+static arrow_column *
+column_for_value(arrow_writer *writer, guint index)
+{
+    arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, index);
+
+    if (!column->list && column->row_values != 0)
+        return NULL;
+    column->row_values++;
+    bitmap_set(column->validity, column->length, TRUE);
+    column->length++;
+    return column;
+}
+
+static void
+column_append_null(arrow_column *column)
+{
+    guint width = arrow_type_width(column->type);
+
+    bitmap_set(column->validity, column->length, FALSE);
+    if (column->type == ARROW_TYPE_BOOL)
+        bitmap_set(column->data, column->length, FALSE);
+    else if (column->offsets)
+        offsets_append(column->offsets, column->data->len);
+    else
+        fb_reserve(column->data, width);
+    column->length++;
+    column->nulls++;
+}
+
+/* Add a buffer to the body of a record batch, and describe it in "buffers". */
+static void
+body_add_buffer(GByteArray *body, GArray *buffers, const guint8 *data, guint len)
+{
+    gint64 desc[2];
+
+    desc[0] = body->len;
+    desc[1] = len;
+    g_array_append_vals(buffers, desc, 1);
+    if (len != 0) {
+        g_byte_array_append(body, data, len);
+        fb_align(body, 8);
+    }
+}
+
+static void
+body_add_column(GByteArray *body, GArray *nodes, GArray *buffers, const arrow_column *column, guint32 rows)
+{
+    gint64 node[2];
+
+    if (column->list) {
+        node[0] = rows;
+        node[1] = column->list_nulls;
+        g_array_append_vals(nodes, node, 1);
+        body_add_buffer(body, buffers, column->list_validity->data,
+                        column->list_nulls ? column->list_validity->len : 0);
+        body_add_buffer(body, buffers, column->list_offsets->data, column->list_offsets->len);
+    }
+
+    node[0] = column->length;
+    node[1] = column->nulls;
+    g_array_append_vals(nodes, node, 1);
+    body_add_buffer(body, buffers, column->validity->data,
+                    column->nulls ? column->validity->len : 0);
+    if (column->offsets)
+        body_add_buffer(body, buffers, column->offsets->data, column->offsets->len);
+    body_add_buffer(body, buffers, column->data->data, column->data->len);
+}
+
+static void
+arrow_write_record_batch(arrow_writer *writer)
+{
+    static const fb_field_t record_batch_fields[] = {
+        { 0, 8 },   /* length */
+        { 1, 4 },   /* nodes */
+        { 2, 4 },   /* buffers */
+    };
+    GByteArray   *fb, *body;
+    GArray       *nodes, *buffers;
+    arrow_column *column;
+    arrow_block   block;
+    guint         header, pos[3], vector, i;
+
+    /* A FieldNode and a Buffer are both two 64-bit integers. */
+    body = g_byte_array_new();
+    nodes = g_array_new(FALSE, FALSE, 2 * sizeof(gint64));
+    buffers = g_array_new(FALSE, FALSE, 2 * sizeof(gint64));
+    for (i = 0; i < writer->columns->len; i++) {
+        column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+        body_add_column(body, nodes, buffers, column, writer->rows);
+    }
+
+    fb = g_byte_array_new();
+    header = fb_message(fb, ARROW_HEADER_RECORD_BATCH, body->len);
+    fb_set_offset(fb, header,
+                  fb_table(fb, 3, record_batch_fields, G_N_ELEMENTS(record_batch_fields), pos));
+    phtole64(fb->data + pos[0], writer->rows);
+
+    vector = fb_vector(fb, nodes->len, 16, 8);
+    fb_set_offset(fb, pos[1], vector);
+    for (i = 0; i < nodes->len; i++) {
+        phtole64(fb->data + vector + 4 + 16 * i, g_array_index(nodes, gint64, 2 * i));
+        phtole64(fb->data + vector + 4 + 16 * i + 8, g_array_index(nodes, gint64, 2 * i + 1));
+    }
+
+    vector = fb_vector(fb, buffers->len, 16, 8);
+    fb_set_offset(fb, pos[2], vector);
+    for (i = 0; i < buffers->len; i++) {
+        phtole64(fb->data + vector + 4 + 16 * i, g_array_index(buffers, gint64, 2 * i));
+        phtole64(fb->data + vector + 4 + 16 * i + 8, g_array_index(buffers, gint64, 2 * i + 1));
+    }
+
+    block = arrow_write_message(writer, fb, body);
+    g_array_append_val(writer->blocks, block);
+
+    g_byte_array_free(fb, TRUE);
+    g_byte_array_free(body, TRUE);
+    g_array_free(nodes, TRUE);
+    g_array_free(buffers, TRUE);
+
+    for (i = 0; i < writer->columns->len; i++)
+        column_reset((arrow_column *)g_ptr_array_index(writer->columns, i));
+    writer->rows = 0;
+}
+
+arrow_writer *
+arrow_writer_new(FILE *fh, guint batch_rows)
+{
+    arrow_writer *writer = g_new0(arrow_writer, 1);
+
+    writer->fh = fh;
+    writer->batch_rows = batch_rows ? batch_rows : ARROW_WRITER_BATCH_ROWS;
+    writer->columns = g_ptr_array_new_with_free_func(column_free);
+    writer->blocks = g_array_new(FALSE, FALSE, sizeof(arrow_block));
+    return writer;
+}
+
+void
+arrow_writer_add_column(arrow_writer *writer, const char *name, arrow_type type, gboolean list)
+{
+    arrow_column *column = g_new0(arrow_column, 1);
+
+    column->name = g_strdup(name);
+    column->type = type;
+    column->list = list;
+    if (list) {
+        column->list_validity = g_byte_array_new();
+        column->list_offsets = g_byte_array_new();
+    }
+    column->validity = g_byte_array_new();
+    if (type == ARROW_TYPE_BINARY || type == ARROW_TYPE_UTF8)
+        column->offsets = g_byte_array_new();
+    column->data = g_byte_array_new();
+    column_reset(column);
+    g_ptr_array_add(writer->columns, column);
+}
+
+gboolean
+arrow_writer_begin(arrow_writer *writer)
+{
+    static const guint8 magic[8] = ARROW_MAGIC;
+    GByteArray *fb = g_byte_array_new();
+    guint header;
+
+    arrow_write(writer, magic, sizeof magic);
+
+    header = fb_message(fb, ARROW_HEADER_SCHEMA, 0);
+    fb_set_offset(fb, header, fb_schema(writer, fb));
+    arrow_write_message(writer, fb, NULL);
+    g_byte_array_free(fb, TRUE);
+
+    return !writer->error;
+}
+
+void
+arrow_writer_append_uint(arrow_writer *writer, guint column_index, guint64 value)
+{
+    arrow_column *column = column_for_value(writer, column_index);
+    guint8 buf[8];
+
+    if (!column)
+        return;
+    switch (column->type) {
+    case ARROW_TYPE_BOOL:
+        bitmap_set(column->data, column->length - 1, value != 0);
+        break;
+    case ARROW_TYPE_UINT32:
+        phtole32(buf, (guint32)value);
+        g_byte_array_append(column->data, buf, 4);
+        break;
+    default:
+        phtole64(buf, value);
+        g_byte_array_append(column->data, buf, 8);
+        break;
+    }
+}
+
+void
+arrow_writer_append_int(arrow_writer *writer, guint column_index, gint64 value)
+{
+    arrow_column *column = column_for_value(writer, column_index);
+    guint8 buf[8];
+
+    if (!column)
+        return;
+    phtole64(buf, (guint64)value);
+    g_byte_array_append(column->data, buf, 8);
+}
+
+void
+arrow_writer_append_double(arrow_writer *writer, guint column_index, double value)
+{
+    arrow_column *column = column_for_value(writer, column_index);
+    union {
+        double  d;
+        guint64 u;
+    } bits;
+    guint8 buf[8];
+
+    if (!column)
+        return;
+    bits.d = value;
+    phtole64(buf, bits.u);
+    g_byte_array_append(column->data, buf, 8);
+}
+
+void
+arrow_writer_append_bytes(arrow_writer *writer, guint column_index, const guint8 *data, gsize len)
+{
+    arrow_column *column = column_for_value(writer, column_index);
+
+    if (!column)
+        return;
+    if (len > (gsize)(G_MAXINT32 - column->data->len)) {
+        /* More than a row can add to a batch; see ARROW_BATCH_MAX_BYTES. */
+        writer->error = TRUE;
+        return;
+    }
+    g_byte_array_append(column->data, data, (guint)len);
+    offsets_append(column->offsets, column->data->len);
+}
+
+gboolean
+arrow_writer_end_row(arrow_writer *writer)
+{
+    arrow_column *column;
+    gboolean full = FALSE;
+    guint i;
+
+    for (i = 0; i < writer->columns->len; i++) {
+        column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+        if (column->list) {
+            bitmap_set(column->list_validity, writer->rows, column->row_values != 0);
+            if (column->row_values == 0)
+                column->list_nulls++;
+            offsets_append(column->list_offsets, column->length);
+        } else if (column->row_values == 0) {
+            column_append_null(column);
+        }
+        column->row_values = 0;
+        if (column->data->len >= ARROW_BATCH_MAX_BYTES)
+            full = TRUE;
+    }
+
+    writer->rows++;
+    if (writer->rows >= writer->batch_rows || full)
+        arrow_write_record_batch(writer);
+
+    return !writer->error;
+}
+
+gboolean
+arrow_writer_finish(arrow_writer *writer)
+{
+    static const fb_field_t footer_fields[] = {
+        { 1, 4 },   /* schema */
+        { 3, 4 },   /* recordBatches */
+        { 0, 2 },   /* version */
+    };
+    static const guint8 magic[6] = { 'A', 'R', 'R', 'O', 'W', '1' };
+    GByteArray  *fb;
+    arrow_block *block;
+    guint        root, pos[3], vector, i;
+
+    if (writer->rows != 0)
+        arrow_write_record_batch(writer);
+
+    /* End of the stream */
+    arrow_write_u32(writer, ARROW_CONTINUATION);
+    arrow_write_u32(writer, 0);
+
+    fb = g_byte_array_new();
+    root = fb_reserve(fb, 4);
+    fb_set_offset(fb, root,
+                  fb_table(fb, 4, footer_fields, G_N_ELEMENTS(footer_fields), pos));
+    phtole16(fb->data + pos[2], ARROW_METADATA_V5);
+    fb_set_offset(fb, pos[0], fb_schema(writer, fb));
+
+    /* A Block is an offset, a 32-bit metadata length padded to 64 bits,
+       and a body length. */
+    vector = fb_vector(fb, writer->blocks->len, 24, 8);
+    fb_set_offset(fb, pos[1], vector);
+    for (i = 0; i < writer->blocks->len; i++) {
+        block = &g_array_index(writer->blocks, arrow_block, i);
+        phtole64(fb->data + vector + 4 + 24 * i, block->offset);
+        phtole32(fb->data + vector + 4 + 24 * i + 8, block->metadata_length);
+        phtole64(fb->data + vector + 4 + 24 * i + 16, block->body_length);
+    }
+
+    arrow_write(writer, fb->data, fb->len);
+    arrow_write_u32(writer, fb->len);
+    arrow_write(writer, magic, sizeof magic);
+    g_byte_array_free(fb, TRUE);
+
+    fflush(writer->fh);
+    return !writer->error && !ferror(writer->fh);
+}
+
+void
+arrow_writer_free(arrow_writer *writer)
+{
+    if (!writer)
+        return;
+    g_ptr_array_free(writer->columns, TRUE);
+    g_array_free(writer->blocks, TRUE);
+    g_free(writer);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
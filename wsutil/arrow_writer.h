@@ -0,0 +1,108 @@
+/* arrow_writer.h
+ * Routines for writing tables in the Apache Arrow IPC file format.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ARROW_WRITER_H__
+#define __ARROW_WRITER_H__
+
+#include "ws_symbol_export.h"
+#include <glib.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Writes a table column by column, in batches of rows, as an Arrow IPC
+ * file (also known as Feather V2), which analytics tools can load
+ * without parsing it.
+ *
+ * Example:
+ *
+ *  arrow_writer *writer = arrow_writer_new(stdout, 0);
+ *  arrow_writer_add_column(writer, "frame.number", ARROW_TYPE_UINT64, FALSE);
+ *  arrow_writer_add_column(writer, "ip.src", ARROW_TYPE_UINT32, TRUE);
+ *  arrow_writer_begin(writer);
+ *  arrow_writer_append_uint(writer, 0, 1);
+ *  arrow_writer_append_uint(writer, 1, 0x0a000001);
+ *  arrow_writer_append_uint(writer, 1, 0x0a000002);
+ *  arrow_writer_end_row(writer);
+ *  arrow_writer_finish(writer);
+ *  arrow_writer_free(writer);
+ *
+ * Columns that get no value in a row are null in that row.  List columns
+ * take any number of values per row, the others at most one.
+ */
+
+typedef enum {
+    ARROW_TYPE_UINT32,
+    ARROW_TYPE_UINT64,
+    ARROW_TYPE_INT64,
+    ARROW_TYPE_DOUBLE,
+    ARROW_TYPE_BOOL,
+    ARROW_TYPE_TIMESTAMP,   /* Nanoseconds since the epoch, UTC */
+    ARROW_TYPE_DURATION,    /* Nanoseconds */
+    ARROW_TYPE_BINARY,
+    ARROW_TYPE_UTF8
+} arrow_type;
+
+/** Default number of rows per record batch. */
+#define ARROW_WRITER_BATCH_ROWS 65536
+
+typedef struct arrow_writer arrow_writer;
+
+/**
+ * Create a writer for the given file.  Rows are written in batches of
+ * batch_rows, or ARROW_WRITER_BATCH_ROWS if it is 0.  A batch is written
+ * early if a column holds more than 1 GiB of data.
+ */
+WS_DLL_PUBLIC arrow_writer *
+arrow_writer_new(FILE *fh, guint batch_rows);
+
+/** Add a column; all of them must be added before arrow_writer_begin(). */
+WS_DLL_PUBLIC void
+arrow_writer_add_column(arrow_writer *writer, const char *name, arrow_type type, gboolean list);
+
+/** Write the header and the schema. */
+WS_DLL_PUBLIC gboolean
+arrow_writer_begin(arrow_writer *writer);
+
+/** Append a value to a ARROW_TYPE_UINT32, ARROW_TYPE_UINT64 or ARROW_TYPE_BOOL column. */
+WS_DLL_PUBLIC void
+arrow_writer_append_uint(arrow_writer *writer, guint column, guint64 value);
+
+/** Append a value to a ARROW_TYPE_INT64, ARROW_TYPE_TIMESTAMP or ARROW_TYPE_DURATION column. */
+WS_DLL_PUBLIC void
+arrow_writer_append_int(arrow_writer *writer, guint column, gint64 value);
+
+/** Append a value to a ARROW_TYPE_DOUBLE column. */
+WS_DLL_PUBLIC void
+arrow_writer_append_double(arrow_writer *writer, guint column, double value);
+
+/** Append a value to a ARROW_TYPE_BINARY or ARROW_TYPE_UTF8 column. */
+WS_DLL_PUBLIC void
+arrow_writer_append_bytes(arrow_writer *writer, guint column, const guint8 *data, gsize len);
+
+/** Finish the current row, writing a record batch if it is full. */
+WS_DLL_PUBLIC gboolean
+arrow_writer_end_row(arrow_writer *writer);
+
+/** Write the remaining rows and the footer. */
+WS_DLL_PUBLIC gboolean
+arrow_writer_finish(arrow_writer *writer);
+
+WS_DLL_PUBLIC void
+arrow_writer_free(arrow_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ARROW_WRITER_H__ */
@@ -32,6 +32,7 @@ enum json_dumper_element_type {
 
 #define JSON_DUMPER_FLAGS_ERROR     (1 << 16)   /* Output flag: an error occurred. */
 #define JSON_DUMPER_FLAGS_NO_DEBUG  (1 << 17)   /* Input flag: disable debug prints (intended for speeding up fuzzing). */
+#define JSON_DUMPER_FLAGS_OWN_BUFFER (1 << 18)  /* Internal flag: output_buffer was allocated by the dumper. */
 
 enum json_dumper_change {
     JSON_DUMPER_BEGIN,
@@ -42,11 +43,73 @@ enum json_dumper_change {
     JSON_DUMPER_FINISH,
 };
 
+/* Output is collected in a buffer and written out in chunks of about this size. */
+#define JSON_DUMPER_FLUSH_SIZE  65536
+
+/*
+ * Characters that cannot be copied as they are into a JSON string: control
+ * characters, quotes and backslashes, and the slash of "</". Dots are only
+ * special in names written with JSON_DUMPER_DOT_TO_UNDERSCORE.
+ */
+#define JSON_CHAR_SPECIAL   1
+#define JSON_CHAR_DOT       2
+static const guint8 json_char_class[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static GString *
+json_dumper_output(json_dumper *dumper)
+{
+    if (!dumper->output_buffer) {
+        dumper->output_buffer = g_string_sized_new(4096);
+        dumper->flags |= JSON_DUMPER_FLAGS_OWN_BUFFER;
+    }
+    return dumper->output_buffer;
+}
+
+gboolean
+json_dumper_flush(json_dumper *dumper)
+{
+    GString *out = dumper->output_buffer;
+    gboolean ok = TRUE;
+
+    if (out && out->len) {
+        /* Whatever couldn't be written is dropped, as retrying is unlikely
+         * to help; the error is also left on output_file for ferror(). */
+        ok = fwrite(out->str, 1, out->len, dumper->output_file) == out->len;
+        g_string_truncate(out, 0);
+    }
+    return ok;
+}
+
+static inline void
+json_dumper_flush_if_full(json_dumper *dumper)
+{
+    if (dumper->output_buffer && dumper->output_buffer->len >= JSON_DUMPER_FLUSH_SIZE) {
+        json_dumper_flush(dumper);
+    }
+}
+
 static void
-json_puts_string(FILE *fp, const char *str, gboolean dot_to_underscore)
+json_puts_string(GString *out, const char *str, gboolean dot_to_underscore)
 {
     if (!str) {
-        fputs("null", fp);
+        g_string_append_len(out, "null", 4);
         return;
     }
 
@@ -54,26 +117,42 @@ json_puts_string(FILE *fp, const char *str, gboolean dot_to_underscore)
         "u0000", "u0001", "u0002", "u0003", "u0004", "u0005", "u0006", "u0007", "b",     "t",     "n",     "u000b", "f",     "r",     "u000e", "u000f",
         "u0010", "u0011", "u0012", "u0013", "u0014", "u0015", "u0016", "u0017", "u0018", "u0019", "u001a", "u001b", "u001c", "u001d", "u001e", "u001f"
     };
+    const guint8 special = dot_to_underscore ? JSON_CHAR_SPECIAL | JSON_CHAR_DOT : JSON_CHAR_SPECIAL;
+    const char *run = str;
+    const char *p = str;
+
+    g_string_append_c(out, '"');
+    for (;;) {
+        /* Copy everything up to the next special character (or the
+         * terminating NUL, which is one too) at once. */
+        while (!(json_char_class[(guchar)*p] & special)) {
+            p++;
+        }
+        if (p > run) {
+            g_string_append_len(out, run, p - run);
+        }
 
-    fputc('"', fp);
-    for (int i = 0; str[i]; i++) {
-        if ((guint)str[i] < 0x20) {
-            fputc('\\', fp);
-            fputs(json_cntrl[(guint)str[i]], fp);
-        } else if (i > 0 && str[i - 1] == '<' && str[i] == '/') {
+        guchar c = (guchar)*p;
+        if (c == '\0') {
+            break;
+        } else if (c < 0x20) {
+            g_string_append_c(out, '\\');
+            g_string_append(out, json_cntrl[c]);
+        } else if (c == '/') {
             // Convert </script> to <\/script> to avoid breaking web pages.
-            fputs("\\/", fp);
-        } else {
-            if (str[i] == '\\' || str[i] == '"') {
-                fputc('\\', fp);
+            if (p > str && p[-1] == '<') {
+                g_string_append_c(out, '\\');
             }
-            if (dot_to_underscore && str[i] == '.')
-                fputc('_', fp);
-            else
-                fputc(str[i], fp);
+            g_string_append_c(out, '/');
+        } else if (c == '.') {
+            g_string_append_c(out, '_');
+        } else {
+            g_string_append_c(out, '\\');
+            g_string_append_c(out, c);
         }
+        run = ++p;
     }
-    fputc('"', fp);
+    g_string_append_c(out, '"');
 }
 
 /**
@@ -100,6 +179,7 @@ json_dumper_bad(json_dumper *dumper, enum json_dumper_change change,
         /* Console output can be slow, disable log calls to speed up fuzzing. */
         return;
     }
+    json_dumper_flush(dumper);
     fflush(dumper->output_file);
     g_error("Bad json_dumper state: %s; change=%d type=%d depth=%d prev/curr/next state=%02x %02x %02x",
             what, change, type, dumper->current_depth, states[0], states[1], states[2]);
@@ -167,12 +247,12 @@ json_dumper_check_state(json_dumper *dumper, enum json_dumper_change change, enu
 }
 
 static void
-print_newline_indent(const json_dumper *dumper, int depth)
+print_newline_indent(json_dumper *dumper, int depth)
 {
     if ((dumper->flags & JSON_DUMPER_FLAGS_PRETTY_PRINT)) {
-        fputc('\n', dumper->output_file);
+        g_string_append_c(json_dumper_output(dumper), '\n');
         for (int i = 0; i < depth; i++) {
-            fputs("  ", dumper->output_file);
+            g_string_append(json_dumper_output(dumper), "  ");
         }
     }
 }
@@ -184,6 +264,8 @@ print_newline_indent(const json_dumper *dumper, int depth)
 static void
 prepare_token(json_dumper *dumper)
 {
+    json_dumper_flush_if_full(dumper);
+
     if (dumper->current_depth == 0) {
         // not part of an array or object.
         return;
@@ -208,7 +290,7 @@ prepare_token(json_dumper *dumper)
     }
 
     if (dumper->state[dumper->current_depth]) {
-        fputc(',', dumper->output_file);
+        g_string_append_c(json_dumper_output(dumper), ',');
     }
     print_newline_indent(dumper, dumper->current_depth);
 }
@@ -218,13 +300,13 @@ prepare_token(json_dumper *dumper)
  * necessary, it is preceded by newline and indentation).
  */
 static void
-finish_token(const json_dumper *dumper, char close_char)
+finish_token(json_dumper *dumper, char close_char)
 {
     // if the object/array was non-empty, add a newline and indentation.
     if (dumper->state[dumper->current_depth]) {
         print_newline_indent(dumper, dumper->current_depth - 1);
     }
-    fputc(close_char, dumper->output_file);
+    g_string_append_c(json_dumper_output(dumper), close_char);
 }
 
 void
@@ -235,7 +317,7 @@ json_dumper_begin_object(json_dumper *dumper)
     }
 
     prepare_token(dumper);
-    fputc('{', dumper->output_file);
+    g_string_append_c(json_dumper_output(dumper), '{');
 
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_OBJECT;
     ++dumper->current_depth;
@@ -250,10 +332,10 @@ json_dumper_set_member_name(json_dumper *dumper, const char *name)
     }
 
     prepare_token(dumper);
-    json_puts_string(dumper->output_file, name, dumper->flags & JSON_DUMPER_DOT_TO_UNDERSCORE);
-    fputc(':', dumper->output_file);
+    json_puts_string(json_dumper_output(dumper), name, dumper->flags & JSON_DUMPER_DOT_TO_UNDERSCORE);
+    g_string_append_c(json_dumper_output(dumper), ':');
     if ((dumper->flags & JSON_DUMPER_FLAGS_PRETTY_PRINT)) {
-        fputc(' ', dumper->output_file);
+        g_string_append_c(json_dumper_output(dumper), ' ');
     }
 
     dumper->state[dumper->current_depth - 1] |= JSON_DUMPER_HAS_NAME;
@@ -279,7 +361,7 @@ json_dumper_begin_array(json_dumper *dumper)
     }
 
     prepare_token(dumper);
-    fputc('[', dumper->output_file);
+    g_string_append_c(json_dumper_output(dumper), '[');
 
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_ARRAY;
     ++dumper->current_depth;
@@ -306,7 +388,7 @@ json_dumper_value_string(json_dumper *dumper, const char *value)
     }
 
     prepare_token(dumper);
-    json_puts_string(dumper->output_file, value, FALSE);
+    json_puts_string(json_dumper_output(dumper), value, FALSE);
 
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_VALUE;
 }
@@ -321,9 +403,9 @@ json_dumper_value_double(json_dumper *dumper, double value)
     prepare_token(dumper);
     gchar buffer[G_ASCII_DTOSTR_BUF_SIZE] = { 0 };
     if (isfinite(value) && g_ascii_dtostr(buffer, G_ASCII_DTOSTR_BUF_SIZE, value) && buffer[0]) {
-        fputs(buffer, dumper->output_file);
+        g_string_append(json_dumper_output(dumper), buffer);
     } else {
-        fputs("null", dumper->output_file);
+        g_string_append(json_dumper_output(dumper), "null");
     }
 
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_VALUE;
@@ -337,7 +419,7 @@ json_dumper_value_va_list(json_dumper *dumper, const char *format, va_list ap)
     }
 
     prepare_token(dumper);
-    vfprintf(dumper->output_file, format, ap);
+    g_string_append_vprintf(json_dumper_output(dumper), format, ap);
 
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_VALUE;
 }
@@ -353,15 +435,30 @@ json_dumper_value_anyf(json_dumper *dumper, const char *format, ...)
 }
 
 gboolean
-json_dumper_finish(json_dumper *dumper)
+json_dumper_end_document(json_dumper *dumper)
 {
-    if (!json_dumper_check_state(dumper, JSON_DUMPER_FINISH, JSON_DUMPER_TYPE_NONE)) {
-        return FALSE;
+    gboolean ok = json_dumper_check_state(dumper, JSON_DUMPER_FINISH, JSON_DUMPER_TYPE_NONE);
+
+    if (ok) {
+        g_string_append_c(json_dumper_output(dumper), '\n');
+        dumper->state[0] = 0;
     }
+    return ok;
+}
 
-    fputc('\n', dumper->output_file);
-    dumper->state[0] = 0;
-    return TRUE;
+gboolean
+json_dumper_finish(json_dumper *dumper)
+{
+    gboolean ok = json_dumper_end_document(dumper);
+
+    /* Write out whatever was dumped, even if the state got corrupted. */
+    json_dumper_flush(dumper);
+    if (dumper->flags & JSON_DUMPER_FLAGS_OWN_BUFFER) {
+        g_string_free(dumper->output_buffer, TRUE);
+        dumper->output_buffer = NULL;
+        dumper->flags &= ~JSON_DUMPER_FLAGS_OWN_BUFFER;
+    }
+    return ok;
 }
 
 void
@@ -376,7 +473,7 @@ json_dumper_begin_base64(json_dumper *dumper)
 
     prepare_token(dumper);
 
-    fputc('"', dumper->output_file);
+    g_string_append_c(json_dumper_output(dumper), '"');
 
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_BASE64;
     ++dumper->current_depth;
@@ -396,9 +493,10 @@ json_dumper_write_base64(json_dumper* dumper, const guchar *data, size_t len)
     while (len > 0) {
         gsize chunk_size = len < CHUNK_SIZE ? len : CHUNK_SIZE;
         gsize output_size = g_base64_encode_step(data, chunk_size, FALSE, buf, &dumper->base64_state, &dumper->base64_save);
-        fwrite(buf, 1, output_size, dumper->output_file);
+        g_string_append_len(json_dumper_output(dumper), buf, output_size);
         data += chunk_size;
         len -= chunk_size;
+        json_dumper_flush_if_full(dumper);
     }
 
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_BASE64;
@@ -415,9 +513,9 @@ json_dumper_end_base64(json_dumper *dumper)
     gsize wrote;
 
     wrote = g_base64_encode_close(FALSE, buf, &dumper->base64_state, &dumper->base64_save);
-    fwrite(buf, 1, wrote, dumper->output_file);
+    g_string_append_len(json_dumper_output(dumper), buf, wrote);
 
-    fputc('"', dumper->output_file);
+    g_string_append_c(json_dumper_output(dumper), '"');
 
     --dumper->current_depth;
 }
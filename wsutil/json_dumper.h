@@ -59,6 +59,9 @@ typedef struct json_dumper {
     int     current_depth;
     gint    base64_state;
     gint    base64_save;
+    GString *output_buffer; /**< Output not yet written to output_file. May be
+                                 set to reuse a buffer for several dumps; it
+                                 is freed by json_dumper_finish() otherwise. */
     guint8  state[JSON_DUMPER_MAX_DEPTH];
 } json_dumper;
 
@@ -107,6 +110,23 @@ json_dumper_end_base64(json_dumper *dumper);
 WS_DLL_PUBLIC void
 json_dumper_write_base64(json_dumper *dumper, const guchar *data, size_t len);
 
+/**
+ * Writes the data dumped so far to the output file. Data is collected and
+ * written in large chunks; this is only needed to get it out before
+ * json_dumper_finish(), e.g. to flush the output after every packet.
+ * Returns FALSE if the data couldn't all be written.
+ */
+WS_DLL_PUBLIC gboolean
+json_dumper_flush(json_dumper *dumper);
+
+/**
+ * Ends the top-level value like json_dumper_finish(), so that another one
+ * can be dumped after it, but leaves it in the output buffer. Returns FALSE
+ * if something went wrong.
+ */
+WS_DLL_PUBLIC gboolean
+json_dumper_end_document(json_dumper *dumper);
+
 /**
  * Finishes dumping data. Returns TRUE if everything is okay and FALSE if
  * something went wrong (open/close mismatch, missing values, etc.).
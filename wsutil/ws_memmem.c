@@ -0,0 +1,142 @@
+/* ws_memmem.c
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+/* see ws_mempbrk.c: older Mac OSX compilers can't be trusted with SSE4.2 */
+#ifdef __APPLE__
+#if defined(__clang__) && (__clang_major__ >= 6)
+/* allow HAVE_SSE4_2 to be used for clang 6.0+ case because we know it works */
+#else
+/* don't allow it otherwise, for Mac OSX */
+#undef HAVE_SSE4_2
+#endif
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+#include "ws_memmem.h"
+#include "ws_memmem_int.h"
+
+void
+ws_memmem_compile(ws_memmem_pattern *pattern, const guint8 *needle, size_t needle_len, guint flags)
+{
+    size_t i;
+
+    pattern->needle = needle;
+    pattern->needle_len = needle_len;
+    pattern->wide_needle = NULL;
+    pattern->caseless = (flags & WS_MEMMEM_CASELESS) ? TRUE : FALSE;
+
+    if ((flags & WS_MEMMEM_WIDE) && needle_len > 0) {
+        /* "ab" becomes "a\0b"; the NUL after the last character isn't
+         * part of the needle, so that a match at the very end of the
+         * data is found too. */
+        pattern->wide_needle = (guint8 *)g_malloc0(needle_len * 2 - 1);
+        for (i = 0; i < needle_len; i++)
+            pattern->wide_needle[i * 2] = needle[i];
+        pattern->needle = pattern->wide_needle;
+        pattern->needle_len = needle_len * 2 - 1;
+    }
+
+#ifdef HAVE_SSE4_2
+    pattern->use_sse42 = ws_memmem_sse42_supported();
+#else
+    pattern->use_sse42 = FALSE;
+#endif
+}
+
+
+void
+ws_memmem_free(ws_memmem_pattern *pattern)
+{
+    g_free(pattern->wide_needle);
+    pattern->wide_needle = NULL;
+}
+
+
+gboolean
+ws_memmem_equal(const guint8 *a, const guint8 *b, size_t len, gboolean caseless)
+{
+    size_t i;
+
+    if (!caseless)
+        return memcmp(a, b, len) == 0;
+
+    for (i = 0; i < len; i++) {
+        if (g_ascii_toupper(a[i]) != g_ascii_toupper(b[i]))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+
+const guint8 *
+ws_memmem_portable_exec(const guint8 *haystack, size_t haystack_len, const ws_memmem_pattern *pattern)
+{
+    const guint8 *needle = pattern->needle;
+    size_t needle_len = pattern->needle_len;
+    const guint8 *last_possible;
+    const guint8 *begin;
+    guint8 first;
+
+    if (needle_len == 0 || needle_len > haystack_len)
+        return NULL;
+
+    last_possible = haystack + haystack_len - needle_len;
+
+    if (!pattern->caseless) {
+        /* Let memchr(), which is usually vectorized, skip ahead to the
+         * candidates. */
+        for (begin = haystack; begin <= last_possible; begin++) {
+            begin = (const guint8 *)memchr(begin, needle[0], last_possible - begin + 1);
+            if (begin == NULL)
+                return NULL;
+            if (memcmp(begin + 1, needle + 1, needle_len - 1) == 0)
+                return begin;
+        }
+        return NULL;
+    }
+
+    first = g_ascii_toupper(needle[0]);
+    for (begin = haystack; begin <= last_possible; begin++) {
+        if (g_ascii_toupper(*begin) == first &&
+            ws_memmem_equal(begin + 1, needle + 1, needle_len - 1, TRUE))
+            return begin;
+    }
+    return NULL;
+}
+
+
+const guint8 *
+ws_memmem_exec(const guint8 *haystack, size_t haystack_len, const ws_memmem_pattern *pattern)
+{
+#ifdef HAVE_SSE4_2
+    if (pattern->use_sse42 && pattern->needle_len > 0 && haystack_len >= pattern->needle_len + 15)
+        return ws_memmem_sse42_exec(haystack, haystack_len, pattern);
+#endif
+
+    return ws_memmem_portable_exec(haystack, haystack_len, pattern);
+}
+
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
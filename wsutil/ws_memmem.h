@@ -0,0 +1,46 @@
+/* ws_memmem.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MEMMEM_H__
+#define __WS_MEMMEM_H__
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+
+/** Match ASCII letters regardless of their case. */
+#define WS_MEMMEM_CASELESS  0x01
+/** Look for the needle as UTF-16LE text, i.e. with a NUL after each byte. */
+#define WS_MEMMEM_WIDE      0x02
+
+/** The pattern object used for ws_memmem_exec().
+ */
+typedef struct {
+    const guint8 *needle;
+    size_t needle_len;
+    guint8 *wide_needle;    /* needle, if built for WS_MEMMEM_WIDE */
+    gboolean caseless;
+    gboolean use_sse42;
+} ws_memmem_pattern;
+
+/** Compile the pattern for the needle to find using ws_memmem_exec().
+ *  The needle must outlive the pattern; free the pattern with
+ *  ws_memmem_free().
+ */
+WS_DLL_PUBLIC void ws_memmem_compile(ws_memmem_pattern *pattern, const guint8 *needle, size_t needle_len, guint flags);
+
+/** Free the memory held by a compiled pattern.
+ */
+WS_DLL_PUBLIC void ws_memmem_free(ws_memmem_pattern *pattern);
+
+/** Return the first occurrence of the needle in the haystack, or NULL if
+ *  there is none or the needle is empty.
+ */
+WS_DLL_PUBLIC const guint8 *ws_memmem_exec(const guint8 *haystack, size_t haystack_len, const ws_memmem_pattern *pattern);
+
+#endif /* __WS_MEMMEM_H__ */
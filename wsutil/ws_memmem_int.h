@@ -0,0 +1,21 @@
+/* ws_memmem_int.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MEMMEM_INT_H__
+#define __WS_MEMMEM_INT_H__
+
+gboolean ws_memmem_equal(const guint8 *a, const guint8 *b, size_t len, gboolean caseless);
+const guint8 *ws_memmem_portable_exec(const guint8 *haystack, size_t haystack_len, const ws_memmem_pattern *pattern);
+
+#ifdef HAVE_SSE4_2
+gboolean ws_memmem_sse42_supported(void);
+const guint8 *ws_memmem_sse42_exec(const guint8 *haystack, size_t haystack_len, const ws_memmem_pattern *pattern);
+#endif
+
+#endif /* __WS_MEMMEM_INT_H__ */
@@ -0,0 +1,115 @@
+/* ws_memmem_sse42.c
+ * Substring search, looking at 16 candidate positions at a time
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#ifdef _WIN32
+  #include <tmmintrin.h>
+#endif
+
+#include <nmmintrin.h>
+#include <string.h>
+#include "ws_memmem.h"
+#include "ws_memmem_int.h"
+#include "bits_ctz.h"
+
+#define cast_128__m128i(p) ((const __m128i *) (const void *) (p))
+
+gboolean
+ws_memmem_sse42_supported(void)
+{
+    /* cpuid is slow, and patterns are compiled for every "contains"
+     * test, so only ask once. */
+    static int supported = -1;
+
+    if (supported == -1)
+        supported = ws_cpuid_sse42() ? 1 : 0;
+    return supported;
+}
+
+/*
+ * For each of 16 consecutive positions, compare the haystack byte with
+ * the first byte of the needle and the byte needle_len - 1 further on
+ * with the last byte of the needle; only the positions where both match
+ * are compared in full. Two bytes rule out nearly every position even
+ * for text, where the first byte alone is common.
+ *
+ * For a caseless search, each byte is compared with both the upper and
+ * the lower case version of the needle's byte.
+ *
+ * The caller makes sure that haystack_len >= needle_len + 15.
+ */
+const guint8 *
+ws_memmem_sse42_exec(const guint8 *haystack, size_t haystack_len, const ws_memmem_pattern *pattern)
+{
+    const guint8 *needle = pattern->needle;
+    size_t needle_len = pattern->needle_len;
+    guint8 first = needle[0];
+    guint8 last = needle[needle_len - 1];
+    __m128i first_upper, first_lower, last_upper, last_lower;
+    __m128i block_first, block_last, eq;
+    size_t offset;
+    guint32 mask;
+    int bit;
+
+    if (pattern->caseless) {
+        first_upper = _mm_set1_epi8((char)g_ascii_toupper(first));
+        first_lower = _mm_set1_epi8((char)g_ascii_tolower(first));
+        last_upper = _mm_set1_epi8((char)g_ascii_toupper(last));
+        last_lower = _mm_set1_epi8((char)g_ascii_tolower(last));
+    } else {
+        first_upper = first_lower = _mm_set1_epi8((char)first);
+        last_upper = last_lower = _mm_set1_epi8((char)last);
+    }
+
+    for (offset = 0; offset + needle_len + 15 <= haystack_len; offset += 16) {
+        block_first = _mm_loadu_si128(cast_128__m128i(haystack + offset));
+        block_last = _mm_loadu_si128(cast_128__m128i(haystack + offset + needle_len - 1));
+
+        eq = _mm_and_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block_first, first_upper),
+                         _mm_cmpeq_epi8(block_first, first_lower)),
+            _mm_or_si128(_mm_cmpeq_epi8(block_last, last_upper),
+                         _mm_cmpeq_epi8(block_last, last_lower)));
+
+        mask = (guint32)_mm_movemask_epi8(eq);
+        while (mask != 0) {
+            bit = ws_ctz(mask);
+            if (needle_len <= 2 ||
+                ws_memmem_equal(haystack + offset + bit + 1, needle + 1,
+                                needle_len - 2, pattern->caseless))
+                return haystack + offset + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    /* Fewer than 16 positions left. */
+    return ws_memmem_portable_exec(haystack + offset, haystack_len - offset, pattern);
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,220 @@
+/* ws_memmem_test.c
+ * Tests for ws_memmem, checking the portable and the SSE 4.2 searches
+ * against a naive one
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "ws_memmem.h"
+#include "ws_memmem_int.h"
+
+#define HAYSTACK_LEN    64
+#define RANDOM_ITERS    10000
+
+static const guint8 *
+naive_memmem(const guint8 *haystack, size_t haystack_len,
+        const guint8 *needle, size_t needle_len, gboolean caseless)
+{
+    size_t i, j;
+
+    if (needle_len == 0 || needle_len > haystack_len)
+        return NULL;
+
+    for (i = 0; i <= haystack_len - needle_len; i++) {
+        for (j = 0; j < needle_len; j++) {
+            if (caseless ?
+                    g_ascii_toupper(haystack[i + j]) != g_ascii_toupper(needle[j]) :
+                    haystack[i + j] != needle[j])
+                break;
+        }
+        if (j == needle_len)
+            return haystack + i;
+    }
+    return NULL;
+}
+
+/* Check every implementation against the naive search, and return
+ * what they found. */
+static const guint8 *
+check_memmem(const guint8 *haystack, size_t haystack_len,
+        const guint8 *needle, size_t needle_len, guint flags)
+{
+    ws_memmem_pattern pattern;
+    const guint8 *expected;
+
+    ws_memmem_compile(&pattern, needle, needle_len, flags);
+    expected = naive_memmem(haystack, haystack_len, pattern.needle,
+            pattern.needle_len, pattern.caseless);
+
+    g_assert(ws_memmem_exec(haystack, haystack_len, &pattern) == expected);
+    g_assert(ws_memmem_portable_exec(haystack, haystack_len, &pattern) == expected);
+#ifdef HAVE_SSE4_2
+    /* ws_memmem_exec() only uses it for haystacks at least this long */
+    if (ws_memmem_sse42_supported() && pattern.needle_len > 0 &&
+            haystack_len >= pattern.needle_len + 15) {
+        g_assert(ws_memmem_sse42_exec(haystack, haystack_len, &pattern) == expected);
+    }
+#endif
+
+    ws_memmem_free(&pattern);
+    return expected;
+}
+
+static void
+ws_memmem_test_empty(void)
+{
+    const guint8 haystack[] = "abcdefghijklmnopqrstuvwxyz";
+
+    g_assert(check_memmem(haystack, sizeof haystack - 1, haystack, 0, 0) == NULL);
+    g_assert(check_memmem(haystack, sizeof haystack - 1, haystack, 0, WS_MEMMEM_CASELESS) == NULL);
+    g_assert(check_memmem(haystack, sizeof haystack - 1, haystack, 0, WS_MEMMEM_WIDE) == NULL);
+    g_assert(check_memmem(haystack, 0, haystack, 1, 0) == NULL);
+}
+
+static void
+ws_memmem_test_long_needle(void)
+{
+    const guint8 text[] = "abcdefghijklmnopqrstuvwxyz";
+    size_t len;
+
+    /* The needle is the haystack plus one byte */
+    for (len = 1; len < sizeof text - 1; len++) {
+        g_assert(check_memmem(text, len - 1, text, len, 0) == NULL);
+        g_assert(check_memmem(text, len - 1, text, len, WS_MEMMEM_CASELESS) == NULL);
+    }
+    /* ...and then the haystack itself */
+    for (len = 1; len < sizeof text - 1; len++) {
+        g_assert(check_memmem(text, len, text, len, 0) == text);
+    }
+}
+
+static void
+ws_memmem_test_positions(void)
+{
+    const guint8 needle[] = "aBcDeFgHiJkLmNoPqRsT";
+    guint8 haystack[HAYSTACK_LEN];
+    size_t needle_len, pos;
+
+    /* Put each length of needle at each position, including those that
+     * straddle a 16-byte boundary and those that end at the last byte. */
+    for (needle_len = 1; needle_len < sizeof needle; needle_len++) {
+        for (pos = 0; pos + needle_len <= HAYSTACK_LEN; pos++) {
+            memset(haystack, 'x', HAYSTACK_LEN);
+            memcpy(haystack + pos, needle, needle_len);
+            g_assert(check_memmem(haystack, HAYSTACK_LEN, needle, needle_len, 0) == haystack + pos);
+            g_assert(check_memmem(haystack, HAYSTACK_LEN, needle, needle_len, WS_MEMMEM_CASELESS) == haystack + pos);
+
+            /* The first and last bytes match, but not the middle */
+            if (needle_len > 2) {
+                haystack[pos + needle_len / 2] = '?';
+                g_assert(check_memmem(haystack, HAYSTACK_LEN, needle, needle_len, 0) == NULL);
+            }
+        }
+    }
+}
+
+static void
+ws_memmem_test_last_byte(void)
+{
+    guint8 haystack[HAYSTACK_LEN];
+    size_t len;
+
+    for (len = 1; len <= HAYSTACK_LEN; len++) {
+        memset(haystack, 'x', HAYSTACK_LEN);
+        haystack[len - 1] = 'y';
+        g_assert(check_memmem(haystack, len, (const guint8 *)"y", 1, 0) == haystack + len - 1);
+        g_assert(check_memmem(haystack, len, (const guint8 *)"Y", 1, WS_MEMMEM_CASELESS) == haystack + len - 1);
+        g_assert(check_memmem(haystack, len, (const guint8 *)"xy", 2, 0) == (len > 1 ? haystack + len - 2 : NULL));
+        /* Just past the end */
+        g_assert(check_memmem(haystack, len - 1, (const guint8 *)"y", 1, 0) == NULL);
+    }
+}
+
+static void
+ws_memmem_test_caseless(void)
+{
+    const guint8 haystack[] = "The Quick Brown Fox Jumps Over The Lazy Dog, [twice] @ the quick brown fox";
+
+    g_assert(check_memmem(haystack, sizeof haystack - 1, (const guint8 *)"the quick", 9, 0) == haystack + 55);
+    g_assert(check_memmem(haystack, sizeof haystack - 1, (const guint8 *)"the quick", 9, WS_MEMMEM_CASELESS) == haystack);
+    g_assert(check_memmem(haystack, sizeof haystack - 1, (const guint8 *)"LAZY DOG", 8, WS_MEMMEM_CASELESS) == haystack + 35);
+    /* Only letters are folded: '[' and '{', '@' and '`' differ by 0x20 too */
+    g_assert(check_memmem(haystack, sizeof haystack - 1, (const guint8 *)"{TWICE}", 7, WS_MEMMEM_CASELESS) == NULL);
+    g_assert(check_memmem(haystack, sizeof haystack - 1, (const guint8 *)"` THE", 5, WS_MEMMEM_CASELESS) == NULL);
+}
+
+static void
+ws_memmem_test_wide(void)
+{
+    const guint8 haystack[] = "x\0x\0a\0b\0c\0x\0A\0B\0C\0x\0x\0x\0x\0x\0x\0x\0x\0x\0a\0b\0c";
+    const size_t haystack_len = sizeof haystack - 1;
+
+    g_assert(check_memmem(haystack, haystack_len, (const guint8 *)"abc", 3, WS_MEMMEM_WIDE) == haystack + 4);
+    g_assert(check_memmem(haystack, haystack_len, (const guint8 *)"ABC", 3, WS_MEMMEM_WIDE) == haystack + 12);
+    g_assert(check_memmem(haystack, haystack_len, (const guint8 *)"ABC", 3, WS_MEMMEM_WIDE|WS_MEMMEM_CASELESS) == haystack + 4);
+    /* At the very end, without the NUL after the last character */
+    g_assert(check_memmem(haystack + 6, haystack_len - 6, (const guint8 *)"abc", 3, WS_MEMMEM_WIDE) == haystack + haystack_len - 5);
+    g_assert(check_memmem(haystack, haystack_len, (const guint8 *)"abc", 3, 0) == NULL);
+}
+
+static void
+ws_memmem_test_random(void)
+{
+    /* A small alphabet, so that there are lots of partial matches */
+    static const guint8 alphabet[] = "aAbB\0";
+    guint8 haystack[HAYSTACK_LEN];
+    guint8 needle[8];
+    size_t haystack_len, needle_len, i;
+    int iter;
+
+    for (iter = 0; iter < RANDOM_ITERS; iter++) {
+        haystack_len = g_test_rand_int_range(0, HAYSTACK_LEN + 1);
+        needle_len = g_test_rand_int_range(0, sizeof needle + 1);
+        for (i = 0; i < haystack_len; i++)
+            haystack[i] = alphabet[g_test_rand_int_range(0, sizeof alphabet)];
+        for (i = 0; i < needle_len; i++)
+            needle[i] = alphabet[g_test_rand_int_range(0, sizeof alphabet)];
+
+        check_memmem(haystack, haystack_len, needle, needle_len, 0);
+        check_memmem(haystack, haystack_len, needle, needle_len, WS_MEMMEM_CASELESS);
+        check_memmem(haystack, haystack_len, needle, needle_len, WS_MEMMEM_WIDE);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/ws_memmem/empty",      ws_memmem_test_empty);
+    g_test_add_func("/ws_memmem/long",       ws_memmem_test_long_needle);
+    g_test_add_func("/ws_memmem/positions",  ws_memmem_test_positions);
+    g_test_add_func("/ws_memmem/last_byte",  ws_memmem_test_last_byte);
+    g_test_add_func("/ws_memmem/caseless",   ws_memmem_test_caseless);
+    g_test_add_func("/ws_memmem/wide",       ws_memmem_test_wide);
+    g_test_add_func("/ws_memmem/random",     ws_memmem_test_random);
+
+    return g_test_run();
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
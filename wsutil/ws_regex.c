@@ -0,0 +1,198 @@
+/* ws_regex.c
+ * Regular expressions matched against raw bytes
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#ifdef HAVE_PCRE2
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
+
+#include "ws_regex.h"
+
+struct ws_regex {
+#ifdef HAVE_PCRE2
+    pcre2_code *code;
+#else
+    GRegex *code;
+#endif
+    char *pattern;
+};
+
+#ifdef HAVE_PCRE2
+
+static void
+free_match_data(gpointer data)
+{
+    pcre2_match_data_free((pcre2_match_data *)data);
+}
+
+/*
+ * We only want to know whether there is a match, so a single pair of
+ * offsets is enough whatever the pattern, and the same match data can be
+ * used for every pattern. Keep one per thread instead of allocating one
+ * for every match.
+ */
+static GPrivate match_data_key = G_PRIVATE_INIT(free_match_data);
+
+static pcre2_match_data *
+get_match_data(void)
+{
+    pcre2_match_data *match_data = (pcre2_match_data *)g_private_get(&match_data_key);
+
+    if (match_data == NULL) {
+        match_data = pcre2_match_data_create(1, NULL);
+        g_private_set(&match_data_key, match_data);
+    }
+    return match_data;
+}
+
+ws_regex_t *
+ws_regex_compile(const char *pattern, guint flags, char **errmsg)
+{
+    ws_regex_t *re;
+    pcre2_code *code;
+    /* PCRE2_NEVER_UTF: don't let "(*UTF)" in the pattern turn on UTF-8
+     * checks of the subject, which isn't text. */
+    guint32 options = PCRE2_NEVER_UTF;
+    int errorcode;
+    PCRE2_SIZE erroffset;
+    PCRE2_UCHAR errbuf[256];
+
+    if (flags & WS_REGEX_CASELESS)
+        options |= PCRE2_CASELESS;
+
+    code = pcre2_compile((PCRE2_SPTR)pattern, PCRE2_ZERO_TERMINATED, options,
+                         &errorcode, &erroffset, NULL);
+    if (code == NULL) {
+        if (errmsg) {
+            pcre2_get_error_message(errorcode, errbuf, sizeof(errbuf));
+            *errmsg = g_strdup_printf("Error while compiling regular expression %s at char %" G_GSIZE_FORMAT ": %s",
+                                      pattern, (gsize)erroffset, (const char *)errbuf);
+        }
+        return NULL;
+    }
+
+    /* If there's no JIT support for this platform, or the pattern can't be
+     * JIT compiled, pcre2_match() falls back to the interpreter. */
+    pcre2_jit_compile(code, PCRE2_JIT_COMPLETE);
+
+    re = g_new(ws_regex_t, 1);
+    re->code = code;
+    re->pattern = g_strdup(pattern);
+    return re;
+}
+
+gboolean
+ws_regex_matches_length(const ws_regex_t *re, const char *subject, size_t length)
+{
+    return pcre2_match(re->code, (PCRE2_SPTR)subject, length, 0, 0,
+                       get_match_data(), NULL) >= 0;
+}
+
+gboolean
+ws_regex_matches(const ws_regex_t *re, const char *subject)
+{
+    return pcre2_match(re->code, (PCRE2_SPTR)subject, PCRE2_ZERO_TERMINATED, 0, 0,
+                       get_match_data(), NULL) >= 0;
+}
+
+void
+ws_regex_free(ws_regex_t *re)
+{
+    if (re == NULL)
+        return;
+
+    pcre2_code_free(re->code);
+    g_free(re->pattern);
+    g_free(re);
+}
+
+#else /* HAVE_PCRE2 */
+
+ws_regex_t *
+ws_regex_compile(const char *pattern, guint flags, char **errmsg)
+{
+    ws_regex_t *re;
+    GRegex *code;
+    GError *regex_error = NULL;
+    /* G_REGEX_RAW: treat the pattern and the subjects as bytes. */
+    GRegexCompileFlags cflags = (GRegexCompileFlags)(G_REGEX_OPTIMIZE | G_REGEX_RAW);
+
+    if (flags & WS_REGEX_CASELESS)
+        cflags = (GRegexCompileFlags)(cflags | G_REGEX_CASELESS);
+
+    code = g_regex_new(pattern, cflags, (GRegexMatchFlags)0, &regex_error);
+    if (regex_error) {
+        if (errmsg) {
+            *errmsg = g_strdup(regex_error->message);
+        }
+        g_error_free(regex_error);
+        if (code) {
+            g_regex_unref(code);
+        }
+        return NULL;
+    }
+
+    re = g_new(ws_regex_t, 1);
+    re->code = code;
+    re->pattern = g_strdup(pattern);
+    return re;
+}
+
+gboolean
+ws_regex_matches_length(const ws_regex_t *re, const char *subject, size_t length)
+{
+    return g_regex_match_full(re->code, subject, (gssize)length, 0,
+                              (GRegexMatchFlags)0, NULL, NULL);
+}
+
+gboolean
+ws_regex_matches(const ws_regex_t *re, const char *subject)
+{
+    return g_regex_match_full(re->code, subject, -1, 0,
+                              (GRegexMatchFlags)0, NULL, NULL);
+}
+
+void
+ws_regex_free(ws_regex_t *re)
+{
+    if (re == NULL)
+        return;
+
+    g_regex_unref(re->code);
+    g_free(re->pattern);
+    g_free(re);
+}
+
+#endif /* HAVE_PCRE2 */
+
+const char *
+ws_regex_pattern(const ws_regex_t *re)
+{
+    return re->pattern;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
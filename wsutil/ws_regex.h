@@ -0,0 +1,70 @@
+/* ws_regex.h
+ * Regular expressions matched against raw bytes
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_REGEX_H__
+#define __WS_REGEX_H__
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * A compiled Perl-compatible regular expression. Patterns and subjects
+ * are treated as bytes, not as UTF-8, as packet data is arbitrary.
+ *
+ * With PCRE2, patterns are compiled to machine code where its JIT compiler
+ * supports the platform, and matching doesn't allocate anything after
+ * the first match in a thread. Without it, GRegex is used.
+ */
+typedef struct ws_regex ws_regex_t;
+
+/** Match ASCII letters regardless of their case. */
+#define WS_REGEX_CASELESS   0x01
+
+/**
+ * Compile a pattern.
+ *
+ * @param pattern The pattern.
+ * @param flags WS_REGEX_ flags.
+ * @param errmsg If not NULL, set to a g_malloc()ed error message if
+ *        the pattern can't be compiled.
+ * @return The compiled pattern, or NULL.
+ */
+WS_DLL_PUBLIC ws_regex_t *
+ws_regex_compile(const char *pattern, guint flags, char **errmsg);
+
+/**
+ * Does the pattern match anywhere in a subject, which needn't be
+ * NUL-terminated?
+ */
+WS_DLL_PUBLIC gboolean
+ws_regex_matches_length(const ws_regex_t *re, const char *subject, size_t length);
+
+/**
+ * Does the pattern match anywhere in a NUL-terminated subject?
+ */
+WS_DLL_PUBLIC gboolean
+ws_regex_matches(const ws_regex_t *re, const char *subject);
+
+/** Return the pattern the regular expression was compiled from. */
+WS_DLL_PUBLIC const char *
+ws_regex_pattern(const ws_regex_t *re);
+
+WS_DLL_PUBLIC void
+ws_regex_free(ws_regex_t *re);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WS_REGEX_H__ */
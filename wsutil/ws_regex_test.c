@@ -0,0 +1,196 @@
+/* ws_regex_test.c
+ * Tests for ws_regex, which are run with whichever of PCRE2 and GRegex
+ * it was built with
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "ws_regex.h"
+#include "time_util.h"
+
+static ws_regex_t *
+compile_ok(const char *pattern, guint flags)
+{
+    ws_regex_t *re;
+    char *errmsg = NULL;
+
+    re = ws_regex_compile(pattern, flags, &errmsg);
+    if (re == NULL) {
+        g_test_message("%s: %s", pattern, errmsg);
+        g_free(errmsg);
+    }
+    g_assert(re != NULL);
+    g_assert_cmpstr(ws_regex_pattern(re), ==, pattern);
+    return re;
+}
+
+static void
+ws_regex_test_match(void)
+{
+    ws_regex_t *re;
+
+    re = compile_ok("b[0-9]+c", 0);
+    g_assert(ws_regex_matches(re, "ab12cd"));
+    g_assert(!ws_regex_matches(re, "abcd"));
+    g_assert(!ws_regex_matches(re, ""));
+    ws_regex_free(re);
+
+    ws_regex_free(NULL);
+}
+
+static void
+ws_regex_test_caseless(void)
+{
+    ws_regex_t *re;
+
+    re = compile_ok("Get /", 0);
+    g_assert(ws_regex_matches(re, "Get /index.html"));
+    g_assert(!ws_regex_matches(re, "GET /index.html"));
+    ws_regex_free(re);
+
+    re = compile_ok("Get /", WS_REGEX_CASELESS);
+    g_assert(ws_regex_matches(re, "Get /index.html"));
+    g_assert(ws_regex_matches(re, "GET /index.html"));
+    g_assert(ws_regex_matches(re, "get /index.html"));
+    g_assert(!ws_regex_matches(re, "POST /index.html"));
+    ws_regex_free(re);
+}
+
+static void
+ws_regex_test_length(void)
+{
+    static const char subject[] = "ab\0cd\xff";
+    ws_regex_t *re;
+
+    /* The whole subject is matched, NULs included */
+    re = compile_ok("cd", 0);
+    g_assert(ws_regex_matches_length(re, subject, sizeof subject - 1));
+    g_assert(!ws_regex_matches(re, subject));
+    /* ...but nothing past the length */
+    g_assert(!ws_regex_matches_length(re, subject, 4));
+    ws_regex_free(re);
+
+    re = compile_ok("b\\x00c", 0);
+    g_assert(ws_regex_matches_length(re, subject, sizeof subject - 1));
+    ws_regex_free(re);
+
+    /* Bytes that aren't valid UTF-8 are just bytes */
+    re = compile_ok("d\\xff$", 0);
+    g_assert(ws_regex_matches_length(re, subject, sizeof subject - 1));
+    ws_regex_free(re);
+
+    /* The subject needn't be NUL-terminated */
+    re = compile_ok("^ab$", 0);
+    g_assert(ws_regex_matches_length(re, "abc", 2));
+    g_assert(!ws_regex_matches_length(re, "abc", 3));
+    ws_regex_free(re);
+}
+
+static void
+ws_regex_test_errors(void)
+{
+    char *errmsg = NULL;
+
+    g_assert(ws_regex_compile("a(b", 0, &errmsg) == NULL);
+    g_assert(errmsg != NULL);
+    /* The wording differs between PCRE2 and GLib versions */
+    g_assert(strstr(errmsg, "a(b") != NULL);
+    g_free(errmsg);
+
+    /* errmsg is optional */
+    g_assert(ws_regex_compile("a[b", 0, NULL) == NULL);
+
+#ifdef HAVE_PCRE2
+    /* Packet data isn't text, so a pattern can't ask for UTF-8 checks. */
+    errmsg = NULL;
+    g_assert(ws_regex_compile("(*UTF)abc", 0, &errmsg) == NULL);
+    g_assert(errmsg != NULL);
+    g_free(errmsg);
+#endif
+}
+
+/* NOTE: You have to run "ws_regex_test --verbose" to see results. */
+static void
+ws_regex_test_perf(void)
+{
+#define PERF_LOOPS 100000
+    static const char *patterns[] = {
+        "Host: [a-z]+\\.example\\.com",
+        "(?i)user-agent: .*curl",
+        "\\x00\\x01\\x02\\x03",
+    };
+    static const char request[] = "GET /index.html HTTP/1.1\r\nAccept: */*\r\n";
+    char subject[1500];
+    ws_regex_t *re;
+    double start_utime, start_stime, end_utime, end_stime;
+    guint i, j;
+    int matches;
+
+    /* About a full-sized packet that none of the patterns match */
+    for (i = 0; i < sizeof subject; i++)
+        subject[i] = request[i % (sizeof request - 1)];
+
+    for (i = 0; i < G_N_ELEMENTS(patterns); i++) {
+        re = compile_ok(patterns[i], 0);
+        matches = 0;
+
+        get_resource_usage(&start_utime, &start_stime);
+        for (j = 0; j < PERF_LOOPS; j++) {
+            if (ws_regex_matches_length(re, subject, sizeof subject))
+                matches++;
+        }
+        get_resource_usage(&end_utime, &end_stime);
+        g_assert(matches == 0);
+
+        g_test_minimized_result((end_utime - start_utime + end_stime - start_stime) * 1000.0,
+            "%u x %" G_GSIZE_FORMAT " bytes, %s (%s): u %.3f ms s %.3f ms",
+            PERF_LOOPS, sizeof subject, patterns[i],
+#ifdef HAVE_PCRE2
+            "PCRE2",
+#else
+            "GRegex",
+#endif
+            (end_utime - start_utime) * 1000.0, (end_stime - start_stime) * 1000.0);
+
+        ws_regex_free(re);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/ws_regex/match",    ws_regex_test_match);
+    g_test_add_func("/ws_regex/caseless", ws_regex_test_caseless);
+    g_test_add_func("/ws_regex/length",   ws_regex_test_length);
+    g_test_add_func("/ws_regex/errors",   ws_regex_test_errors);
+
+    if (!g_test_perf()) {
+        g_test_add_func("/ws_regex/perf", ws_regex_test_perf);
+    }
+
+    return g_test_run();
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */